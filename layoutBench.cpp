@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pulsedThread.h>
+
+/* ************************************* Benchmark for cross-core traffic on taskParams *******************************************
+Starts a number of infinite trains, each pthread pinning itself to a core other than core 0, round robin, at its first edge, then
+hammers all of them from a single controlling thread pinned to core 0, once the trains are running, with the calls a rig controller typically makes (isBusy, getModCustomStatus, and modDelay with an unchanged value). Each train's hiFunc
+measures the period it actually achieved, so controller calls that steal the cache lines the pthreads read at every edge show up
+as late edges. Run it before and after a change to taskParams layout and compare controller call rate and period errors. The controller is
+pinned only after the trains start, as pool pthreads made before then would inherit its affinity and all share core 0, where no cross-core
+traffic can happen. On a single core host everything runs on core 0, and only the cost of the calls themselves is measured
+usage: layoutBench nThreads periodUsecs seconds
+Last Modified:
+2026/10/19 - trains run on cores other than the controller's, and the controller is pinned after they start
+2026/10/19 - initial version */
+
+/* ***************************** custom data for each train, written only by the train's own pthread ********************************/
+typedef struct benchStruct{
+	uint64_t lastNsecs;	// time of previous hi edge
+	uint64_t nEdges;		// number of hi edges measured
+	uint64_t sumErrNsecs;	// sum of absolute difference between measured and requested period
+	uint64_t maxErrNsecs;	// largest difference between measured and requested period
+	uint64_t periodNsecs;	// requested period
+	int core;				// core the pthread pins itself to at its first edge
+}benchStruct, *benchStructPtr;
+
+void bench_Hi (void * taskData){
+	benchStructPtr ourData = (benchStructPtr) taskData;
+	if (ourData->lastNsecs == 0){
+		cpu_set_t cpuSet;
+		CPU_ZERO (&cpuSet);
+		CPU_SET (ourData->core, &cpuSet);
+		pthread_setaffinity_np (pthread_self (), sizeof (cpu_set_t), &cpuSet);
+	}
+	uint64_t now = pulsedThreadNanos ();
+	if (ourData->lastNsecs != 0){
+		uint64_t period = now - ourData->lastNsecs;
+		uint64_t err = (period > ourData->periodNsecs) ? period - ourData->periodNsecs : ourData->periodNsecs - period;
+		ourData->sumErrNsecs += err;
+		if (err > ourData->maxErrNsecs){
+			ourData->maxErrNsecs = err;
+		}
+		ourData->nEdges +=1;
+	}
+	ourData->lastNsecs = now;
+}
+
+void bench_Lo (void * taskData){
+}
+
+int main(int argc, char **argv){
+	unsigned int nThreads = (argc > 1) ? atoi (argv [1]) : 8;
+	unsigned int periodUsecs = (argc > 2) ? atoi (argv [2]) : 1000;
+	float runSecs = (argc > 3) ? atof (argv [3]) : 5;
+	// trains run on cores 1 to nCores - 1, the controller on core 0
+	int nCores = sysconf (_SC_NPROCESSORS_ONLN);
+	if (nCores < 2){
+		printf ("Only 1 core, trains and controller share it, so there is no cross-core traffic to measure.\n");
+	}
+	// make the trains
+	pulsedThread ** trains = new pulsedThread * [nThreads];
+	benchStructPtr benchData = new benchStruct [nThreads];
+	int errVar;
+	for (unsigned int iThread =0; iThread < nThreads; iThread +=1){
+		benchData [iThread] = {0, 0, 0, 0, (uint64_t)periodUsecs * 1000, (nCores < 2) ? 0 : 1 + (int)(iThread % (nCores - 1))};
+		trains [iThread] = new pulsedThread (periodUsecs/2, periodUsecs - periodUsecs/2, (unsigned int)kINFINITETRAIN, (void *) &benchData [iThread], nullptr, &bench_Lo, &bench_Hi, ACC_MODE_SLEEPS_AND_OR_SPINS, errVar);
+		if (errVar){
+			printf ("Failed to make pulsed thread %d.\n", iThread);
+			return 1;
+		}
+	}
+	for (unsigned int iThread =0; iThread < nThreads; iThread +=1){
+		trains [iThread]->startInfiniteTrain ();
+	}
+	// pin the controller now, after the pool pthreads are made, so they do not inherit its affinity
+	cpu_set_t cpuSet;
+	CPU_ZERO (&cpuSet);
+	CPU_SET (0, &cpuSet);
+	sched_setaffinity (0, sizeof (cpu_set_t), &cpuSet);
+	// controller loop, round robin over the trains until time is up
+	uint64_t endNsecs = pulsedThreadNanos () + (uint64_t)(runSecs * 1e09);
+	uint64_t nCalls =0;
+	int busySum =0;
+	while (pulsedThreadNanos () < endNsecs){
+		for (unsigned int iThread =0; iThread < nThreads; iThread +=1){
+			busySum += trains [iThread]->isBusy ();
+			busySum += trains [iThread]->getModCustomStatus ();
+			nCalls +=2;
+		}
+		if ((nCalls % 1024) == 0){
+			for (unsigned int iThread =0; iThread < nThreads; iThread +=1){
+				trains [iThread]->modDelay (trains [iThread]->getpulseDelayUsecs ());
+				nCalls +=1;
+			}
+		}
+	}
+	for (unsigned int iThread =0; iThread < nThreads; iThread +=1){
+		trains [iThread]->stopInfiniteTrain ();
+	}
+	// report
+	printf ("taskParams is %zu bytes, aligned to %zu, %d cores\n", sizeof (taskParams), alignof (taskParams), nCores);
+	printf ("controller made %.0f calls per second (busy sum %d)\n", nCalls/runSecs, busySum);
+	for (unsigned int iThread =0; iThread < nThreads; iThread +=1){
+		if (benchData [iThread].nEdges > 0){
+			printf ("train %d: %llu edges, mean period error = %.2f us, max period error = %.2f us\n", iThread, (unsigned long long)benchData [iThread].nEdges,
+			(float)benchData [iThread].sumErrNsecs/(1e03 * benchData [iThread].nEdges), (float)benchData [iThread].maxErrNsecs/1e03);
+		}
+		delete trains [iThread];
+	}
+	delete [] trains;
+	delete [] benchData;
+	return 0;
+}
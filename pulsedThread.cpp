@@ -1,280 +1,494 @@
 #include "pulsedThread.h"
+#include "pulsedThreadSpinCoordinator.h"
+#include "pulsedThreadPool.h"
+#include <poll.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <linux/gpio.h>
+#include <sys/prctl.h>
+
+/* ****************************************************************************************************
+Reads events waiting on a trigger fd. Returns the number of events read, 0 if none were waiting, or -1 at end of file or on an error.
+For GPIO line events, eventNsecs is set to the kernel time of the first event, else it is left alone
+Last Modified:
+2026/10/19 - initial version */
+static int64_t pulsedThreadTriggerRead (int fd, int fdMode, uint64_t & eventNsecs){
+	ssize_t nBytes;
+	switch (fdMode){
+		case kTRIGFD_EVENTFD:{
+			uint64_t count;
+			nBytes = read (fd, &count, sizeof (uint64_t));
+			if (nBytes == sizeof (uint64_t)){
+				return (int64_t) count;
+			}
+			break;
+		}
+		case kTRIGFD_GPIO:{
+			struct gpio_v2_line_event events [kTRIGFD_MAX_EVENTS];
+			nBytes = read (fd, events, sizeof (events));
+			if (nBytes >= (ssize_t) sizeof (struct gpio_v2_line_event)){
+				eventNsecs = events [0].timestamp_ns;
+				return nBytes / sizeof (struct gpio_v2_line_event);
+			}
+			break;
+		}
+		default:{ // kTRIGFD_PIPE
+			char bytes [kTRIGFD_MAX_EVENTS];
+			nBytes = read (fd, bytes, kTRIGFD_MAX_EVENTS);
+			if (nBytes > 0){
+				return nBytes;
+			}
+			break;
+		}
+	}
+	if ((nBytes < 0) && ((errno == EAGAIN) || (errno == EINTR))){
+		return 0;
+	}
+	return -1;
+}
+
+/* ****************************************************************************************************
+Called with the mutex held by a thread with no task to do and a trigger fd installed. Waits, with the mutex unlocked, for an event on the
+trigger fd or on the wake fd, and returns with the mutex held again. Returns time of the trigger in nanoseconds, when poll returned, or, for
+GPIO, when the kernel saw the edge, or 0 if woken by a command. Events read with the trigger are counted as missed. A trigger fd at end of file,
+or giving an error, is not watched any more
+Last Modified:
+2026/10/19 - initial version */
+static uint64_t pulsedThreadTriggerWait (taskParams * theTask){
+	int triggerFd = theTask->triggerFd;
+	int fdMode = theTask->triggerFdMode;
+	pthread_mutex_unlock (&theTask->taskMutex);
+	struct pollfd pollFds [2] = {{triggerFd, POLLIN, 0}, {theTask->wakeFd, POLLIN, 0}};
+	uint64_t triggerNsecs = 0;
+	int64_t nEvents = 0;
+	if (poll (pollFds, 2, -1) > 0){
+		if (pollFds [0].revents){
+			triggerNsecs = pulsedThreadNanos ();
+			nEvents = pulsedThreadTriggerRead (triggerFd, fdMode, triggerNsecs);
+		}
+		if (pollFds [1].revents & POLLIN){
+			uint64_t count;
+			ssize_t nBytes = read (theTask->wakeFd, &count, sizeof (uint64_t));
+			(void) nBytes;
+		}
+	}
+	pthread_mutex_lock (&theTask->taskMutex);
+	if (nEvents < 0){
+#if beVerbose
+		printf ("pulsedThreadTriggerWait error: trigger fd %d is at end of file or gave an error, and is not watched any more.\n", triggerFd);
+#endif
+		if (theTask->triggerFd == triggerFd){
+			theTask->triggerFd = -1;
+		}
+		return 0;
+	}
+	if (nEvents == 0){
+		return 0;
+	}
+	theTask->fdMissed += nEvents - 1;
+	return triggerNsecs;
+}
+
+/* ********************** reads and counts events that came on the trigger fd while the thread was busy ***********************************/
+static uint64_t pulsedThreadTriggerDrain (int fd, int fdMode){
+	struct pollfd pollFd = {fd, POLLIN, 0};
+	uint64_t eventNsecs;
+	uint64_t nMissed = 0;
+	int64_t nEvents;
+	while ((poll (&pollFd, 1, 0) > 0) && (pollFd.revents & POLLIN)){
+		nEvents = pulsedThreadTriggerRead (fd, fdMode, eventNsecs);
+		if (nEvents <= 0){
+			break;
+		}
+		nMissed += nEvents;
+	}
+	return nMissed;
+}
+
+/* ********************** adds latency from trigger to first edge of a triggered task to a set of stats, called with the mutex held ***********/
+static inline void pulsedThreadLatencyAdd (pulsedThreadLatencyStructPtr stats, uint64_t triggerNsecs, uint64_t edgeNsecs){
+	uint64_t latency = (edgeNsecs > triggerNsecs) ? edgeNsecs - triggerNsecs : 0;
+	stats->lastNsecs = latency;
+	if ((stats->nTriggers == 0) || (latency < stats->minNsecs)){
+		stats->minNsecs = latency;
+	}
+	if (latency > stats->maxNsecs){
+		stats->maxNsecs = latency;
+	}
+	stats->nTriggers +=1;
+}
+
+/* ****************************************************************************************************
+Wake-up latency of the host, shared by all ACC_MODE_AUTO threads. Measured by timing kLATENCY_SAMPLES short sleeps, with timer slack set
+to the least the kernel allows while measuring, as a SCHED_RR pulsedThread has no slack, and taking the second largest lateness, the 95th
+percentile of 20 samples, so one preemption does not make every thread spin. Measuring sleeps for about 2 ms, and sets the timer slack of
+the calling thread, so it is done on a control thread, by the constructor of the first ACC_MODE_AUTO thread, never on a pthread, which only
+reads the latency
+Last Modified:
+2026/10/19 - measured by pulsedThreadMeasureHostLatency on a control thread, pulsedThreadHostLatency only reads it
+2026/10/19 - initial version */
+static const int kLATENCY_SAMPLES = 20;
+static const unsigned int kLATENCY_SLEEP_USECS = 100;
+static std::atomic<unsigned int> pulsedThreadLatencyUsecs (0);
+
+unsigned int pulsedThreadHostLatency (void){
+	unsigned int latencyUsecs = pulsedThreadLatencyUsecs.load (std::memory_order_relaxed);
+	return (latencyUsecs != 0) ? latencyUsecs : kSLEEPTURNAROUND/2;
+}
+
+unsigned int pulsedThreadMeasureHostLatency (void){
+	unsigned int latencyUsecs = pulsedThreadLatencyUsecs.load (std::memory_order_relaxed);
+	if (latencyUsecs != 0){
+		return latencyUsecs;
+	}
+	int oldSlack = prctl (PR_GET_TIMERSLACK, 0, 0, 0, 0);
+	prctl (PR_SET_TIMERSLACK, 1, 0, 0, 0);
+	uint64_t lateNsecs [kLATENCY_SAMPLES];
+	struct timespec sleeper = {0, kLATENCY_SLEEP_USECS * 1000};
+	for (int iSample =0; iSample < kLATENCY_SAMPLES; iSample +=1){
+		uint64_t startNsecs = pulsedThreadNanos ();
+		nanosleep (&sleeper, NULL);
+		uint64_t sleptNsecs = pulsedThreadNanos () - startNsecs;
+		lateNsecs [iSample] = (sleptNsecs > kLATENCY_SLEEP_USECS * 1000) ? sleptNsecs - kLATENCY_SLEEP_USECS * 1000 : 0;
+	}
+	if (oldSlack > 0){
+		prctl (PR_SET_TIMERSLACK, oldSlack, 0, 0, 0);
+	}
+	uint64_t largest = 0;
+	uint64_t second = 0;
+	for (int iSample =0; iSample < kLATENCY_SAMPLES; iSample +=1){
+		if (lateNsecs [iSample] > largest){
+			second = largest;
+			largest = lateNsecs [iSample];
+		}else if (lateNsecs [iSample] > second){
+			second = lateNsecs [iSample];
+		}
+	}
+	latencyUsecs = (unsigned int)(second / 1000) + 1;
+#if beVerbose
+	printf ("pulsedThread host wake-up latency measured as %d microseconds.\n", latencyUsecs);
+#endif
+	pulsedThreadLatencyUsecs.store (latencyUsecs, std::memory_order_relaxed);
+	return latencyUsecs;
+}
+
+void pulsedThreadSetHostLatency (unsigned int latencyUsecs){
+	pulsedThreadLatencyUsecs.store (latencyUsecs, std::memory_order_relaxed);
+	if (latencyUsecs == 0){
+		pulsedThreadMeasureHostLatency ();
+	}
+}
+
+/* ************************************** shared tick for wake-up coalescing, the same for all threads of the process ***********************/
+static std::atomic<unsigned int> pulsedThreadCoalesceTickUsecs (kCOALESCE_TICK_USECS);
+
+unsigned int pulsedThreadCoalesceTick (void){
+	return pulsedThreadCoalesceTickUsecs.load (std::memory_order_relaxed);
+}
+
+int pulsedThreadSetCoalesceTick (unsigned int tickUsecs){
+	if (tickUsecs == 0){
+		return 1;
+	}
+	pulsedThreadCoalesceTickUsecs.store (tickUsecs, std::memory_order_relaxed);
+	return 0;
+}
+
+/* ****************************************************************************************************
+Companion thread function for offloaded endFuncs. Runs each queued endFunc with a task filled in from the copy the pthread queued, and gives
+back to the task, under the mutex, only the timing fields the endFunc changed, with the signal bits for the segments it changed. Fields it did
+not change are left alone, so a modDelay, modTrainLength, etc. made after the copy was queued is not reverted. Returns when killWorker is set
+and the queue is empty
+Last Modified:
+2026/10/19 - writes back only the fields the endFunc changed, and sets only the matching signal bits
+2026/10/19 - initial version */
+extern "C" void* pulsedThreadOffloadFunc (void * tData){
+	pulsedThreadOffloadStructPtr offload = (pulsedThreadOffloadStructPtr) tData;
+	taskParams * theTask = offload->theTask;
+	taskParams * copyTask = &offload->copyTask;
+	uint64_t nDone = offload->nDone.load (std::memory_order_relaxed);
+	for (;;){
+		while ((sem_wait (&offload->queueSem) != 0) && (errno == EINTR));
+		if (nDone == offload->nQueued.load (std::memory_order_acquire)){
+			if (offload->killWorker.load ()){
+				break;
+			}
+			continue;
+		}
+		pulsedThreadEndFuncCopyPtr copy = &offload->queue [nDone % kOFFLOAD_QUEUE_SIZE];
+		copyTask->endFunc = copy->endFunc;
+		copyTask->endFuncData = copy->endFuncData;
+		copyTask->doTask = copy->doTask & ~kMODANY;
+		copyTask->pulseDelayUsecs = copy->pulseDelayUsecs;
+		copyTask->pulseDurUsecs = copy->pulseDurUsecs;
+		copyTask->nPulses = copy->nPulses;
+		copyTask->trainDuration = copy->trainDuration;
+		copyTask->trainFrequency = copy->trainFrequency;
+		copyTask->trainDutyCycle = copy->trainDutyCycle;
+		copy->endFunc (copy->endFuncData, copyTask);
+		// give timing changed by the endFunc back to the task, for the pthread to take up at the next safe boundary
+		unsigned int modBits = copyTask->doTask & (kMODDELAY | kMODDUR);
+		if (copyTask->pulseDelayUsecs != copy->pulseDelayUsecs){
+			modBits |= kMODDELAY;
+		}
+		if (copyTask->pulseDurUsecs != copy->pulseDurUsecs){
+			modBits |= kMODDUR;
+		}
+		bool pulsesChanged = (copyTask->nPulses != copy->nPulses);
+		bool durationChanged = (copyTask->trainDuration != copy->trainDuration);
+		bool frequencyChanged = (copyTask->trainFrequency != copy->trainFrequency);
+		bool dutyCycleChanged = (copyTask->trainDutyCycle != copy->trainDutyCycle);
+		if ((modBits) || (pulsesChanged) || (durationChanged) || (frequencyChanged) || (dutyCycleChanged)){
+			pthread_mutex_lock (&theTask->taskMutex);
+			if (copyTask->pulseDelayUsecs != copy->pulseDelayUsecs){
+				theTask->pulseDelayUsecs = copyTask->pulseDelayUsecs;
+			}
+			if (copyTask->pulseDurUsecs != copy->pulseDurUsecs){
+				theTask->pulseDurUsecs = copyTask->pulseDurUsecs;
+			}
+			if (pulsesChanged){
+				theTask->nPulses = copyTask->nPulses;
+			}
+			if (durationChanged){
+				theTask->trainDuration = copyTask->trainDuration;
+			}
+			if (frequencyChanged){
+				theTask->trainFrequency = copyTask->trainFrequency;
+			}
+			if (dutyCycleChanged){
+				theTask->trainDutyCycle = copyTask->trainDutyCycle;
+			}
+			if (modBits){
+				theTask->doTask |= modBits;
+				pulsedThreadSignal (theTask);
+			}
+			pthread_mutex_unlock (&theTask->taskMutex);
+		}
+		nDone +=1;
+		offload->nDone.store (nDone, std::memory_order_release);
+	}
+	return NULL;
+}
+
+/* ******************* stops the companion thread, after it runs the endFuncs still queued, and frees the offload struct ************/
+static void pulsedThreadOffloadStop (pulsedThreadOffloadStructPtr offload){
+	offload->killWorker.store (1);
+	sem_post (&offload->queueSem);
+	pthread_join (offload->worker, NULL);
+	sem_destroy (&offload->queueSem);
+	pthread_mutex_destroy (&offload->copyTask.taskMutex);
+	pthread_cond_destroy (&offload->copyTask.taskVar);
+	offload->~pulsedThreadOffloadStruct ();
+	free (offload);
+}
 
 /* ************** the thread function needs to be a C-style function, not a class method ********************************************************
 ****************************************************************************************************************************************************
 Last Modified:
+2026/10/19 - stamps the first hi edge of a triggered task, and updates trigger latency stats with the mutex held
+2026/10/19 - updates trigger fd latency stats and missed events with the mutex held, draining the trigger fd without it
+2026/10/19 - sets its timer slack at the start of a task, and puts back the slack of the pool pthread when it returns
+2026/10/19 - stamps task start and end for CPU cost accounting, if it is on
+2026/10/19 - initializes spinEndTime at the start of each task for ACC_MODE_AUTO, which times segments as accLevel 2 does
+2026/10/19 - runs endFuncs with pulsedThreadEndFunc, which queues them for the companion thread if they are offloaded
+2026/10/19 - starts a task at the start time posted by a chained thread, and posts to threads chained to its own edges
+2026/10/19 - waits on the trigger fd, if there is one, and starts a task on an event
+2026/10/19 - records task starts and edges to the installed trace, if there is one
+2026/10/19 - gets start time from the installed clock, if there is one
+2026/10/19 - runs a pattern function in place of pulse/train code if one is installed
+2026/10/19 - runs on a pthread borrowed from pulsedThreadPool, which sets priority, and returns when killThread is set
+2026/10/19 - timing of delay and duration segments moved to inline helpers in pulsedThread.h, so spin windows can be published to the spin coordinator
+2026/10/19 - added armed mode, thread spins on trigger flag instead of waiting on condition variable
 2018/05/23 by Jamie Boyd - changed infinite train while test to while (theTask->doTask & 1), so will stop with an endFunc installed
 2016/12/14 by Jamie Boyd - added endFunc */
 extern "C" void* pulsedThreadFunc (void * tData){
 	// cast tData to task param stuct pointer
 	taskParams *theTask = (taskParams *) tData;
-	// timespec structures for sleeping, acc0
-	struct timespec delaySleeper;
-	struct timespec durSleeper;
-	bool durSleeps;
-	bool delaySleeps;
-	// timeval structures for spinning, acc1 and 2
-	struct timeval pulseDelayUsecs;
-	struct timeval pulseDurUsecs;
-	struct timeval spinEndTime; // we initialize this from current time and then increment with each period
-	// timeval structure of kSLEEPTURNAROUND microseconds  for acc2
-	struct timeval turnaroundTime;
-	// make timers for delay
-	switch (theTask ->accLevel){
-		case ACC_MODE_SLEEPS:
-			configureSleeper (theTask->pulseDelayUsecs, &delaySleeper);
-			break;
-		case ACC_MODE_SLEEPS_AND_SPINS:
-			delaySleeps = configureTurnaroundSleeper (theTask->pulseDelayUsecs, &delaySleeper);
-			configureTimer (theTask->pulseDelayUsecs, &pulseDelayUsecs);
-			break;
-		case ACC_MODE_SLEEPS_AND_OR_SPINS:
-			configureTimer (kSLEEPTURNAROUND, &turnaroundTime);
-			configureTimer (theTask->pulseDelayUsecs, &pulseDelayUsecs);
-			delaySleeps = configureTurnaround (theTask->pulseDelayUsecs);
-			break;
-	}
-	// make timers for duration
-	switch (theTask ->accLevel){
-		case ACC_MODE_SLEEPS:
-			configureSleeper (theTask->pulseDurUsecs, &durSleeper);
-			break;
-		case ACC_MODE_SLEEPS_AND_SPINS:
-			durSleeps = configureTurnaroundSleeper (theTask->pulseDurUsecs, &durSleeper);
-			configureTimer (theTask->pulseDurUsecs, &pulseDurUsecs);
-			break;
-		case ACC_MODE_SLEEPS_AND_OR_SPINS:
-			configureTimer (theTask->pulseDurUsecs, &pulseDurUsecs);
-			durSleeps = configureTurnaround (theTask->pulseDurUsecs);
-			break;
+	// timers for delay and duration, sleepers for acc 0 and 1, timevals for spinning for acc 1 and 2
+	pulsedThreadTimers timers;
+	pulsedThreadConfigTimers (theTask, &timers);
+	// a thread registered with the spin coordinator before it had a pthread pins itself to its core
+	pthread_mutex_lock (&theTask->taskMutex);
+	if (theTask->spinEntry != nullptr){
+		cpu_set_t cpuSet;
+		CPU_ZERO (&cpuSet);
+		CPU_SET (theTask->spinEntry->core.load (), &cpuSet);
+		pthread_setaffinity_np (pthread_self (), sizeof (cpu_set_t), &cpuSet);
 	}
-	// timing is imp., so give thread high priority
-	struct sched_param param ;
-	param.sched_priority = sched_get_priority_max (SCHED_RR) ;
-	pthread_setschedparam (pthread_self (), SCHED_RR, &param) ;
+	pthread_mutex_unlock (&theTask->taskMutex);
+	// trigger time for armed mode, and trigger time for the trigger fd
+	uint64_t triggerNsecs;
+	uint64_t fdTriggerNsecs;
+	bool isChained = false;
+	// timer slack of the pool pthread when borrowed, put back when the thread function returns
+	unsigned long poolSlackNsecs = (unsigned long) prctl (PR_GET_TIMERSLACK, 0, 0, 0, 0);
+	unsigned long slackNsecs = poolSlackNsecs;
 	// loop forever, doing task and modding task
 	for (;;){
-		// get the lock on doTask and wait for a task to be called, or a timing or customMod param to be modded
+		// get the lock on doTask and wait for a task to be called, or a timing or customMod param to be modded, or to be armed
 		pthread_mutex_lock (&theTask->taskMutex);
-		while (theTask->doTask==0)
-			pthread_cond_wait(&theTask->taskVar, &theTask->taskMutex);
-		// look for modifications of the taskVar that reconfigure sleepers
-		if (theTask->doTask & kMODANY){
-			if (theTask->doTask & kMODDELAY){
-#if beVerbose
-				printf ("thread received  signal with new delay = %d\n", theTask->pulseDelayUsecs);
-#endif
-				switch (theTask ->accLevel){
-					case ACC_MODE_SLEEPS:
-						configureSleeper (theTask->pulseDelayUsecs, &delaySleeper);
-						break;
-					case ACC_MODE_SLEEPS_AND_SPINS:
-						delaySleeps = configureTurnaroundSleeper (theTask->pulseDelayUsecs, &delaySleeper);
-						configureTimer (theTask->pulseDelayUsecs, &pulseDelayUsecs);
-						break;
-					case ACC_MODE_SLEEPS_AND_OR_SPINS:
-						configureTimer (theTask->pulseDelayUsecs, &pulseDelayUsecs);
-						delaySleeps = configureTurnaround (theTask->pulseDelayUsecs);
-						break;
-				}
-				theTask->doTask -= kMODDELAY;
-			}
-			if (theTask->doTask & kMODDUR){
-#if beVerbose
-				printf ("thread received  signal with new duration = %d\n", theTask->pulseDurUsecs);
-#endif
-				switch (theTask ->accLevel){
-					case ACC_MODE_SLEEPS:
-						configureSleeper (theTask->pulseDurUsecs, &durSleeper);
-						break;
-					case ACC_MODE_SLEEPS_AND_SPINS:
-						durSleeps = configureTurnaroundSleeper (theTask->pulseDurUsecs, &durSleeper);
-						configureTimer (theTask->pulseDurUsecs, &pulseDurUsecs);
-						break;
-					case ACC_MODE_SLEEPS_AND_OR_SPINS:
-						configureTimer (theTask->pulseDurUsecs, &pulseDurUsecs);
-						durSleeps = configureTurnaround (theTask->pulseDurUsecs);
-						break;
-					}
-				theTask->doTask -= kMODDUR;
+		fdTriggerNsecs = 0;
+		while ((theTask->doTask==0) && (theTask->armMode == kARM_OFF) && (theTask->killThread == 0)){
+			if (theTask->triggerFd < 0){
+				pthread_cond_wait(&theTask->taskVar, &theTask->taskMutex);
+				continue;
 			}
-			if (theTask->doTask & kMODCUSTOM){
-				theTask->modCustomFunc (theTask->modCustomData, theTask);
-				theTask->doTask -= kMODCUSTOM;
+			// wait on the trigger fd and the wake fd, an event on the trigger fd requests a task, as DoTask does
+			fdTriggerNsecs = pulsedThreadTriggerWait (theTask);
+			if (fdTriggerNsecs != 0){
+				if (theTask->nPulses == kINFINITETRAIN){
+					theTask->doTask |= 1;
+				}else{
+					theTask->doTask +=1;
+				}
 			}
-			// if after modifying timing and custom mods, we have no task to do, unlock mutex and go to top of loop, waiting on doTask again
-			if (theTask->doTask == 0){
+		}
+		// being destroyed, and no task left to do, so give the pthread back to the pool
+		if ((theTask->killThread) && ((theTask->doTask & ~kMODANY) == 0)){
+			pthread_mutex_unlock (&theTask->taskMutex);
+			break;
+		}
+		// look for modifications of the taskVar that reconfigure sleepers
+		if (theTask->doTask & kMODANY){
+			pulsedThreadDoMods (theTask, &timers);
+			// if after modifying timing and custom mods, we have no task to do and are not armed, unlock mutex and go to top of loop, waiting on doTask again
+			if ((theTask->doTask == 0) && (theTask->armMode == kARM_OFF)){
 				pthread_mutex_unlock (&theTask->taskMutex);
 				continue;
 			}
 		}
-		// we are done with modding doTask, so unlock the mutex
-		pthread_mutex_unlock (&theTask->taskMutex);
-		 // initalize spinEndTime to current time once for 
-		if (theTask->accLevel == ACC_MODE_SLEEPS_AND_OR_SPINS){
-			gettimeofday (&spinEndTime, NULL);
-		}
-		// do the task(s) as per nPulses
-		switch (theTask->nPulses){
-			case kPULSE:
-				if (theTask->pulseDelayUsecs > 0){
-					if  (theTask ->accLevel ==ACC_MODE_SLEEPS){
-						nanosleep (&delaySleeper, NULL);
-					}else{
-						
-						if  (theTask ->accLevel ==ACC_MODE_SLEEPS_AND_SPINS){
-							gettimeofday (&spinEndTime, NULL);
-							timeradd (&spinEndTime, &pulseDelayUsecs, &spinEndTime);
-							WAITINLINE1 (delaySleeps, &delaySleeper, &spinEndTime);
-						}else{
-							timeradd (&spinEndTime, &pulseDelayUsecs, &spinEndTime);
-							WAITINLINE2 (delaySleeps, &turnaroundTime, &spinEndTime);
-						}
-					}
-				}
-				theTask->hiFunc(theTask->taskData);
-				if (theTask ->accLevel == 0){
-					nanosleep (&durSleeper, NULL);
+		triggerNsecs =0;
+		if (theTask->doTask == 0){
+			// armed with no task to do. Clear any stale trigger or wake, unlock the mutex, and spin on the trigger flag
+			int spinMode = theTask->armMode;
+			theTask->armTrigger.triggerNsecs.store (0, std::memory_order_relaxed);
+			theTask->armTrigger.wake.store (0, std::memory_order_relaxed);
+			pthread_mutex_unlock (&theTask->taskMutex);
+			triggerNsecs = pulsedThreadArmSpin (theTask, spinMode, isChained);
+			if (triggerNsecs == 0){ // disarmed, or a modification was requested
+				continue;
+			}
+			if (isChained){
+				// a chained start is not requested with DoTask, so request the task as DoTask does, then wait for the posted start time
+				pthread_mutex_lock (&theTask->taskMutex);
+				if (theTask->nPulses == kINFINITETRAIN){
+					theTask->doTask |= 1;
 				}else{
-					
-					if  (theTask ->accLevel ==ACC_MODE_SLEEPS_AND_SPINS){
-						gettimeofday (&spinEndTime, NULL);
-						timeradd (&spinEndTime, &pulseDurUsecs, &spinEndTime);
-						WAITINLINE1 (durSleeps, &durSleeper, &spinEndTime);
-					}else{
-						timeradd (&spinEndTime, &pulseDurUsecs, &spinEndTime);
-						WAITINLINE2 (durSleeps, &turnaroundTime, &spinEndTime);
-					}
-				}
-				theTask->loFunc(theTask->taskData);
-				if (theTask->endFunc != nullptr){
-					theTask->endFunc (theTask->endFuncData, theTask);
+					theTask->doTask +=1;
 				}
-			break;
-                
-		case kINFINITETRAIN: //an infinite train - don't decrement the queue, and check for delay, duration mods without breaking
-			while (theTask->doTask & 1){
-				if (theTask->doTask & kMODANY){
-					pthread_mutex_lock (&theTask->taskMutex);
-					if (theTask->doTask & kMODDELAY){
-						switch (theTask ->accLevel){
-							case ACC_MODE_SLEEPS:
-								configureSleeper (theTask->pulseDelayUsecs, &delaySleeper);
-								break;
-							case ACC_MODE_SLEEPS_AND_SPINS:
-								delaySleeps = configureTurnaroundSleeper (theTask->pulseDelayUsecs, &delaySleeper);
-								configureTimer (theTask->pulseDelayUsecs, &pulseDelayUsecs);
-								break;
-							case ACC_MODE_SLEEPS_AND_OR_SPINS:
-								configureTimer (theTask->pulseDelayUsecs, &pulseDelayUsecs);
-								delaySleeps = configureTurnaround (theTask->pulseDelayUsecs);
-								break;
-						}
-						theTask->doTask -= kMODDELAY;
-					}
-					if (theTask->doTask & kMODDUR){
-						switch (theTask ->accLevel){
-							case ACC_MODE_SLEEPS:
-								configureSleeper (theTask->pulseDurUsecs, &durSleeper);
-								break;
-							case ACC_MODE_SLEEPS_AND_SPINS:
-								durSleeps = configureTurnaroundSleeper (theTask->pulseDurUsecs, &durSleeper);
-								configureTimer (theTask->pulseDurUsecs, &pulseDurUsecs);
-								break;
-							case ACC_MODE_SLEEPS_AND_OR_SPINS:
-								configureTimer (theTask->pulseDurUsecs, &pulseDurUsecs);
-								durSleeps = configureTurnaround (theTask->pulseDurUsecs);
-								break;
-						}
-						theTask->doTask -= kMODDUR;
-					}
-					if (theTask->doTask & kMODCUSTOM){
-						theTask->modCustomFunc(theTask->modCustomData,theTask);
-						theTask->doTask -= kMODCUSTOM;
+				pthread_mutex_unlock (&theTask->taskMutex);
+				pulsedThreadWaitNanos (triggerNsecs);
+			}
+		}else{
+			// we are done with modding doTask, so unlock the mutex
+			pthread_mutex_unlock (&theTask->taskMutex);
+		}
+		// a triggered task stamps its first hi edge, for latency from the trigger to the edge
+		theTask->firstEdgeNsecs = 0;
+		theTask->stampFirstEdge = ((triggerNsecs != 0) || (fdTriggerNsecs != 0));
+		// timer slack, set by the pthread as it only applies to the calling thread
+		if (((theTask->timerSlackNsecs == 0) ? poolSlackNsecs : theTask->timerSlackNsecs) != slackNsecs){
+			slackNsecs = (theTask->timerSlackNsecs == 0) ? poolSlackNsecs : theTask->timerSlackNsecs;
+			prctl (PR_SET_TIMERSLACK, slackNsecs, 0, 0, 0);
+		}
+		 // initalize spinEndTime to current time once for accLevel 2 and 3, for accLevel 0 with coalescing, or for any accLevel when a clock is installed
+		if ((theTask->accLevel == ACC_MODE_SLEEPS_AND_OR_SPINS) || (theTask->accLevel == ACC_MODE_AUTO) || (theTask->coalesceUsecs != 0) || (theTask->clock != nullptr)){
+			pulsedThreadGetTime (theTask, &timers.spinEndTime);
+		}
+		pulsedThreadCpuStamp (theTask, kCPU_CALLBACK);
+		pulsedThreadEdgeHooks (theTask, 0, kTRACE_START);
+		// do the task(s) as per nPulses, or as per the pattern function
+		if (theTask->patternFunc != nullptr){
+			theTask->patternFunc (theTask, &timers);
+		}else{
+			switch (theTask->nPulses){
+				case kPULSE:
+					if (theTask->pulseDelayUsecs > 0){
+						pulsedThreadWaitSegment (theTask, &timers, &timers.delay);
 					}
-					pthread_mutex_unlock (&theTask->taskMutex);
-				}
-				if (theTask->hiFunc != nullptr){
+					pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
 					theTask->hiFunc(theTask->taskData);
-				}
-				if (theTask ->accLevel == 0){
-					nanosleep (&durSleeper, NULL);
-				}else{
-					
-					if  (theTask ->accLevel ==ACC_MODE_SLEEPS_AND_SPINS){
-						gettimeofday (&spinEndTime, NULL);
-						timeradd (&spinEndTime, &pulseDurUsecs, &spinEndTime);
-						WAITINLINE1 (durSleeps, &durSleeper, &spinEndTime);
-					}else{
-						timeradd (&spinEndTime, &pulseDurUsecs, &spinEndTime);
-						WAITINLINE2 (durSleeps, &turnaroundTime, &spinEndTime);
+					pulsedThreadWaitSegment (theTask, &timers, &timers.dur);
+					pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+					theTask->loFunc(theTask->taskData);
+					pulsedThreadEndFunc (theTask);
+				break;
+                
+			case kINFINITETRAIN: //an infinite train - don't decrement the queue, and check for delay, duration mods without breaking
+				while (theTask->doTask & 1){
+					if (theTask->doTask & kMODANY){
+						pthread_mutex_lock (&theTask->taskMutex);
+						pulsedThreadDoMods (theTask, &timers);
+						pthread_mutex_unlock (&theTask->taskMutex);
 					}
-				}
-				if (theTask->pulseDelayUsecs > 0){
-					if (theTask->loFunc != nullptr){
-						theTask->loFunc(theTask->taskData);
+					pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+					if (theTask->hiFunc != nullptr){
+						theTask->hiFunc(theTask->taskData);
 					}
-					if  (theTask ->accLevel ==ACC_MODE_SLEEPS){
-						nanosleep (&delaySleeper, NULL);
-					}else{
-						
-						if  (theTask ->accLevel ==ACC_MODE_SLEEPS_AND_SPINS){
-							gettimeofday (&spinEndTime, NULL);
-							timeradd (&spinEndTime, &pulseDelayUsecs, &spinEndTime);
-							WAITINLINE1 (delaySleeps, &delaySleeper, &spinEndTime);
-						}else{
-							timeradd (&spinEndTime, &pulseDelayUsecs, &spinEndTime);
-							WAITINLINE2 (delaySleeps, &turnaroundTime, &spinEndTime);
+					pulsedThreadWaitSegment (theTask, &timers, &timers.dur);
+					if (theTask->pulseDelayUsecs > 0){
+						pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+						if (theTask->loFunc != nullptr){
+							theTask->loFunc(theTask->taskData);
 						}
+						pulsedThreadWaitSegment (theTask, &timers, &timers.delay);
 					}
+					pulsedThreadEndFunc (theTask);
 				}
-				if (theTask->endFunc != nullptr){
-					theTask->endFunc (theTask->endFuncData, theTask);
-				}
-			}
-			break;
+				break;
 			
-		default: // kTRAIN
+			default: // kTRAIN
 #if beVerbose
-			printf ("A train was called with doTask = %d and nPulses = %d.\n", theTask->doTask, theTask->nPulses);
+				printf ("A train was called with doTask = %d and nPulses = %d.\n", theTask->doTask, theTask->nPulses);
 #endif
-			for (unsigned int iTick=0; iTick < theTask->nPulses; iTick++){
-				if (theTask->pulseDurUsecs > 0) {
-					theTask->hiFunc(theTask->taskData);
-					if (theTask ->accLevel == ACC_MODE_SLEEPS){
-						nanosleep (&durSleeper, NULL);
-					}else{
-						if  (theTask ->accLevel ==ACC_MODE_SLEEPS_AND_SPINS){
-							gettimeofday (&spinEndTime, NULL);
-							timeradd (&spinEndTime, &pulseDurUsecs, &spinEndTime);
-							WAITINLINE1 (durSleeps, &durSleeper, &spinEndTime);
-						}else{
-							timeradd (&spinEndTime, &pulseDurUsecs, &spinEndTime);
-							WAITINLINE2 (durSleeps, &turnaroundTime, &spinEndTime);
-						}
+				for (unsigned int iTick=0; iTick < theTask->nPulses; iTick++){
+					if (theTask->killThread){
+						break;
 					}
-				}
-				if (theTask->pulseDelayUsecs > 0){
-					theTask->loFunc(theTask->taskData);
-					if  (theTask ->accLevel ==ACC_MODE_SLEEPS){
-						nanosleep (&delaySleeper, NULL);
-					}else{
-						if  (theTask ->accLevel ==ACC_MODE_SLEEPS_AND_SPINS){
-							gettimeofday (&spinEndTime, NULL);
-							timeradd (&spinEndTime, &pulseDelayUsecs, &spinEndTime);
-							WAITINLINE1 (delaySleeps, &delaySleeper, &spinEndTime);
-						}else{
-							timeradd (&spinEndTime, &pulseDelayUsecs, &spinEndTime);
-							WAITINLINE2 (delaySleeps, &turnaroundTime, &spinEndTime);
-						}
+					if (theTask->pulseDurUsecs > 0) {
+						pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+						theTask->hiFunc(theTask->taskData);
+						pulsedThreadWaitSegment (theTask, &timers, &timers.dur);
+					}
+					if (theTask->pulseDelayUsecs > 0){
+						pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+						theTask->loFunc(theTask->taskData);
+						pulsedThreadWaitSegment (theTask, &timers, &timers.delay);
 					}
 				}
+				pulsedThreadEndFunc (theTask);
+				break;
 			}
-			if (theTask->endFunc != nullptr){
-				theTask->endFunc (theTask->endFuncData, theTask);
-			}
-			break;
 		}
+		// threads chained to the end of the task
+		if (theTask->chain != nullptr){
+			pulsedThreadChainEdge (theTask->chain, 0, kCHAIN_END);
+		}
+		// update latency stats for a triggered task now that the task is done and timing is not critical, with the mutex, as other threads read and reset them
+		theTask->stampFirstEdge = false;
+		// events that came on the trigger fd while the task was running are missed. Drain them without the mutex, count them with it
+		pthread_mutex_lock (&theTask->taskMutex);
+		int drainFd = theTask->triggerFd;
+		int drainFdMode = theTask->triggerFdMode;
+		pthread_mutex_unlock (&theTask->taskMutex);
+		uint64_t nMissed = 0;
+		if (drainFd >= 0){
+			nMissed = pulsedThreadTriggerDrain (drainFd, drainFdMode);
+		}
+		pthread_mutex_lock (&theTask->taskMutex);
+		if ((triggerNsecs != 0) && (theTask->firstEdgeNsecs != 0)){
+			pulsedThreadLatencyAdd (&theTask->armLatency, triggerNsecs, theTask->firstEdgeNsecs);
+		}
+		if ((fdTriggerNsecs != 0) && (theTask->firstEdgeNsecs != 0)){
+			pulsedThreadLatencyAdd (&theTask->fdLatency, fdTriggerNsecs, theTask->firstEdgeNsecs);
+		}
+		theTask->fdMissed += nMissed;
+		pthread_mutex_unlock (&theTask->taskMutex);
+		// free the chain post, so the next chained start can be posted
+		if ((triggerNsecs != 0) && (isChained)){
+			theTask->armTrigger.chainNsecs.store (0, std::memory_order_release);
+		}
+		pulsedThreadCpuStamp (theTask, kCPU_IDLE);
 		// dont decrement doTask if task is an infinite train, else decrement it as we have done a task
 		if (theTask->nPulses != kINFINITETRAIN){
 			pthread_mutex_lock (&theTask->taskMutex);
@@ -285,15 +499,128 @@ extern "C" void* pulsedThreadFunc (void * tData){
 		printf ("Finished a task\n");
 #endif
     }
+	if (slackNsecs != poolSlackNsecs){
+		prctl (PR_SET_TIMERSLACK, poolSlackNsecs, 0, 0, 0);
+	}
     return NULL;
 }
 
 
 
+/* ****************************************************************************************************
+Sets every field of the task, and of the class, that the destructor and stopThread look at to its starting value, before anything can fail,
+so a pulsedThread whose constructor fails can still be deleted. The mutex and condition variable are not initialized here, see initTaskData
+Last Modified:
+2026/10/19 - initial version, moved from the two constructors, which set these fields only after the timing was checked */
+void pulsedThread::initTask (void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel){
+	taskMutexIsInit = false;
+	theTask.taskData = nullptr;
+	// no timing until ticks2Times or times2Ticks has checked it
+	theTask.nPulses = kPULSE;
+	theTask.pulseDelayUsecs = 0;
+	theTask.pulseDurUsecs = 0;
+	theTask.loFunc = gLoFunc;
+	theTask.hiFunc =gHiFunc;
+	theTask.modQueued =0; // custom modification queue starts empty
+	theTask.spinEntry = nullptr; // not registered with spin coordinator
+	theTask.modDone =0;
+	for (unsigned int iReq =0; iReq < kMOD_QUEUE_SIZE; iReq +=1){
+		theTask.modQueue [iReq] = {nullptr, nullptr, 0};
+	}
+	theTask.endFunc = nullptr;
+	theTask.endFuncData = nullptr;
+	delTaskDataFunc = nullptr; //this function pointer is initialised null , as we don't always have a function
+	delEndFuncDataFunc = nullptr;
+	endFuncDataIsArray = false;
+	theTask.accLevel =gAccLevel;
+	// start doTask at 0
+	theTask.doTask =0;
+	// not armed to start with
+	theTask.armMode = kARM_OFF;
+	// no pthread until one is needed
+	theTask.threadState = kTHREAD_NONE;
+	theTask.killThread = 0;
+	// normal pulse or train, not a pattern
+	theTask.patternFunc = nullptr;
+	theTask.patternData = nullptr;
+	// real time, not a virtual clock
+	theTask.clock = nullptr;
+	// not recording edges
+	theTask.trace = nullptr;
+	theTask.armTrigger.triggerNsecs.store (0);
+	theTask.armTrigger.wake.store (0);
+	theTask.stampFirstEdge = false;
+	theTask.firstEdgeNsecs = 0;
+	theTask.armTrigger.chainNsecs.store (0);
+	theTask.armLatency = {0,0,0,0};
+	// no chained threads
+	theTask.chain = nullptr;
+	chainData.nLinks = 0;
+	// endFuncs run on the pthread
+	theTask.offload = nullptr;
+	// no CPU cost accounting
+	theTask.cpuAccount = nullptr;
+	// wakes up on its own, with the timer slack of the pthread
+	theTask.coalesceUsecs = 0;
+	theTask.timerSlackNsecs = 0;
+	// no trigger fd
+	theTask.triggerFd = -1;
+	theTask.triggerFdMode = kTRIGFD_EVENTFD;
+	theTask.wakeFd = -1;
+	theTask.fdLatency = {0,0,0,0};
+	theTask.fdMissed = 0;
+	// all command slots start free
+	for (int iSlot =0; iSlot < kMOD_SLOTS; iSlot +=1){
+		modSlots [iSlot].inUse.store (0);
+	}
+}
+
+/* ****************************************************************************************************
+Run by the constructors once the timing is good. Measures host latency for ACC_MODE_AUTO, initializes the task with the passed in
+init func, or just sets a pointer to init data if no initFunc, and then initializes the mutex and condition var. Returns the error from initFunc
+Last Modified:
+2026/10/19 - initial version, moved from the two constructors, and records that the mutex was initialized */
+int pulsedThread::initTaskData (void *  initData, int (*initFunc)(void *, void * &)){
+	// measure host latency here, on the control thread, so the pthread never has to
+	if (theTask.accLevel == ACC_MODE_AUTO){
+		pulsedThreadMeasureHostLatency ();
+	}
+	int errCode = 0;
+	if (initFunc == nullptr){
+#if beVerbose
+		printf ("pulsedThread constructor initFunc == nullptr; taskData initialized with copy of initData pointer.\n");
+#endif
+		theTask.taskData = initData;
+	}else{
+#if beVerbose
+		printf ("pulsedThread constructor is running the provided initFunc\n");
+#endif
+		errCode =initFunc(initData , theTask.taskData);
+	}
+	if (errCode){
+#if beVerbose
+		printf ("pulsedThread initialization callback error: %d\n", errCode);
+#endif
+		return errCode;
+	}
+	// init mutex and condition var
+	pthread_mutex_init(&theTask.taskMutex, NULL);
+	pthread_cond_init (&theTask.taskVar, NULL);
+	taskMutexIsInit = true;
+	// pthread is borrowed from pulsedThreadPool by startThread, when the task first needs it
+	return 0;
+}
+
 /* ********************************************* pulsedThead Class Methods*******************************************************************************
 ************************************************************************************************************************************************************
 Same constructors for all 3 tasks
 Last Modified:
+2026/10/19 - fields are set by initTask before the timing is checked, so a failed pulsedThread can be deleted, and the rest is done by initTaskData
+2026/10/19 - custom modification queue slots start zeroed, and endFuncData starts nullptr in both constructors
+2026/10/19 - an ACC_MODE_AUTO thread measures the host latency, if not yet measured, on the calling thread
+2026/10/19 - endFuncData does not start as an array struct
+2026/10/19 - coalescing starts off, with default timer slack
+2026/10/19 - CPU cost accounting starts off
 2017/11/22 by Jamie Boyd - added nullptr test for init function before running it.
 2016/12/06 by Jamie Boyd added loFunc and hiFunc function pointers for flexibility 
 2016/12/12 by Jamie Boyd - removed mode as separate paramater, redundant info with nPulses
@@ -301,6 +628,7 @@ Last Modified:
 pulsedThread::pulsedThread (unsigned int gDelay, unsigned int gDur, unsigned int gPulses, void *  initData, 
 int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode){
 	
+	initTask (gLoFunc, gHiFunc, gAccLevel);
 	errCode = ticks2Times (gDelay, gDur, gPulses, theTask);
 	if (errCode){
 #if beVerbose
@@ -313,45 +641,13 @@ int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void
 		theTask.nPulses = gPulses; // 0 = infinite train, 1 = single pulse, >=2  = number of pulses in a train, 
 		theTask.pulseDelayUsecs = gDelay ; // delay to pulse, in microseconds
 		theTask.pulseDurUsecs = gDur; // pulse length, in microseconds
-		theTask.loFunc = gLoFunc;
-		theTask.hiFunc =gHiFunc;
-		theTask.modCustomData = nullptr; // this pointer is initialised null , as we don't always use it
-		theTask.endFunc = nullptr;
-		theTask.endFuncData = nullptr;
-		delTaskDataFunc = nullptr; //this function pointer is initialised null , as we don't always have a function
-		delEndFuncDataFunc = nullptr;
-		theTask.accLevel =gAccLevel;
-		// start doTask at 0
-		theTask.doTask =0;
-		// initialize the task with passed in init func
-		errCode = 0;
-		if (initFunc == nullptr){
-#if beVerbose
-			printf ("pulsedThread constructor initFunc == nullptr; taskData initialized with copy of initData pointer.\n");
-#endif
-			theTask.taskData = initData;
-		}else{
-#if beVerbose
-			printf ("pulsedThread constructor is running the provided initFunc\n");
-#endif
-			errCode =initFunc(initData , theTask.taskData);
-		}
-		if (errCode){
-#if beVerbose
-			printf ("pulsedThread initialization callback error: %d\n", errCode);
-#endif
-		}else{
-			// init mutex and condition var
-			pthread_mutex_init(&theTask.taskMutex, NULL);
-			pthread_cond_init (&theTask.taskVar, NULL);
-			// create thread
-			pthread_create(&theTask.taskThread, NULL, &pulsedThreadFunc, (void *)&theTask);
-		}
+		errCode = initTaskData (initData, initFunc);
 	}
 }
 
 pulsedThread::pulsedThread (float gFrequency, float gDutyCycle, float gTrainDuration, void *  initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode){
 
+	initTask (gLoFunc, gHiFunc, gAccLevel);
 	errCode = times2Ticks (gFrequency, gDutyCycle, gTrainDuration, theTask);
 	if (errCode){
 #if beVerbose
@@ -364,42 +660,27 @@ pulsedThread::pulsedThread (float gFrequency, float gDutyCycle, float gTrainDura
 		theTask.trainFrequency = gFrequency;
 		theTask.trainDuration = gTrainDuration;
 		theTask.trainDutyCycle = gDutyCycle;
-		theTask.loFunc = gLoFunc;
-		theTask.hiFunc =gHiFunc;
-		theTask.modCustomData = nullptr; // this pointer is initialised null , as we don't always use it
-		theTask.endFunc = nullptr;
-		theTask.accLevel =gAccLevel;
-		delTaskDataFunc = nullptr;
-		delEndFuncDataFunc = nullptr;
-		// start doTask at 0
-		theTask.doTask =0;
-		// initialize the task with passed in init func, or just set a pointer to init data if no initFunc
-		errCode = 0;
-		if (initFunc == nullptr){
-#if beVerbose
-			printf ("pulsedThread constructor initFunc == nullptr; taskData initialized with copy of initData pointer.\n");
-#endif
-			theTask.taskData = initData;
-		}else{
-#if beVerbose
-			printf ("pulsedThread constructor is running the provided initFunc\n");
-#endif
-			errCode =initFunc(initData , theTask.taskData);
-		}
-		if (errCode){
-#if beVerbose
-			printf ("pulsedThread initialization callback error: %d\n", errCode);
-#endif
-		}else{
-			// init mutex and condition var
-			pthread_mutex_init(&theTask.taskMutex, NULL);
-			pthread_cond_init (&theTask.taskVar, NULL);
-			// create thread
-			pthread_create(&theTask.taskThread, NULL, &pulsedThreadFunc, (void *)&theTask);
-		}
+		errCode = initTaskData (initData, initFunc);
+	}
+}
+
+
+/* ****************************************************************************************************
+taskParams is aligned to cache lines. Operator new before C++17 only guarantees alignment for fundamental types,
+so pulsedThreads and subclasses are allocated with posix_memalign
+Last Modified:
+2026/10/19 - initial version */
+void * pulsedThread::operator new (size_t size){
+	void * ptr;
+	if (posix_memalign (&ptr, alignof (pulsedThread), size) != 0){
+		throw std::bad_alloc ();
 	}
+	return ptr;
 }
 
+void pulsedThread::operator delete (void * ptr){
+	free (ptr);
+}
 
 /* ****************************************************************************************************
 gets the lock on the task and increments doTask to signal the thread to do task it is configured to do
@@ -417,7 +698,7 @@ void pulsedThread::DoTask(void){
 			theTask.doTask +=1;
 		}
 	}
-	pthread_cond_signal(&theTask.taskVar);
+	signalTask ();
 	pthread_mutex_unlock( &theTask.taskMutex );
 }
 
@@ -436,7 +717,7 @@ void pulsedThread::DoTasks(unsigned int nTasks){
 			theTask.doTask +=nTasks;
 		}
 	}
-	pthread_cond_signal(&theTask.taskVar);
+	signalTask ();
 	pthread_mutex_unlock( &theTask.taskMutex );
 }
 
@@ -451,92 +732,566 @@ void pulsedThread::UnDoTasks (void){
     if (theTask.doTask > 1) { // no need to do anything unless 1 or more tasks still left to do
         pthread_mutex_lock (&theTask.taskMutex);
 	theTask.doTask =1;
-        pthread_cond_signal(&theTask.taskVar);
+        pulsedThreadSignal (&theTask);
         pthread_mutex_unlock( &theTask.taskMutex);
     }
 }
 
-
+
+/* ****************************************************************************************************
+// gets the lock on the task and increments doTask to signal the thread to do task it is configured to do nTasks times
+//Last Modified:
+2018/11/05 by Jmie Boyd - added bounds checking
+2018/10/25 by Jamie Boyd - initial version */
+void pulsedThread::DoOrUndoTasks(int nTasks){
+	// for infinite task, this function is a NOP
+	if (theTask.nPulses != kINFINITETRAIN){
+		pthread_mutex_lock (&theTask.taskMutex);
+		// scrunch resulting value of doTask between 0 and kMODDELAY (first of signal bits)
+		unsigned int currentTasks = (theTask.doTask &~kMODANY);
+		if ((int)(currentTasks + nTasks) < 0){
+			theTask.doTask &= 1;
+		}else{
+			if ((int)currentTasks + nTasks >= kMODDELAY){
+				theTask.doTask = kMODDELAY -1;
+			}else{
+				theTask.doTask +=nTasks;
+			}
+		}
+		signalTask ();
+		pthread_mutex_unlock( &theTask.taskMutex );
+	}
+}
+/* ****************************************************************************************************
+/returns 0 if a thread is not currently doing a task, else returns number of tasks still left to do
+Last Modified:
+2026/10/19 - leaves out the signal bits for modifications the pthread has not done yet, which are not tasks
+2015/09/28 by Jamie Boyd -  initial verison */
+int pulsedThread::isBusy(){
+	pthread_mutex_lock (&theTask.taskMutex);
+	int taskNum = theTask.doTask & ~kMODANY;
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return taskNum;
+}
+
+
+/* *****************************************************************************************************
+waits until a thread is no longer doing a task, then returns
+Last modified:
+2026/10/19 - waits only for tasks, not for signal bits of modifications
+2018/05/23 by Jamie Boyd - changed timing from simple loop of nSleep to calculating end time and using timercmp
+2016/12/09 by Jamie Boyd - added paramater for timeout, and added return value for timed out vs not busy */
+int pulsedThread::waitOnBusy(float waitSecs){
+	// make timers, one for current time and one for current time + wait seconds
+	struct timeval currentTime;
+	struct timeval endTime;
+	struct timeval waitTime;
+	configureTimer ((waitSecs * 1E06), &waitTime);
+	gettimeofday (&endTime, NULL);
+	timeradd (&endTime, &waitTime, &endTime);
+	// make a timSpec sleeper for sleepTurnaround, typically 200 mSec
+	struct timespec Sleeper;
+	configureSleeper (kSLEEPTURNAROUND, &Sleeper);
+	// check if tasks are done, sleep, check if time is up, repeat
+	int taskNum;
+	do{
+		pthread_mutex_lock (&theTask.taskMutex);
+		taskNum = theTask.doTask & ~kMODANY;
+		pthread_mutex_unlock( &theTask.taskMutex);
+		if (taskNum ==0){
+			break;
+		}
+		nanosleep (&Sleeper, NULL);
+		gettimeofday (&currentTime, NULL);
+	}while (timercmp (&currentTime, &endTime, <));
+	return taskNum;
+}
+
+/* ***************************************************************************************************
+gets the lock on the task and sets doTask bit 0 to signal the thread to start train
+Last Modified 2015/09/28 by Jamie Boyd */
+void pulsedThread::startInfiniteTrain (void){
+	if ((theTask.nPulses == kINFINITETRAIN) && (!(theTask.doTask & 1))){
+		pthread_mutex_lock (&theTask.taskMutex);
+		theTask.doTask |= 1;
+		signalTask ();
+		pthread_mutex_unlock( &theTask.taskMutex);
+	}else{
+#if beVerbose
+		printf ("startInfiniteTrainError: theTask.nPulses = %d, theTask.doTask = %d.\n", theTask.nPulses , theTask.doTask);
+#endif
+	}
+}
+
+/* ****************************************************************************************************
+Called with the mutex held after doTask has been changed. If the thread is armed, it is spinning on the trigger
+flag, not waiting on the condition variable, so store the current time in the trigger flag if there is a task to do.
+Condition variable is signalled in either case, as thread may not have got to spinning yet
+Last Modified:
+2026/10/19 - starts the pthread if the task does not have one yet
+2026/10/19 - initial version */
+void pulsedThread::signalTask (void){
+	startThread ();
+	if ((theTask.armMode != kARM_OFF) && (theTask.doTask & ~kMODANY)){
+		theTask.armTrigger.triggerNsecs.store (pulsedThreadNanos(), std::memory_order_release);
+	}
+	pulsedThreadSignal (&theTask);
+}
+
+/* ****************************************************************************************************
+Called with the mutex held by anything that needs the pthread to be running, tasks, arming, and custom modifications.
+Timing modifications made before then need no signal, as the pthread configures its timers from the task when it starts
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThread::startThread (void){
+	if (theTask.threadState == kTHREAD_NONE){
+		if (pulsedThreadPool::runTask (&theTask)){
+#if beVerbose
+			printf ("startThread error: could not get a pthread from the pool.\n");
+#endif
+		}
+	}
+}
+
+/* ****************************************************************************************************
+Called with the mutex held after delay and/or duration have been changed. A running pthread is signalled to reconfigure its timers with the
+signal bits. Without a pthread, there are no timers to reconfigure, so no bits are set, as nothing would clear them, and isBusy, and the setters
+that need an idle thread, would see them forever
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThread::signalMods (unsigned int modBits){
+	if (theTask.threadState == kTHREAD_RUNNING){
+		theTask.doTask |= modBits;
+		pulsedThreadSignal (&theTask);
+	}
+}
+
+/* ****************************************************************************************************
+Arms the thread, so when it has no tasks left to do it spins on the trigger flag instead of sleeping on the
+condition variable. The next DoTask starts the task as soon as the thread sees the flag change. 
+Last Modified:
+2026/10/19 - wakes a spinning thread with its own wake flag, not a sentinel trigger time
+2026/10/19 - initial version */
+int pulsedThread::arm (int spinMode){
+	if ((spinMode != kARM_SPIN) && (spinMode != kARM_SPIN_PAUSE) && (spinMode != kARM_SPIN_YIELD)){
+#if beVerbose
+		printf ("arm error: spin mode %d is not one of kARM_SPIN, kARM_SPIN_PAUSE, or kARM_SPIN_YIELD.\n", spinMode);
+#endif
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	// a chain post left from before the thread was disarmed is stale
+	if (theTask.armMode == kARM_OFF){
+		theTask.armTrigger.chainNsecs.store (0, std::memory_order_relaxed);
+	}
+	theTask.armMode = spinMode;
+	startThread ();
+	// wake a spinning thread so it picks up the new spin mode
+	theTask.armTrigger.wake.store (1, std::memory_order_release);
+	pulsedThreadSignal (&theTask);
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return 0;
+}
+
+/* ****************************************************************************************************
+Disarms the thread, a spinning thread goes back to waiting on the condition variable
+Last Modified:
+2026/10/19 - wakes a spinning thread with its own wake flag, not a sentinel trigger time
+2026/10/19 - initial version */
+void pulsedThread::disarm (void){
+	pthread_mutex_lock (&theTask.taskMutex);
+	theTask.armMode = kARM_OFF;
+	theTask.armTrigger.wake.store (1, std::memory_order_release);
+	pthread_mutex_unlock( &theTask.taskMutex);
+}
+
+int pulsedThread::getArmMode (void){
+	return theTask.armMode;
+}
+
+// latency, in nanoseconds, from DoTask to the first hi edge of the most recent triggered task
+uint64_t pulsedThread::getTriggerLatency (void){
+	pthread_mutex_lock (&theTask.taskMutex);
+	uint64_t lastNsecs = theTask.armLatency.lastNsecs;
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return lastNsecs;
+}
+
+/* ****************************************************************************************************
+Returns number of tasks started from armed mode since last reset, and fills min and max latency, from trigger to first hi edge, in nanoseconds.
+Stats are written by the thread, with the mutex held, after each triggered task, so get the mutex for a consistent set
+Last Modified:
+2026/10/19 - latency is to the first hi edge, not to the start of the task
+2026/10/19 - initial version */
+uint64_t pulsedThread::getTriggerLatencyStats (uint64_t & minNsecs, uint64_t & maxNsecs){
+	pthread_mutex_lock (&theTask.taskMutex);
+	minNsecs = theTask.armLatency.minNsecs;
+	maxNsecs = theTask.armLatency.maxNsecs;
+	uint64_t nTriggers = theTask.armLatency.nTriggers;
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return nTriggers;
+}
+
+void pulsedThread::resetTriggerLatencyStats (void){
+	pthread_mutex_lock (&theTask.taskMutex);
+	theTask.armLatency = {0,0,0,0};
+	pthread_mutex_unlock( &theTask.taskMutex);
+}
+
+/* ****************************************************************************************************
+Links an edge of this thread to the task of another thread, which is started at the time of the edge plus offsetUsecs. The target must be armed
+for a start to be posted, and takes the post from its trigger flag, so neither thread waits on the other. Edges that come when the target is not
+armed, or has not finished the task of its last post, are counted as missed. The chain is read by the pthread at every edge, so can only be
+changed when the thread is not busy or armed, and the target must outlive the link. Returns 1 if busy or armed, chain is full, or the link
+is not valid, else 0
+Last Modified:
+2026/10/19 - checks the chain is not full with the mutex held
+2026/10/19 - initial version */
+int pulsedThread::chainTo (pulsedThread * target, int edge, unsigned int channel, unsigned int offsetUsecs){
+	if ((target == nullptr) || (target == this) || (edge < kCHAIN_LO) || (edge > kCHAIN_END) || (channel >= kTRACE_MAX_CHANNELS)){
+#if beVerbose
+		printf ("chainTo error: edge = %d, channel = %d.\n", edge, channel);
+#endif
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	if (chainData.nLinks == kCHAIN_MAX_LINKS){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("chainTo error: chain already has %d links.\n", kCHAIN_MAX_LINKS);
+#endif
+		return 1;
+	}
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("chainTo error: chain can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	pulsedThreadChainLinkPtr link = &chainData.links [chainData.nLinks];
+	link->target = target->getTask ();
+	link->edge = edge;
+	link->channel = channel;
+	link->offsetNsecs = (uint64_t) offsetUsecs * 1000;
+	link->nPosted.store (0);
+	link->nMissed.store (0);
+	chainData.nLinks +=1;
+	theTask.chain = &chainData;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+int pulsedThread::unChain (void){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("unChain error: chain can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	theTask.chain = nullptr;
+	chainData.nLinks = 0;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+/* ****************************************************************************************************
+Returns the starts posted by a link, and fills the edges it missed. nLinks is read with the mutex held, as chainTo and unChain change it, and
+the counters, which the pthread bumps at its edges without the mutex, are relaxed atomics
+Last Modified:
+2026/10/19 - reads nLinks with the mutex held, and the counters as relaxed atomics
+2026/10/19 - initial version */
+uint64_t pulsedThread::getChainStats (unsigned int iLink, uint64_t & nMissed){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if (iLink >= chainData.nLinks){
+		pthread_mutex_unlock (&theTask.taskMutex);
+		nMissed = 0;
+		return 0;
+	}
+	nMissed = chainData.links [iLink].nMissed.load (std::memory_order_relaxed);
+	uint64_t nPosted = chainData.links [iLink].nPosted.load (std::memory_order_relaxed);
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return nPosted;
+}
+
+/* ****************************************************************************************************
+Starts or stops running endFuncs on a companion thread, at normal priority, so a slow endFunc, e.g. in Python, never delays an edge. The
+companion gets a copy of the task, and timing changes it makes are taken up by the pthread at the next safe boundary, so with an infinite train,
+an endFunc that sets timing for the next pulse may take effect a pulse or more later than when run on the pthread. endFunc data is used by the
+companion, so custom modifications of endFunc data must not race with the endFunc. Stopping waits for the companion to run the endFuncs still
+queued. Returns 1 if the thread is busy or armed, or the companion thread can not be started, else 0
+Last Modified:
+2026/10/19 - value-initializes the offload struct, so the copy task has no garbage fields, and initializes its mutex and condition variable
+2026/10/19 - initial version */
+int pulsedThread::setEndFuncOffload (int isOffloaded){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("setEndFuncOffload error: offload can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	pulsedThreadOffloadStructPtr offload = theTask.offload;
+	if (isOffloaded){
+		if (offload != nullptr){
+			pthread_mutex_unlock (&theTask.taskMutex);
+			return 0;
+		}
+		// the struct has cache line aligned fields, so allocate it aligned, as for a pulsedThread
+		void * ptr;
+		if (posix_memalign (&ptr, alignof (pulsedThreadOffloadStruct), sizeof (pulsedThreadOffloadStruct)) != 0){
+			pthread_mutex_unlock (&theTask.taskMutex);
+			return 1;
+		}
+		// value-initialized, so the copy task has no garbage in the fields the companion does not fill in
+		offload = new (ptr) pulsedThreadOffloadStruct ();
+		offload->nQueued.store (0);
+		offload->nDropped.store (0);
+		offload->nDone.store (0);
+		offload->killWorker.store (0);
+		offload->theTask = &theTask;
+		offload->copyTask.accLevel = theTask.accLevel;
+		offload->copyTask.loFunc = theTask.loFunc;
+		offload->copyTask.hiFunc = theTask.hiFunc;
+		offload->copyTask.taskData = theTask.taskData;
+		offload->copyTask.patternData = theTask.patternData;
+		offload->copyTask.triggerFd = -1;
+		offload->copyTask.wakeFd = -1;
+		pthread_mutex_init (&offload->copyTask.taskMutex, NULL);
+		pthread_cond_init (&offload->copyTask.taskVar, NULL);
+		sem_init (&offload->queueSem, 0, 0);
+		// companion runs at normal priority, not the real-time priority of the pthread that may be making it
+		pthread_attr_t attr;
+		struct sched_param param;
+		param.sched_priority = 0;
+		pthread_attr_init (&attr);
+		pthread_attr_setinheritsched (&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy (&attr, SCHED_OTHER);
+		pthread_attr_setschedparam (&attr, &param);
+		int result = pthread_create (&offload->worker, &attr, &pulsedThreadOffloadFunc, (void *) offload);
+		pthread_attr_destroy (&attr);
+		if (result != 0){
+			pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+			printf ("setEndFuncOffload error: could not make companion thread.\n");
+#endif
+			sem_destroy (&offload->queueSem);
+			pthread_mutex_destroy (&offload->copyTask.taskMutex);
+			pthread_cond_destroy (&offload->copyTask.taskVar);
+			offload->~pulsedThreadOffloadStruct ();
+			free (offload);
+			return 1;
+		}
+		theTask.offload = offload;
+		pthread_mutex_unlock (&theTask.taskMutex);
+		return 0;
+	}
+	theTask.offload = nullptr;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	// the companion may need the mutex to give back timing, so stop it with the mutex unlocked
+	if (offload != nullptr){
+		pulsedThreadOffloadStop (offload);
+	}
+	return 0;
+}
+
+uint64_t pulsedThread::getEndFuncOffloadStats (uint64_t & nDropped){
+	pulsedThreadOffloadStructPtr offload = theTask.offload;
+	if (offload == nullptr){
+		nDropped = 0;
+		return 0;
+	}
+	nDropped = offload->nDropped.load (std::memory_order_relaxed);
+	return offload->nDone.load (std::memory_order_acquire);
+}
+
+/* ****************************************************************************************************
+Starts or stops CPU cost accounting. Starting zeros the stats, and counts the time until the next task as idle. The CPU time of the pthread
+is only known to it, so CPU time from the start until the pthread first stamps, at the start of a task, is not counted. Returns 1 if the
+thread is busy or armed, else 0
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::setCpuAccounting (int isAccounting){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+		return 1;
+	}
+	if (isAccounting){
+		cpuAccountData.stats = pulsedThreadCpuStats ();
+		cpuAccountData.seq.store (0);
+		cpuAccountData.phase = kCPU_IDLE;
+		cpuAccountData.startNsecs = pulsedThreadNanos ();
+		cpuAccountData.markNsecs = cpuAccountData.startNsecs;
+		cpuAccountData.markCpuNsecs = 0;
+		theTask.cpuAccount = &cpuAccountData;
+	}else{
+		theTask.cpuAccount = nullptr;
+	}
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
 /* ****************************************************************************************************
-// gets the lock on the task and increments doTask to signal the thread to do task it is configured to do nTasks times
-//Last Modified:
-2018/11/05 by Jmie Boyd - added bounds checking
-2018/10/25 by Jamie Boyd - initial version */
-void pulsedThread::DoOrUndoTasks(int nTasks){
-	// for infinite task, this function is a NOP
-	if (theTask.nPulses != kINFINITETRAIN){
-		pthread_mutex_lock (&theTask.taskMutex);
-		// scrunch resulting value of doTask between 0 and kMODDELAY (first of signal bits)
-		unsigned int currentTasks = (theTask.doTask &~kMODANY);
-		if ((int)(currentTasks + nTasks) < 0){
-			theTask.doTask &= 1;
-		}else{
-			if ((int)currentTasks + nTasks >= kMODDELAY){
-				theTask.doTask = kMODDELAY -1;
-			}else{
-				theTask.doTask +=nTasks;
-			}
-		}
-		pthread_cond_signal(&theTask.taskVar);
-		pthread_mutex_unlock( &theTask.taskMutex );
+Sets the timer slack the pthread gives itself, with PR_SET_TIMERSLACK, at the start of its next task, so the kernel can delay its wake-ups
+by up to slackNsecs to merge them with other timers. The kernel gives no slack to real-time threads, so this only has effect for a pthread
+that could not be made SCHED_RR, for real-time threads use setCoalescing. Returns 1 if the thread is busy or armed, else 0
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::setTimerSlack (unsigned long slackNsecs){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+		return 1;
 	}
+	theTask.timerSlackNsecs = slackNsecs;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
 }
+
 /* ****************************************************************************************************
-/returns 0 if a thread is not currently doing a task, else returns number of tasks still left to do
-Last Modified 2015/09/28 by Jamie Boyd -  initial verison */
-int pulsedThread::isBusy(){
+Sets the tolerance for moving wake-ups of waits that only sleep to the shared tick, see pulsedThreadCoalesceTick, so threads with loose
+timing wake together. A tick is only within the tolerance of every deadline if the tick is no more than twice the tolerance. Segments are
+timed from the end of the previous segment while coalescing, so set it before a task starts. Returns 1 if the thread is busy or armed, else 0
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::setCoalescing (unsigned int toleranceUsecs){
 	pthread_mutex_lock (&theTask.taskMutex);
-	int taskNum = theTask.doTask;
-	pthread_mutex_unlock( &theTask.taskMutex);
-	return taskNum;
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+		return 1;
+	}
+	theTask.coalesceUsecs = toleranceUsecs;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
 }
 
-
-/* *****************************************************************************************************
-waits until a thread is no longer doing a task, then returns
-Last modified:
-2018/05/23 by Jamie Boyd - changed timing from simple loop of nSleep to calculating end time and using timercmp
-2016/12/09 by Jamie Boyd - added paramater for timeout, and added return value for timed out vs not busy */
-int pulsedThread::waitOnBusy(float waitSecs){
-	// make timers, one for current time and one for current time + wait seconds
-	struct timeval currentTime;
-	struct timeval endTime;
-	struct timeval waitTime;
-	configureTimer ((waitSecs * 1E06), &waitTime);
-	gettimeofday (&endTime, NULL);
-	timeradd (&endTime, &waitTime, &endTime);
-	// make a timSpec sleeper for sleepTurnaround, typically 200 mSec
-	struct timespec Sleeper;
-	configureSleeper (kSLEEPTURNAROUND, &Sleeper);
-	// check if tasks are done, sleep, check if time is up, repeat
-	int taskNum;
-	do{
-		pthread_mutex_lock (&theTask.taskMutex);
-		taskNum = theTask.doTask;
-		pthread_mutex_unlock( &theTask.taskMutex);
-		if (taskNum ==0){
+/* ****************************************************************************************************
+Copies the stats with the sequence lock, then adds the time since the pthread's last stamp to the phase it is in, so a thread spinning
+while armed, or running a long infinite train, shows its cost now, not at its next stamp. CPU time since the last stamp is read from the
+pthread's CPU clock, when it has one, and has stamped
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::getCpuStats (pulsedThreadCpuStats & stats){
+	pulsedThreadCpuAccountPtr account = theTask.cpuAccount;
+	if (account == nullptr){
+		return 1;
+	}
+	int phase;
+	uint64_t markNsecs;
+	uint64_t markCpuNsecs;
+	for (;;){
+		uint64_t seq = account->seq.load (std::memory_order_acquire);
+		if (seq & 1){
+			pulsedThreadCpuRelax ();
+			continue;
+		}
+		stats = account->stats;
+		phase = account->phase;
+		markNsecs = account->markNsecs;
+		markCpuNsecs = account->markCpuNsecs;
+		std::atomic_thread_fence (std::memory_order_acquire);
+		if (account->seq.load (std::memory_order_relaxed) == seq){
 			break;
 		}
-		nanosleep (&Sleeper, NULL);
-		gettimeofday (&currentTime, NULL);
-	}while (timercmp (&currentTime, &endTime, <));
-	return taskNum;
+	}
+	uint64_t nowNsecs = pulsedThreadNanos ();
+	uint64_t cpuNsecs = 0;
+	pthread_mutex_lock (&theTask.taskMutex);
+	clockid_t cpuClock;
+	struct timespec cpuTime;
+	if ((markCpuNsecs != 0) && (theTask.threadState == kTHREAD_RUNNING) && (pthread_getcpuclockid (theTask.taskThread, &cpuClock) == 0) &&
+	(clock_gettime (cpuClock, &cpuTime) == 0)){
+		uint64_t threadCpuNsecs = (uint64_t)cpuTime.tv_sec * 1000000000ULL + (uint64_t)cpuTime.tv_nsec;
+		cpuNsecs = (threadCpuNsecs > markCpuNsecs) ? threadCpuNsecs - markCpuNsecs : 0;
+	}
+	pthread_mutex_unlock (&theTask.taskMutex);
+	pulsedThreadCpuAdd (stats, phase, (nowNsecs > markNsecs) ? nowNsecs - markNsecs : 0, cpuNsecs);
+	stats.wallNsecs = nowNsecs - account->startNsecs;
+	return 0;
 }
 
-/* ***************************************************************************************************
-gets the lock on the task and sets doTask bit 0 to signal the thread to start train
-Last Modified 2015/09/28 by Jamie Boyd */
-void pulsedThread::startInfiniteTrain (void){
-	if ((theTask.nPulses == kINFINITETRAIN) && (!(theTask.doTask & 1))){
-		pthread_mutex_lock (&theTask.taskMutex);
-		theTask.doTask |= 1;
-		pthread_cond_signal(&theTask.taskVar);
-		pthread_mutex_unlock( &theTask.taskMutex);
-	}else{
+/* ****************************************************************************************************
+Installs a file descriptor for the thread to wait on when it has no tasks left to do, alongside its command channel. An event on the fd
+starts a task, as DoTask does, without another thread having to wait on the fd and call DoTask. Events waiting when the fd is set start a task.
+Events that come while the thread is busy, or together with the event that starts a task, are read and counted as missed, not queued.
+An armed thread spins on its trigger flag and does not watch the fd. The fd stays owned by the caller, and must stay open until it is
+replaced, or set to -1. Returns 1 if the thread is busy or armed, or the mode is not valid, or the wake fd can not be made, else 0
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::setTriggerFd (int fd, int fdMode){
+	if ((fd >= 0) && (fdMode != kTRIGFD_EVENTFD) && (fdMode != kTRIGFD_PIPE) && (fdMode != kTRIGFD_GPIO)){
 #if beVerbose
-		printf ("startInfiniteTrainError: theTask.nPulses = %d, theTask.doTask = %d.\n", theTask.nPulses , theTask.doTask);
+		printf ("setTriggerFd error: mode %d is not one of kTRIGFD_EVENTFD, kTRIGFD_PIPE, or kTRIGFD_GPIO.\n", fdMode);
+#endif
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("setTriggerFd error: trigger fd can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	// the wake fd is made the first time it is needed, and kept until the pulsedThread is destroyed
+	if (theTask.wakeFd < 0){
+		theTask.wakeFd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (theTask.wakeFd < 0){
+			pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+			printf ("setTriggerFd error: could not make wake fd.\n");
 #endif
+			return 1;
+		}
+	}
+	theTask.triggerFd = (fd >= 0) ? fd : -1;
+	theTask.triggerFdMode = fdMode;
+	if (fd >= 0){
+		startThread ();
 	}
+	// a thread waiting on the old fd goes back to top of loop
+	pulsedThreadSignal (&theTask);
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+int pulsedThread::getTriggerFd (void){
+	return theTask.triggerFd;
+}
+
+// latency, in nanoseconds, from an event on the trigger fd to the first hi edge of the most recent triggered task
+uint64_t pulsedThread::getFdTriggerLatency (void){
+	pthread_mutex_lock (&theTask.taskMutex);
+	uint64_t lastNsecs = theTask.fdLatency.lastNsecs;
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return lastNsecs;
+}
+
+/* ****************************************************************************************************
+Returns number of tasks started by the trigger fd since last reset, and fills min and max latency, from event to first hi edge, in nanoseconds,
+and number of events missed. Stats are written by the thread with the mutex held, so a reset never loses counts
+Last Modified:
+2026/10/19 - latency is to the first hi edge, not to the start of the task
+2026/10/19 - initial version */
+uint64_t pulsedThread::getFdTriggerStats (uint64_t & minNsecs, uint64_t & maxNsecs, uint64_t & nMissed){
+	pthread_mutex_lock (&theTask.taskMutex);
+	minNsecs = theTask.fdLatency.minNsecs;
+	maxNsecs = theTask.fdLatency.maxNsecs;
+	nMissed = theTask.fdMissed;
+	uint64_t nTriggers = theTask.fdLatency.nTriggers;
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return nTriggers;
+}
+
+void pulsedThread::resetFdTriggerStats (void){
+	pthread_mutex_lock (&theTask.taskMutex);
+	theTask.fdLatency = {0,0,0,0};
+	theTask.fdMissed = 0;
+	pthread_mutex_unlock( &theTask.taskMutex);
 }
 
 /* ****************************************************************************************************
@@ -549,7 +1304,7 @@ void pulsedThread::stopInfiniteTrain (){
 	if ((theTask.nPulses == kINFINITETRAIN) && (theTask.doTask & 1)){
 		pthread_mutex_lock (&theTask.taskMutex);
 		theTask.doTask =0;
-		pthread_cond_signal(&theTask.taskVar);
+		pulsedThreadSignal (&theTask);
 		pthread_mutex_unlock( &theTask.taskMutex);
 	}
 }
@@ -557,6 +1312,7 @@ void pulsedThread::stopInfiniteTrain (){
 /* ****************************************************************************************************
 Changes the delay of each pulse by modifying data stored in the structure of the task
 Last Modified:
+2026/10/19 - signals the thread with signalMods, which sets no signal bits before a pthread is borrowed
 2016/08/08 by Jamie Boyd
 2016/12/13 by Jamie Boyd - better locking, delay can be 0 (but duration can't be 0) */
 int pulsedThread::modDelay (unsigned int newDelayuSecs){
@@ -567,8 +1323,7 @@ int pulsedThread::modDelay (unsigned int newDelayuSecs){
 	}
 	theTask.pulseDelayUsecs = newDelayuSecs;
 	pthread_mutex_lock (&theTask.taskMutex);
-	theTask.doTask |= kMODDELAY;
-	pthread_cond_signal(&theTask.taskVar);
+	signalMods (kMODDELAY);
 	pthread_mutex_unlock( &theTask.taskMutex);
 	return 0;
 }
@@ -576,6 +1331,7 @@ int pulsedThread::modDelay (unsigned int newDelayuSecs){
 /* ****************************************************************************************************
 Changes the duration of the pulse by modifying data stored in the structure of the task
 Last Modified:
+2026/10/19 - signals the thread with signalMods, which sets no signal bits before a pthread is borrowed
 2016/08/09 by Jamie Boyd
 2016/12/13 by Jamie Boyd - better locking */
 int pulsedThread::modDur (unsigned int newDurUsecs){
@@ -586,8 +1342,7 @@ int pulsedThread::modDur (unsigned int newDurUsecs){
 	}
 	theTask.pulseDurUsecs = newDurUsecs;
 	pthread_mutex_lock (&theTask.taskMutex);
-	theTask.doTask |= kMODDUR;
-	pthread_cond_signal(&theTask.taskVar);
+	signalMods (kMODDUR);
 	pthread_mutex_unlock( &theTask.taskMutex);
 	return 0;
 }
@@ -610,10 +1365,63 @@ int pulsedThread::modTrainLength (unsigned int newPulses){
 	return 0;
 }
 
+/* ****************************************************************************************************
+Changes delay, duration, and number of pulses in one transaction. The new values are checked once, written with the mutex held,
+and the thread is signalled once, so it reconfigures delay and duration together and never runs a period with only one of them changed
+Last Modified:
+2026/10/19 - signals the thread with signalMods, which sets no signal bits before a pthread is borrowed
+2026/10/19 - initial version */
+int pulsedThread::modTiming (unsigned int newDelay, unsigned int newDur, unsigned int newPulses){
+	pthread_mutex_lock (&theTask.taskMutex);
+	int errCode = ticks2Times (newDelay, newDur, newPulses, theTask);
+	if (errCode){
+		pthread_mutex_unlock( &theTask.taskMutex);
+		return errCode;
+	}
+	theTask.pulseDelayUsecs = newDelay;
+	theTask.pulseDurUsecs = newDur;
+	theTask.nPulses = newPulses;
+	signalMods (kMODDELAY | kMODDUR);
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return 0;
+}
+
+/* ****************************************************************************************************
+Changes frequency, duty cycle, and train duration in one transaction, as for modTiming
+Last Modified:
+2026/10/19 - signals the thread with signalMods, which sets no signal bits before a pthread is borrowed
+2026/10/19 - initial version */
+int pulsedThread::modTrainTiming (float newFreq, float newDutyCycle, float newTrainDur){
+	unsigned int newDelay;
+	unsigned int newDur;
+	unsigned int newPulses;
+	int errCode = times2TicksVals (newFreq, newDutyCycle, newTrainDur, newDelay, newDur, newPulses);
+	if (errCode){
+		return errCode;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	// check converted values, e.g., duration rounded to 0, or turning an infinite train that is running into a train
+	errCode = ticks2Times (newDelay, newDur, newPulses, theTask);
+	if (errCode){
+		pthread_mutex_unlock( &theTask.taskMutex);
+		return errCode;
+	}
+	theTask.trainFrequency = newFreq;
+	theTask.trainDutyCycle = newDutyCycle;
+	theTask.trainDuration = newTrainDur;
+	theTask.pulseDelayUsecs = newDelay;
+	theTask.pulseDurUsecs = newDur;
+	theTask.nPulses = newPulses;
+	signalMods (kMODDELAY | kMODDUR);
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return 0;
+}
+
 /* ****************************************************************************************************
 Changes the frequency and number of pulses (but not duty cycle or train time duration) of the train 
 Only Modifies the structure of the task if it is a train and not a pulse, and if modding the frequency won't make it a pulse
 Last Modified:
+2026/10/19 - signals the thread with signalMods, which sets no signal bits before a pthread is borrowed
 2016/09/10 by Jamie Boyd - initial version
 2016/12/12 by Jamie Boyd - edited for clarity, also used & instead of + to set bits
 2016/12/14 by Jamie Boyd - use new times2ticks function */
@@ -625,8 +1433,7 @@ int pulsedThread::modFreq (float newFreq){
 	}
 	theTask.trainFrequency = newFreq;
 	pthread_mutex_lock (&theTask.taskMutex);
-	theTask.doTask |= (kMODDELAY | kMODDUR);
-	pthread_cond_signal(&theTask.taskVar);
+	signalMods (kMODDELAY | kMODDUR);
 	pthread_mutex_unlock( &theTask.taskMutex);
 	return 0;
 }
@@ -646,7 +1453,9 @@ int pulsedThread::modTrainDur (float newDur){
 
 /* ****************************************************************************************************
 Changes the duty cycle of the train by modifying delay and duration but not nPulses or frequency
-Last Modified 2016/12/14 by Jamie Boyd - times vs ticks */
+Last Modified:
+2026/10/19 - signals the thread with signalMods, which sets no signal bits before a pthread is borrowed
+2016/12/14 by Jamie Boyd - times vs ticks */
 int pulsedThread::modDutyCycle (float newDutyCycle){
 	
 	int errVar = times2Ticks (theTask.trainFrequency, newDutyCycle, theTask.trainDuration, theTask);
@@ -655,8 +1464,7 @@ int pulsedThread::modDutyCycle (float newDutyCycle){
 	}
 	theTask.trainDutyCycle = newDutyCycle;
 	pthread_mutex_lock (&theTask.taskMutex);
-	theTask.doTask |= (kMODDELAY | kMODDUR);
-	pthread_cond_signal(&theTask.taskVar);
+	signalMods (kMODDELAY | kMODDUR);
 	pthread_mutex_unlock( &theTask.taskMutex);
 	return 0;
 }
@@ -697,20 +1505,42 @@ void pulsedThread::chooseArrayEndFunc (int endFuncMode){
 }
 
 /* ********************************************************Set Up ******************************************************
-sets up/change the array for pulsedThread using the pulsedThreadsetArrayCallback function.
+sets up/change the array for pulsedThread using a preallocated command slot and the pulsedThreadSetArraySlotCallback function.
+If endFunc data is already an array struct, or an earlier set up request is still waiting to install one, as shown by endFuncDataIsArray,
+the pthread copies new values into it, else we allocate one here for the pthread to install, so the pthread never allocates or frees memory,
+and two set up requests queued before the pthread runs do not each install a struct, leaking the first
 last modified:
+2026/10/19 - tests endFuncDataIsArray, not the endFunc data delete function, to know if endFunc data is an array struct
+2026/10/19 - reuses an array struct still waiting to be installed by an earlier request
+2026/10/19 - uses a preallocated command slot, no allocation or deletion on the pthread
 2018/02/02 by Jamie Boyd - initial version */
 int pulsedThread::setUpEndFuncArray (float * newData, unsigned int nData, int isLocking){
-	// fill an array struct from passed-in data
-	pulsedThreadArrayStructPtr setUpStruct = new pulsedThreadArrayStruct;
-	setUpStruct->arrayData = newData;
-	setUpStruct->endPos = nData;
-	setUpStruct->startPos =0;
-	setUpStruct->arrayPos =0;
-	int errVar = modCustom (&pulsedThreadSetUpArrayCallback, (void *) setUpStruct, isLocking);
+	pulsedThreadModSlotPtr slot = claimModSlot ();
+	if (slot == nullptr){
+		return 1;
+	}
+	// fill the slot from passed-in data
+	slot->modBits = 15;
+	slot->arrayVals.arrayData = newData;
+	slot->arrayVals.endPos = nData;
+	slot->arrayVals.startPos =0;
+	slot->arrayVals.arrayPos =0;
+	if (endFuncDataIsArray){
+		slot->newArrayStruct = nullptr;
+	}else{
+		slot->newArrayStruct = new pulsedThreadArrayStruct;
+	}
+	int errVar = modCustom (&pulsedThreadSetArraySlotCallback, (void *) slot, isLocking);
 	if (errVar ==0){
 		// set up the custom delete function specific to the array callback
 		setEndFuncDataDelFunc (&pulsedThreadArrayStructCustomDel);
+		endFuncDataIsArray = true;
+	}else{
+		// modification queue was full, so give the slot back
+		if (slot->newArrayStruct != nullptr){
+			delete (slot->newArrayStruct);
+		}
+		slot->inUse.store (0, std::memory_order_release);
 	}
 	return errVar;	
 }
@@ -719,15 +1549,23 @@ int pulsedThread::setUpEndFuncArray (float * newData, unsigned int nData, int is
 /* *************************************** Set Array Position ************************************
 Changes the position the endFunc is currently outputting. Will start iterating from here
 Last Modified:
+2026/10/19 - uses a preallocated command slot instead of new
 2018/02/21 by Jamie boyd - initial version */
 int  pulsedThread::setEndFuncArrayPos (unsigned int arrayPosP, int isLocking){
 	// sanity check that endFunc is one of the array endFunctions
 	if ((theTask.endFunc == &pulsedThreadFreqFromArrayEndFunc) || (theTask.endFunc == &pulsedThreadDutyCycleFromArrayEndFunc)){
-		// make an array mod struct
-		pulsedThreadArrayModStructPtr modStruct = new pulsedThreadArrayModStruct;
-		modStruct ->modBits = 4;
-		modStruct->arrayPos =arrayPosP;
-		return modCustom (&pulsedThreadSetArrayLimitsCallback, (void *) modStruct, isLocking);
+		pulsedThreadModSlotPtr slot = claimModSlot ();
+		if (slot == nullptr){
+			return 1;
+		}
+		slot->modBits = 4;
+		slot->arrayVals.arrayPos =arrayPosP;
+		slot->newArrayStruct = nullptr;
+		int errVar = modCustom (&pulsedThreadSetArraySlotCallback, (void *) slot, isLocking);
+		if (errVar){ // modification queue was full, so give the slot back
+			slot->inUse.store (0, std::memory_order_release);
+		}
+		return errVar;
 	}else{
 		return 1;
 	}
@@ -737,22 +1575,48 @@ int  pulsedThread::setEndFuncArrayPos (unsigned int arrayPosP, int isLocking){
 /* *************************************** Set Array Limits ************************************
 Changes the start and enposition through which the endFunc will  iterate
 Last Modified:
+2026/10/19 - uses a preallocated command slot instead of new
 2018/02/21 by Jamie boyd - initial version */
 int  pulsedThread::setEndFuncArrayLimits (unsigned int startPosP, unsigned int endPosP, int isLocking){
 	// sanity check that endFunc is one of the array endFunctions
 	if ((theTask.endFunc == &pulsedThreadFreqFromArrayEndFunc) || (theTask.endFunc == &pulsedThreadDutyCycleFromArrayEndFunc)){
-		// make an array mod struct
-		pulsedThreadArrayModStructPtr modStruct = new pulsedThreadArrayModStruct;
-		modStruct ->modBits = 3;
-		modStruct-> startPos = startPosP;
-		modStruct -> endPos = endPosP;
-		return modCustom (&pulsedThreadSetArrayLimitsCallback, (void *) modStruct, isLocking);
+		pulsedThreadModSlotPtr slot = claimModSlot ();
+		if (slot == nullptr){
+			return 1;
+		}
+		slot->modBits = 3;
+		slot->arrayVals.startPos = startPosP;
+		slot->arrayVals.endPos = endPosP;
+		slot->newArrayStruct = nullptr;
+		int errVar = modCustom (&pulsedThreadSetArraySlotCallback, (void *) slot, isLocking);
+		if (errVar){ // modification queue was full, so give the slot back
+			slot->inUse.store (0, std::memory_order_release);
+		}
+		return errVar;
 	}else{
 		return 1;
 	}
 	return 0;
 }
 
+/* *************************************** Claim a Command Slot ************************************
+Returns the first free command slot, marked as in use, or nullptr if every slot is still waiting for the pthread.
+Slots are given back by pulsedThreadSetArraySlotCallback on the pthread, so claim with compare and exchange
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadModSlotPtr pulsedThread::claimModSlot (void){
+	for (int iSlot =0; iSlot < kMOD_SLOTS; iSlot +=1){
+		int isFree = 0;
+		if (modSlots [iSlot].inUse.compare_exchange_strong (isFree, 1, std::memory_order_acquire)){
+			return &modSlots [iSlot];
+		}
+	}
+#if beVerbose
+	printf ("claimModSlot error: all %d command slots are waiting on the pthread.\n", kMOD_SLOTS);
+#endif
+	return nullptr;
+}
+
 
 /* ***********************************************************************
 removes the function that runs at end of each pulse, or train of pulses
@@ -796,24 +1660,47 @@ int pulsedThread::cosineDutyCycleArray  (float * arrayData, unsigned int arraySi
 /* ****************************************************************************************************
 Changes taskData with supplied callback function and pointer to data
 Last Modified:
+2026/10/19 - locking version queues the request, so a second call before the thread wakes no longer overwrites the first
 2016/12/12 by Jamie Boyd - added option for locking vs non-locking version 
 2016/12/07 by Jamie Boyd - first version */
 int pulsedThread::modCustom (int (*modFunc)(void *, taskParams * ), void * modData, int isLocking){	
-	// if locking, we install callback function and data in the task, and request it to be run
+	// if locking, we queue callback function and data for the thread to run
 	if (isLocking){
-		pthread_mutex_lock (&theTask.taskMutex);
-		theTask.modCustomFunc = modFunc;
-		theTask.modCustomData = modData;
-		theTask.doTask |= kMODCUSTOM;
-		pthread_cond_signal(&theTask.taskVar);
-		pthread_mutex_unlock( &theTask.taskMutex);
-		return 0; // return value from inside thread has nowhere to go
+		unsigned int requestNum;
+		return queueModCustom (modFunc, modData, requestNum); // return value from inside thread can be had from getModCustomStatus
 	}else{
 	// if not locking, we run the call back function directly 
 		return modFunc (modData, &theTask);
 	}
 }
 
+/* ****************************************************************************************************
+Adds a custom modification to the queue and signals the thread, which runs all queued modifications in order at its next
+safe point. requestNum is set to the number of the request, for use with getModCustomStatus. Returns 1 if the queue is full
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::queueModCustom (int (*modFunc)(void *, taskParams *), void * modData, unsigned int & requestNum){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if (theTask.modQueued - theTask.modDone >= kMOD_QUEUE_SIZE){
+		pthread_mutex_unlock( &theTask.taskMutex);
+#if beVerbose
+		printf ("queueModCustom error: %d custom modifications are already waiting for the pthread.\n", kMOD_QUEUE_SIZE);
+#endif
+		return 1;
+	}
+	theTask.modQueued +=1;
+	pulsedThreadModRequestPtr request = &theTask.modQueue [theTask.modQueued % kMOD_QUEUE_SIZE];
+	request->modFunc = modFunc;
+	request->modData = modData;
+	request->result = 0;
+	requestNum = theTask.modQueued;
+	theTask.doTask |= kMODCUSTOM;
+	startThread ();
+	pulsedThreadSignal (&theTask);
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return 0;
+}
+
 /* ****************** Mutex access if you want to change taskData directly ******************************
 you need to have kept a pointer to the taskData, or endFunc data, if you want to do this
 
@@ -846,6 +1733,30 @@ int pulsedThread::getModCustomStatus (void){
 	}
 }
 
+/* *******************************************************************************************************
+Returns 1 if the custom modification numbered requestNum, from queueModCustom, is still waiting for the pthread. Returns 0 if it has
+been run, with result set to the value returned by its modFunc, or -1 if it has been run but so many requests have been queued since
+that its result has been overwritten. Slots start zeroed, so requestNum 0, which is never queued, gives a result of 0
+Last Modified:
+2026/10/19 - queue slots are zeroed by the constructors, so no result is read uninitialized
+2026/10/19 - initial version */
+int pulsedThread::getModCustomStatus (unsigned int requestNum, int & result){
+	int status;
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((int)(requestNum - theTask.modDone) > 0){
+		status = 1;
+	}else{
+		if (theTask.modQueued - requestNum < kMOD_QUEUE_SIZE){
+			result = theTask.modQueue [requestNum % kMOD_QUEUE_SIZE].result;
+			status = 0;
+		}else{
+			status = -1;
+		}
+	}
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return status;
+}
+
 /* sets pointer to a function to delete customData when pulsedThread is killed */
 void pulsedThread::setTaskDataDelFunc  (void (*delFunc)( void *)){
 	delTaskDataFunc = delFunc;
@@ -895,43 +1806,159 @@ float pulsedThread::getTrainDutyCycle (void){
 	return theTask.trainDutyCycle;
 }
 
+/* ****************************************************************************************************
+Fills the choices an ACC_MODE_AUTO thread makes for its delay and duration, from the current timing. The thread makes the same choices when it
+configures its segments, at start and after modDelay, modDur, modFreq, etc., so these are the choices it makes once it has done any waiting mods
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::getAutoChoice (int & delayChoice, int & durChoice){
+	if (theTask.accLevel != ACC_MODE_AUTO){
+		return 1;
+	}
+	unsigned int latencyUsecs = pulsedThreadHostLatency ();
+	pthread_mutex_lock (&theTask.taskMutex);
+	delayChoice = pulsedThreadAutoChoice (theTask.pulseDelayUsecs, latencyUsecs);
+	durChoice = pulsedThreadAutoChoice (theTask.pulseDurUsecs, latencyUsecs);
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
 /* sets pointer to a function to delete customData when pulsedThread is killed */
 void pulsedThread::setEndFuncDataDelFunc  (void (*delFunc)( void *)){
 	delEndFuncDataFunc = delFunc;
 }
 
+/* ****************************************************************************************************
+Installs a clock for timing the task, e.g. a pulsedThreadVirtualClock for testing, or nullptr to go back to gettimeofday and nanosleep.
+The thread reads the clock at every wait, so it can only be changed when the thread is not busy or armed. The clock must
+outlive the pulsedThread, or be replaced with nullptr first. Returns 1 if the thread is busy or armed, else 0
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::setClock (pulsedThreadClockPtr clock){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("setClock error: clock can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	theTask.clock = clock;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+pulsedThreadClockPtr pulsedThread::getClock (void){
+	return theTask.clock;
+}
+
+/* ****************************************************************************************************
+Installs a trace for the thread to record its task starts and edges into, or nullptr to stop recording. The thread writes to the trace
+at every edge, so it can only be changed when the thread is not busy or armed. Returns 1 if the thread is busy or armed, else 0
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThread::captureTrace (pulsedThreadTrace * trace){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("captureTrace error: trace can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	theTask.trace = trace;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
 
 
 /* ****************************************************************************************************
-Destructor waits for task to be free, then cancels it
+Stops the thread: waits for task to be free, then waits for the thread function to return, giving its pthread back to the pool. Called by the
+destructor, and first by destructors of subclasses whose pattern function uses memory they free. Does nothing if called again, or if the
+constructor failed before the mutex was initialized, as such a thread was never started
 Last Modified:
+2026/10/19 - does nothing if the mutex was never initialized
+2026/10/19 - moved from destructor to its own method, so subclasses can stop the thread before freeing pattern data
+2026/10/19 - wakes a thread waiting on its trigger fd
+2026/10/19 - joins the thread function instead of cancelling the pthread
+2026/10/19 - removes thread from spin coordinator
+2026/10/19 - disarms an armed thread before cancelling it
 2018/05/26 by Jamie Boyd - waits for current pulse or train to finish
 2018/02/01 by Jamie Boyd - moved wait on busy so it only runs when needed. Also, nw aborts a train in progress after pulses is finished, or 100 seconds
-2017/11/29 by jamie Boyd - added call to function pointer, delCustomDataFunc, for deletion of customData
-2016/01/16 by Jamie Boyd - removed delete customData and modCustomData, as this should be deleted by maker of pulsed thread
 2015/09/29 by Jamie Boyd - initial version */
-pulsedThread::~pulsedThread(){
+void pulsedThread::stopThread (void){
+	if (!taskMutexIsInit){
+		return;
+	}
+	// a spinning thread does not look at killThread, so disarm it first
+	if (theTask.armMode != kARM_OFF){
+		disarm ();
+	}
+	// a registered thread's spin coordinator entry must not outlive it
+	if (theTask.spinEntry != nullptr){
+		pulsedThreadSpinCoordinator::removeThread (this);
+	}
 	// stop the task
 	if (theTask.nPulses == kINFINITETRAIN){
 		if (theTask.doTask & 1){
 			pthread_mutex_lock (&theTask.taskMutex);
 			theTask.doTask =0;
-			pthread_cond_signal(&theTask.taskVar);
+			pulsedThreadSignal (&theTask);
 			pthread_mutex_unlock( &theTask.taskMutex);
 		}	
 	}else{
 		if (theTask.doTask > 1) { // no need to do anything unless 1 or more tasks still left to do
 			pthread_mutex_lock (&theTask.taskMutex);
 			theTask.doTask =1;
-			pthread_cond_signal(&theTask.taskVar);
+			pulsedThreadSignal (&theTask);
 			pthread_mutex_unlock( &theTask.taskMutex);
 		}
 	}
 	pthread_mutex_lock (&theTask.taskMutex);
-	pthread_cancel(theTask.taskThread);
+	if (theTask.threadState == kTHREAD_RUNNING){
+		theTask.killThread = 1;
+		pthread_cond_broadcast (&theTask.taskVar);
+		pulsedThreadWakeFd (&theTask);
+		while (theTask.threadState != kTHREAD_DONE){
+			pthread_cond_wait (&theTask.taskVar, &theTask.taskMutex);
+		}
+	}
 	pthread_mutex_unlock (&theTask.taskMutex);
-	pthread_mutex_destroy (&theTask.taskMutex);
-	pthread_cond_destroy (&theTask.taskVar);
+}
+
+/* ****************************************************************************************************
+Destructor stops the thread, then frees what the thread used. Safe for a pulsedThread whose constructor failed, as initTask set every field
+it looks at, and the mutex and condition variable are only destroyed if they were initialized
+Last Modified:
+2026/10/19 - skips destroying the mutex and condition variable if the constructor failed before initializing them
+2026/10/19 - stops the thread with stopThread
+2026/10/19 - stops the companion thread for offloaded endFuncs
+2026/10/19 - closes the wake fd
+2026/10/19 - deletes array structs from command slots that were never run
+2017/11/29 by jamie Boyd - added call to function pointer, delCustomDataFunc, for deletion of customData
+2016/01/16 by Jamie Boyd - removed delete customData and modCustomData, as this should be deleted by maker of pulsed thread
+2015/09/29 by Jamie Boyd - initial version */
+pulsedThread::~pulsedThread(){
+	stopThread ();
+	// companion thread runs what is left in its queue, then returns
+	if (theTask.offload != nullptr){
+		pulsedThreadOffloadStop (theTask.offload);
+		theTask.offload = nullptr;
+	}
+	if (taskMutexIsInit){
+		pthread_mutex_destroy (&theTask.taskMutex);
+		pthread_cond_destroy (&theTask.taskVar);
+	}
+	if (theTask.wakeFd >= 0){
+		close (theTask.wakeFd);
+	}
+	// array structs allocated for set up requests the pthread never got to
+	for (int iSlot =0; iSlot < kMOD_SLOTS; iSlot +=1){
+		if ((modSlots [iSlot].inUse.load () == 1) && (modSlots [iSlot].newArrayStruct != nullptr) && (modSlots [iSlot].newArrayStruct != theTask.endFuncData)){
+			delete (modSlots [iSlot].newArrayStruct);
+		}
+	}
 	// delete task custom data?
 	if (delTaskDataFunc != nullptr){
 		delTaskDataFunc (theTask.taskData);
@@ -1005,6 +2032,43 @@ int pulsedThreadSetArrayLimitsCallback (void * modData, taskParams * theTask){
 	return 0;
 } 
 
+/* ***************** Array set up and modification Callback using a preallocated command slot ***************************
+Installs a new array struct if the slot carries one, then copies over the values selected by modBits, scrunching current position to the
+array limits, and gives the slot back. Does no allocation or deletion, so is safe to run on the pthread.
+Last modified:
+2026/10/19 - clears newArrayStruct once installed, so a free slot never shows a pending struct
+2026/10/19 - initial version */
+int pulsedThreadSetArraySlotCallback (void * modData, taskParams * theTask){
+	pulsedThreadModSlotPtr slot = (pulsedThreadModSlotPtr)modData;
+	if (slot->newArrayStruct != nullptr){
+		theTask->endFuncData = slot->newArrayStruct;
+		slot->newArrayStruct = nullptr;
+	}
+	pulsedThreadArrayStructPtr endFuncDataPtr = (pulsedThreadArrayStructPtr)theTask->endFuncData;
+	if (endFuncDataPtr == nullptr){ // the set up request that would have installed the array struct was overwritten
+		slot->inUse.store (0, std::memory_order_release);
+		return 1;
+	}
+	if ((slot->modBits) & 8){
+		endFuncDataPtr -> arrayData = slot->arrayVals.arrayData; // just pointer to the data. So calling function must not delete arrayData while the thread is active
+	}
+	if ((slot->modBits) & 1){
+		endFuncDataPtr -> startPos = slot->arrayVals.startPos;
+	}
+	if ((slot->modBits) & 2){
+		endFuncDataPtr -> endPos = slot->arrayVals.endPos;
+	}
+	if ((slot->modBits) & 4){
+		endFuncDataPtr -> arrayPos = slot->arrayVals.arrayPos;
+	}
+	if ((endFuncDataPtr -> arrayPos < endFuncDataPtr -> startPos) || (endFuncDataPtr -> arrayPos > endFuncDataPtr -> endPos)){
+		endFuncDataPtr -> arrayPos = endFuncDataPtr -> startPos;
+	}
+	// give the slot back
+	slot->inUse.store (0, std::memory_order_release);
+	return 0;
+}
+
 /* ************************ EndFunc sets Train Frequency from Array in endFunc data ***************************************
 last Modified:
 2018/02/05 by Jamie Boyd - updated for separate pointer for endFunc Data */
@@ -7,6 +7,12 @@
 #include <stdlib.h>
 #include <cstddef>
 #include <cstdint>
+#include <new>
+#include <atomic>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <semaphore.h>
 
 /* *********************Class to make and signal a task that does one of:************************************************
 	1) a single timed  pulse, recallable, for solenoids, e.g.
@@ -35,6 +41,23 @@ const int ACC_MODE_SLEEPS = 0;				// thread sleeps for duration of period
 const int ACC_MODE_SLEEPS_AND_SPINS =1;		//thread sleeps for period - kSLEEPTURNAROUND microseconds, then spins for remaining time
 const int ACC_MODE_SLEEPS_AND_OR_SPINS =2;	//sleep time is re-calculated for each duration, sleep is countermanded if thread is running late
 const int kSLEEPTURNAROUND= 200;			//how long, in microseconds, we aim to spin for the end of pulse timing in accuracy levels 1 and 2
+const int ACC_MODE_AUTO =3;					//each delay and duration sleeps, sleeps and spins, or spins, as chosen from its length and the wake-up latency of the host
+
+/* ***************************************** choices made for a segment at ACC_MODE_AUTO *******************************************************
+A segment only sleeps if the host's wake-up latency is no more than 1/kAUTO_SLEEP_RATIO of it, else it sleeps until the turnaround time, the larger of
+kSLEEPTURNAROUND and twice the latency, before its end and spins the rest, or spins for all of it if it is no longer than the turnaround time.
+Segments are timed from the end of the previous segment, as for ACC_MODE_SLEEPS_AND_OR_SPINS, so lateness from sleeping does not add up */
+const int kAUTO_SLEEPS = 0;
+const int kAUTO_SLEEPS_AND_SPINS = 1;
+const int kAUTO_SPINS = 2;
+const unsigned int kAUTO_SLEEP_RATIO = 100;
+
+/* ***************************************** wake-up coalescing *************************************************************************
+A thread with a coalescing tolerance wakes from each wait that only sleeps, at ACC_MODE_SLEEPS, or a segment that sleeps at ACC_MODE_AUTO, on
+the nearest tick of a CLOCK_MONOTONIC grid shared by all threads of the process, if the tick is within the tolerance of the deadline, so slow
+threads on a rig wake together instead of each on its own. Segments are timed from the end of the previous segment, not from the wake-up, so
+moving a wake-up does not add up over a train. Waits that spin are never moved */
+const unsigned int kCOALESCE_TICK_USECS = 1000;	// default tick of the shared grid
 
 /* ***********************************constants for different task modes ************************************************************************/
 const int kPULSE= 1; // waits for delay, calls hiFunc, waits for duration, calls low func
@@ -55,20 +78,154 @@ const unsigned int kMODANY = 3758096384;		//2^29 + 2^30 + 2^31
 const int kFREQUENCY =0;
 const int kDUTY_CYCLE =1;
 
+/* ****************************************** constants for armed trigger mode ***************************************************************
+When armed, a thread with no tasks left to do does not wait on the condition variable, it spins on a trigger flag, so DoTask starts the
+task without the wake-up latency of pthread_cond_signal. Spinning keeps a processor core busy for as long as the thread is armed */
+const int kARM_OFF = 0;			// not armed, thread waits on condition variable for a task to be requested
+const int kARM_SPIN = 1;			// armed, thread spins on trigger flag as tightly as it can
+const int kARM_SPIN_PAUSE = 2;	// armed, thread spins with a processor pause/yield hint in the loop, easier on a hyperthreaded sibling core
+const int kARM_SPIN_YIELD = 3;	// armed, thread spins with sched_yield in the loop, giving up the processor to other threads of equal priority
+const int kCACHE_LINE_SIZE = 64;	// bytes in a cache line, used to keep fields written by different threads on separate cache lines
+
+/* ****************************************** constants for trigger fd ********************************************************************
+A thread with a trigger fd installed, and no tasks left to do, waits on the fd alongside its command channel, and starts a task, as DoTask does,
+when an event arrives, so no other thread has to wait on the fd and call DoTask. The mode says how to count the events read from the fd */
+const int kTRIGFD_EVENTFD = 0;	// an eventfd, a write of n is n events
+const int kTRIGFD_PIPE = 1;		// a pipe or socket, each byte is an event
+const int kTRIGFD_GPIO = 2;		// a GPIO character device line request with edge detection, each gpio_v2_line_event is an event, timed by the kernel
+const unsigned int kTRIGFD_MAX_EVENTS = 16;	// most events read from the fd at once
+
+/* ****************************************** constants for state of the pthread that runs a task ***************************************
+The pthread is borrowed from pulsedThreadPool the first time the task needs it, and given back when the pulsedThread is destroyed */
+const int kTHREAD_NONE = 0;		// no pthread yet, timing changes are saved up until a pthread is borrowed
+const int kTHREAD_RUNNING = 1;	// a pool pthread is running the thread function for the task
+const int kTHREAD_DONE = 2;		// the thread function has returned and the pthread has gone back to the pool
+
+/* **************** Trigger flag for armed mode, aligned so nothing else shares a cache line with the flag *****************************
+triggerNsecs is 0 when nothing has happened, or CLOCK_MONOTONIC time of the trigger in nanoseconds. wake is set to send the thread back to top of
+loop without starting a task, e.g., to pick up a new spin mode, so it has a flag of its own, not a value of triggerNsecs */
+typedef struct alignas(kCACHE_LINE_SIZE) pulsedThreadArmStruct{
+	std::atomic<uint64_t> triggerNsecs;
+	std::atomic<int> wake;
+	std::atomic<uint64_t> chainNsecs; // start time posted by a chained thread, 0 when free, kept until the chained task is done
+}pulsedThreadArmStruct, *pulsedThreadArmStructPtr;
+
+/* ***************** Trigger to first edge latency, in nanoseconds, written by the pthread with the mutex held ****************************/
+typedef struct pulsedThreadLatencyStruct{
+	uint64_t lastNsecs;	// latency of the most recent triggered task
+	uint64_t minNsecs;		// smallest latency seen since last reset
+	uint64_t maxNsecs;		// largest latency seen since last reset
+	uint64_t nTriggers;	// number of triggered tasks since last reset
+}pulsedThreadLatencyStruct, *pulsedThreadLatencyStructPtr;
+
+/* ************** entry for a thread registered with the spin coordinator, see pulsedThreadSpinCoordinator.h **********************
+Threads at accLevel 1 or 2 that are registered publish each spin window to their entry, and count windows that overlap the windows of other
+threads pinned to the same core */
+struct pulsedThreadSpinEntry;
+void pulsedThreadSpinPublish (pulsedThreadSpinEntry * entry, const struct timeval * spinEndTime, unsigned int spinUsecs);
+
+/* ************************************* pattern tasks *******************************************************************************
+A pattern function, if installed, runs a task in place of the pulse/train/infinite train code of the thread function, for tasks that
+are not a simple pulse or train, e.g., several channels with a shared time base. It gets the timers, to wait with the helpers below */
+struct taskParams;
+struct pulsedThreadTimers;
+typedef void (*pulsedThreadPatternFunc)(taskParams * theTask, struct pulsedThreadTimers * timers);
+
+/* ******************* edge trace, records the time of each edge the thread makes, see pulsedThreadTrace.h *************************
+A thread with a trace installed records task starts and the hi and lo edges of each channel, with the time from its clock */
+const int kTRACE_LO = 0;		// a channel went low, loFunc was called, or a channel was cleared
+const int kTRACE_HI = 1;		// a channel went high, hiFunc was called, or a channel was set
+const int kTRACE_START = 2;	// a task was started, channel is 0
+const unsigned int kTRACE_MAX_CHANNELS = 64;	// channel numbers are kept in 6 bits
+class pulsedThreadTrace;
+void pulsedThreadTraceRecord (pulsedThreadTrace * trace, taskParams * theTask, unsigned int channel, int kind);
+
+/* ************************** chaining, an edge of one thread starts the task of another, armed, thread *******************************
+On a chosen edge, the thread posts a start time, the time of the edge plus an offset, to the armed trigger of each linked thread, with a
+single compare and swap, so the handoff takes no lock and never waits. The linked thread, spinning on its trigger, takes the post, waits
+until the start time, and starts its task, so the lag between the edges is fixed by the offset, not by when the linked thread woke */
+const int kCHAIN_LO = kTRACE_LO;		// a channel went low
+const int kCHAIN_HI = kTRACE_HI;		// a channel went high
+const int kCHAIN_START = kTRACE_START;	// a task was started
+const int kCHAIN_END = 3;				// a task ended, after its endFunc
+const unsigned int kCHAIN_MAX_LINKS = 4;	// most threads one thread can start
+
+typedef struct pulsedThreadChainLink{
+	taskParams * target;		// task of the thread to start
+	int edge;					// kCHAIN_LO, kCHAIN_HI, kCHAIN_START, or kCHAIN_END
+	unsigned int channel;		// channel of the edge, 0 for single channel threads
+	uint64_t offsetNsecs;		// from edge to start of target task
+	std::atomic<uint64_t> nPosted;	// starts posted to the target, written only by the pthread, read by getChainStats
+	std::atomic<uint64_t> nMissed;	// edges when the target was not armed, or had not taken the last post
+}pulsedThreadChainLink, *pulsedThreadChainLinkPtr;
+
+typedef struct pulsedThreadChainStruct{
+	unsigned int nLinks;
+	pulsedThreadChainLink links [kCHAIN_MAX_LINKS];
+}pulsedThreadChainStruct, *pulsedThreadChainStructPtr;
+
+/* ****************************** endFunc offload, see pulsedThreadOffloadStruct below **********************************************/
+struct pulsedThreadOffloadStruct;
+
+/* ****************************** CPU cost accounting, see pulsedThreadCpuAccount below **********************************************/
+struct pulsedThreadCpuAccount;
+
+/* ******************************************* clock the thread times its waits with ***********************************************
+By default (no clock installed) the thread uses gettimeofday and nanosleep. An installed clock replaces both, e.g., a virtual clock that
+advances simulated time to each deadline instead of waiting for it, see pulsedThreadClock.h. getTime fills in the current time, and 
+waitUntil returns when the clock reaches the deadline, or when the task is being killed */
+typedef struct pulsedThreadClock{
+	void (*getTime)(void * clockData, struct timeval * currentTime);
+	void (*waitUntil)(void * clockData, taskParams * theTask, const struct timeval * deadline);
+	void * clockData; // passed to both functions
+}pulsedThreadClock, *pulsedThreadClockPtr;
+
+/* ******************** a custom modification waiting in the queue for the pthread to run it ***********************************
+Requests are numbered in the order they are queued, starting from 1. The request numbered n is kept in modQueue [n % kMOD_QUEUE_SIZE],
+where its result stays until the slot is reused by request n + kMOD_QUEUE_SIZE */
+const unsigned int kMOD_QUEUE_SIZE = 16; // number of custom modifications that can be waiting for the pthread
+
+typedef struct pulsedThreadModRequest{
+	int (*modFunc)(void *, taskParams *); // function to run on the pthread
+	void * modData; // data to pass to the function
+	int result; // value returned by modFunc, once it has been run
+}pulsedThreadModRequest, *pulsedThreadModRequestPtr;
+
 /* ***************this C-style struct contains all the relevant thread variables and task variables, and is passed to the thread function *********
+Fields are grouped into cache-line aligned sections by who reads and writes them, so controlling threads calling isBusy, DoTask, etc. do not
+keep stealing the cache line holding the timing and function pointers the pthread reads at every edge.
+	hot - read by the pthread for every pulse, written by other threads only when timing or functions are changed, including the clock, trace,
+	chain, offload, and CPU accounting pointers the pthread reads at every edge or wait, which are only changed when the thread is idle
+	control - doTask, arm mode, trigger fd, and custom modification counts, written by other threads under the mutex, polled by the pthread every
+	period for infinite trains
+	armed trigger - the flag an armed thread spins on, in a cache line of its own
+	cold - frequency-based timing description, stats, custom modification requests, and pthread variables, not touched in the timing loop
 last modified:
+2026/10/19 - moved clock, trace, chain, offload, and CPU accounting pointers from the control section to the hot section
+2026/10/19 - moved the custom modification requests from the control section to the cold section
+2026/10/19 - added first edge stamp for trigger latency
+2026/10/19 - added coalescing tolerance and timer slack
+2026/10/19 - added CPU cost accounting
+2026/10/19 - added endFunc offload
+2026/10/19 - added chain
+2026/10/19 - added trigger fd
+2026/10/19 - added edge trace
+2026/10/19 - added clock
+2026/10/19 - added pattern function and data
+2026/10/19 - added killThread and threadState for borrowing pthreads from pulsedThreadPool
+2026/10/19 - added entry for spin coordinator
+2026/10/19 - replaced single modCustomFunc/modCustomData with a queue of pending modifications
+2026/10/19 - grouped fields into hot, control, and cold cache lines
+2026/10/19 - added armed trigger mode fields
 2018/02/05 by Jamie Boyd - added separate pointer for endFunc data as separate from taskData */
 struct taskParams {
-	int accLevel; // sleeps, sleeps and spins, sleeps and/or spins.
-	unsigned int doTask; // incremented when tasks are requested, decremented when tasks are done
+	/* ********************************************** hot section ******************************************************************/
+	alignas(kCACHE_LINE_SIZE) int accLevel; // sleeps, sleeps and spins, sleeps and/or spins.
 	/* ****************************raw pulse durations and number of pulses, in microseconds *******************************************/
 	unsigned int pulseDelayUsecs; // duration of low time in microseconds, can be 0, in which case loFunc is never called for a train or infinite train
 	unsigned int pulseDurUsecs; // duration of high time in microseconds, must be > 0
 	unsigned int nPulses; // number of pulses in a train, 0 for infinite train, 1 for a single pulse
-	/* *********** train durations, train fequencies, and train duty cycles. Same information as above ************************************/
-	float trainDuration; // duration of train, in seconds, or 0 for infinite train
-	float trainFrequency; // frequency in Hz, i.e., pulses/second
-	float trainDutyCycle; // pulseDurUsecs/(pulseDurUsecs + pulseDelayUsecs)
+	unsigned int coalesceUsecs; // tolerance for moving wake-ups to the shared tick, 0 for no coalescing. Only changed when thread is not busy
 	/* *****************************Hi and Lo functions, and pointer to their custom data, ********************************/
 	void (*loFunc)(void *); // function to run for low part of pulse, gets pointer to taskData
 	void (*hiFunc)(void *); // function to run for high part of pulse, gets pointer to taskData
@@ -76,15 +233,119 @@ struct taskParams {
 	/* *************************** EndFunction and pointer to its custom data *******************************************/
 	void (*endFunc)(void *, taskParams *); // runs at end of train, or end of each pulse for infinite train or single pulse, gets pointers to endFunc Data, and the whole task
 	void * endFuncData; // pointer for custom data for end functions
-	/* *************** function to mod custom data and pointer to data to use with mod function ***********************/
-	int (*modCustomFunc)(void *, taskParams *); // runs when kMODCUSTOM is set in doTask
-	void * modCustomData; // needs to be initialized before use with modCustomFunc
+	pulsedThreadSpinEntry * spinEntry; // entry with spin coordinator, or nullptr if not registered
+	/* ************ hooks read at every edge or wait, only changed when thread is not busy *************************************************/
+	pulsedThreadClockPtr clock; // clock for timing waits, or nullptr for gettimeofday and nanosleep
+	pulsedThreadTrace * trace; // trace recording edges, or nullptr
+	pulsedThreadChainStructPtr chain; // threads to start on edges of this thread, or nullptr
+	pulsedThreadOffloadStruct * offload; // companion thread that runs endFuncs, or nullptr to run them on the pthread
+	pulsedThreadCpuAccount * cpuAccount; // CPU cost accounting, or nullptr if not accounting
+	/* ************ first edge of a triggered task, for latency stats, written only by the pthread *****************************************/
+	bool stampFirstEdge; // set at the start of a triggered task, cleared when the first hi edge is stamped
+	uint64_t firstEdgeNsecs; // CLOCK_MONOTONIC time of the first hi edge of a triggered task, 0 if it made no hi edge
+	/* ********************************************** control section ****************************************************************/
+	alignas(kCACHE_LINE_SIZE) unsigned int doTask; // incremented when tasks are requested, decremented when tasks are done
+	int armMode; // kARM_OFF, or one of the spin modes, kARM_SPIN, kARM_SPIN_PAUSE, kARM_SPIN_YIELD
+	int killThread; // set by destructor, thread function returns when it has no task left to do, and trains stop after current pulse
+	int triggerFd; // fd the thread waits on for triggers when it has no task to do, or -1
+	int triggerFdMode; // kTRIGFD_EVENTFD, kTRIGFD_PIPE, or kTRIGFD_GPIO
+	int wakeFd; // eventfd written with the condition variable signal, so commands wake a thread waiting on its trigger fd, or -1 until a trigger fd is set
+	/* ***************** queue of functions to mod custom data, run in order when kMODCUSTOM is set in doTask ************************/
+	unsigned int modQueued; // number of the most recently queued custom modification
+	unsigned int modDone; // number of the most recently run custom modification, queue is empty when modDone == modQueued
+	/* ******************************************* armed trigger section *************************************************************/
+	pulsedThreadArmStruct armTrigger; // flag the thread spins on when armed
+	/* ********************************************** cold section *********************************************************************/
+	/* *********** train durations, train fequencies, and train duty cycles. Same information as above ************************************/
+	alignas(kCACHE_LINE_SIZE) float trainDuration; // duration of train, in seconds, or 0 for infinite train
+	float trainFrequency; // frequency in Hz, i.e., pulses/second
+	float trainDutyCycle; // pulseDurUsecs/(pulseDurUsecs + pulseDelayUsecs)
+	pulsedThreadLatencyStruct armLatency; // trigger to first edge latency for triggered tasks
+	pulsedThreadLatencyStruct fdLatency; // event to first edge latency for tasks triggered by the trigger fd, written by the pthread with the mutex held
+	uint64_t fdMissed; // events on the trigger fd that came while the thread was busy, or with another event, written with the mutex held
+	unsigned long timerSlackNsecs; // timer slack the pthread sets for itself at the start of a task, 0 for the slack it had when borrowed
+	/* ********** requests in the custom modification queue, only read by the pthread when kMODCUSTOM is set, so kept out of the control lines ***/
+	pulsedThreadModRequest modQueue [kMOD_QUEUE_SIZE];
+	/* ************************ pattern task, read once at start of each task *************************************************/
+	pulsedThreadPatternFunc patternFunc; // runs the task in place of pulse/train code, nullptr for normal tasks
+	void * patternData; // data for the pattern function
 	/* ************************************* pthread variables *************************************************************/
-	pthread_t taskThread;
+	pthread_t taskThread; // pool pthread running the task, valid when threadState is kTHREAD_RUNNING
+	int threadState; // kTHREAD_NONE, kTHREAD_RUNNING, or kTHREAD_DONE
 	pthread_mutex_t taskMutex ;
 	pthread_cond_t taskVar;
 };
 
+/* ******************************************** endFunc offload *********************************************************************
+With endFuncs offloaded, the pthread does not run the endFunc, it copies the timing of the task, and the endFunc and its data, into the next slot
+of a single producer, single consumer, queue, and a companion thread, at normal priority, runs the endFunc with a task made from the copy. Timing
+changes the endFunc makes to the copy are given back to the task under the mutex, only the fields it changed, with the signal bits for the
+segments it changed, so a mod made after the copy was queued is kept. The pthread takes them up at the next safe
+boundary, the start of the next pulse of an infinite train, or the start of the next task. Other changes to the copy are discarded. A full queue
+drops the copy, and counts it, so the pthread never waits on the companion */
+const unsigned int kOFFLOAD_QUEUE_SIZE = 64; // copies that can be waiting for the companion thread
+
+typedef struct pulsedThreadEndFuncCopy{
+	void (*endFunc)(void *, taskParams *);
+	void * endFuncData;
+	unsigned int doTask;
+	unsigned int pulseDelayUsecs;
+	unsigned int pulseDurUsecs;
+	unsigned int nPulses;
+	float trainDuration;
+	float trainFrequency;
+	float trainDutyCycle;
+}pulsedThreadEndFuncCopy, *pulsedThreadEndFuncCopyPtr;
+
+struct pulsedThreadOffloadStruct{
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> nQueued;	// written only by the pthread
+	std::atomic<uint64_t> nDropped;								// written only by the pthread, read by other threads
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> nDone;		// written only by the companion thread
+	pulsedThreadEndFuncCopy queue [kOFFLOAD_QUEUE_SIZE];		// copy n is in queue [n % kOFFLOAD_QUEUE_SIZE]
+	sem_t queueSem;				// posted by the pthread for each copy queued, and once to stop the companion
+	std::atomic<int> killWorker;	// set when the companion is to run what is left in the queue and return
+	pthread_t worker;			// the companion thread
+	taskParams * theTask;		// task the endFuncs belong to
+	/* task given to the endFunc by the companion. Value-initialized, so fields not listed are zero or nullptr: no offload, trace, chain, clock,
+	or trigger fd. Set once from the task: accLevel, loFunc, hiFunc, taskData, patternData. Set from each copy: endFunc, endFuncData, doTask
+	without the signal bits, pulseDelayUsecs, pulseDurUsecs, nPulses, and the train duration, frequency, and duty cycle. taskMutex and taskVar
+	are initialized, but are not those of the task, so locking them does not lock out the pthread */
+	taskParams copyTask;
+};
+typedef pulsedThreadOffloadStruct * pulsedThreadOffloadStructPtr;
+
+/* ******************************************** CPU cost accounting *********************************************************************
+With accounting on, the pthread stamps the time, and its CPU time from CLOCK_THREAD_CPUTIME_ID, when it starts a task, starts and ends each wait,
+and ends a task, and adds the time since the previous stamp to the phase that just ended. CPU time while waiting out a delay or duration is
+counted as spinning, and the rest of the wait as sleeping. Time in a task not waiting is counted as callbacks, hi, lo, and end functions, and the
+thread's own work, with its CPU time, which is less if a function blocks, e.g., on the Python GIL. Time between tasks is idle, with the CPU time
+an armed thread spends spinning on its trigger. Each stamp costs two clock reads, one of them a system call, so accounting is off by default */
+const int kCPU_IDLE = 0;		// between tasks
+const int kCPU_CALLBACK = 1;	// in a task, not waiting
+const int kCPU_WAIT = 2;		// waiting out a delay or duration
+
+typedef struct pulsedThreadCpuStats{
+	uint64_t spinNsecs;			// CPU time while waiting out delays and durations, mostly spinning
+	uint64_t sleepNsecs;		// time asleep while waiting out delays and durations
+	uint64_t callbackNsecs;		// time in tasks not waiting
+	uint64_t callbackCpuNsecs;	// CPU time in tasks not waiting
+	uint64_t idleNsecs;			// time between tasks
+	uint64_t idleCpuNsecs;		// CPU time between tasks, spinning while armed, or waking for a trigger
+	uint64_t wallNsecs;			// time since accounting was turned on
+	uint64_t nTasks;			// tasks started since accounting was turned on
+}pulsedThreadCpuStats, *pulsedThreadCpuStatsPtr;
+
+/* stats are written only by the pthread, inside a sequence lock, so getCpuStats copies a consistent set */
+struct pulsedThreadCpuAccount{
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> seq;	// odd while the pthread writes stats
+	pulsedThreadCpuStats stats;
+	int phase;					// kCPU_IDLE, kCPU_CALLBACK, or kCPU_WAIT, since the last stamp
+	uint64_t markNsecs;			// CLOCK_MONOTONIC time of the last stamp
+	uint64_t markCpuNsecs;		// thread CPU time of the last stamp, 0 if the pthread has not stamped yet
+	uint64_t startNsecs;		// CLOCK_MONOTONIC time accounting was turned on
+};
+typedef pulsedThreadCpuAccount * pulsedThreadCpuAccountPtr;
+
 /* ******************* A Custom struct for endFunc Data using an array **************************
 for the two provided endFuncs that change frequency and dutyCycle for trains */
 typedef struct pulsedThreadArrayStruct{
@@ -104,9 +365,24 @@ typedef struct pulsedThreadArrayModStruct{
 }pulsedThreadArrayModStruct, *pulsedThreadArrayModStructPtr;
 
 
+/* ************************* preallocated command slot for array endFunc modifications ****************************************
+The pulsedThread class keeps a pool of these so setting up or modifying the array for the array endFuncs never calls new or delete
+on the pthread. A slot is claimed by the calling thread, filled in, passed as modData to one of the slot callbacks, and given back by
+the callback when it has run. If the endFunc data is not yet a pulsedThreadArrayStruct, the calling thread allocates one and puts it
+in newArrayStruct, and the callback installs it */
+const int kMOD_SLOTS = 16; // number of preallocated command slots per pulsedThread
+
+typedef struct pulsedThreadModSlot{
+	std::atomic<int> inUse;		// 1 from when the slot is claimed until its callback has run
+	int modBits;				// bit-wise for which param to modify, 1 for startPos, 2 for endPos, 4 for arrayPos, 8 for arrayData
+	pulsedThreadArrayStruct arrayVals;	// new values for the array struct
+	pulsedThreadArrayStructPtr newArrayStruct; // struct allocated by calling thread to install as endFunc data, or nullptr to use the existing one
+}pulsedThreadModSlot, *pulsedThreadModSlotPtr;
+
 /* *************************** Function Declarations for non-class Functions used by pthread **********************************/
 int pulsedThreadSetUpArrayCallback (void * modData, taskParams * theTask);
 int pulsedThreadSetArrayLimitsCallback (void * modData, taskParams * theTask);
+int pulsedThreadSetArraySlotCallback (void * modData, taskParams * theTask);
 void pulsedThreadFreqFromArrayEndFunc (void * endFuncData, taskParams * theTask);
 void pulsedThreadDutyCycleFromArrayEndFunc (void * endFuncData, taskParams * theTask);
 void pulsedThreadArrayStructCustomDel(void * taskData);
@@ -115,7 +391,162 @@ void pulsedThreadArrayStructCustomDel(void * taskData);
 /* **************** Non-Class Utility Functions Used by Thread that we want Inlined for speed yet available for subclasses ********************
 ******************************************************************************************************************************************
 
- ******************* Configure timespecs and timevals for thread timing and to do the waiting for acc level 0**************
+ ******************* Monotonic time in nanoseconds, used for trigger latency ***************************************/
+inline uint64_t pulsedThreadNanos (void){
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+inline uint64_t pulsedThreadCpuNanos (void){
+	struct timespec now;
+	clock_gettime (CLOCK_THREAD_CPUTIME_ID, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/* adds time from the last stamp up to wall and CPU times to the counters of a phase */
+inline void pulsedThreadCpuAdd (pulsedThreadCpuStats & stats, int phase, uint64_t wallNsecs, uint64_t cpuNsecs){
+	switch (phase){
+		case kCPU_IDLE:
+			stats.idleNsecs += wallNsecs;
+			stats.idleCpuNsecs += cpuNsecs;
+			break;
+		case kCPU_CALLBACK:
+			stats.callbackNsecs += wallNsecs;
+			stats.callbackCpuNsecs += cpuNsecs;
+			break;
+		default:
+			stats.spinNsecs += cpuNsecs;
+			stats.sleepNsecs += (wallNsecs > cpuNsecs) ? wallNsecs - cpuNsecs : 0;
+			break;
+	}
+}
+
+/* ****************************** stamps the end of one phase, and the start of another, called only by the pthread ************************/
+inline void pulsedThreadCpuStamp (taskParams * theTask, int phase){
+	pulsedThreadCpuAccountPtr account = theTask->cpuAccount;
+	if (account == nullptr){
+		return;
+	}
+	uint64_t nowNsecs = pulsedThreadNanos ();
+	uint64_t cpuNsecs = pulsedThreadCpuNanos ();
+	uint64_t seq = account->seq.load (std::memory_order_relaxed);
+	account->seq.store (seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence (std::memory_order_release);
+	pulsedThreadCpuAdd (account->stats, account->phase, nowNsecs - account->markNsecs, (account->markCpuNsecs == 0) ? 0 : cpuNsecs - account->markCpuNsecs);
+	if ((phase == kCPU_CALLBACK) && (account->phase == kCPU_IDLE)){
+		account->stats.nTasks +=1;
+	}
+	account->phase = phase;
+	account->markNsecs = nowNsecs;
+	account->markCpuNsecs = cpuNsecs;
+	account->seq.store (seq + 2, std::memory_order_release);
+}
+
+/* ******************* Wakes a thread waiting on its trigger fd, which does not see the condition variable *************************/
+inline void pulsedThreadWakeFd (taskParams * theTask){
+	if (theTask->wakeFd >= 0){
+		uint64_t one = 1;
+		ssize_t nBytes = write (theTask->wakeFd, &one, sizeof (uint64_t));
+		(void) nBytes;
+	}
+}
+
+/* ******************* Signals the thread after doTask, armMode, or a modification has been requested, called with mutex held *****************/
+inline void pulsedThreadSignal (taskParams * theTask){
+	pthread_cond_signal (&theTask->taskVar);
+	pulsedThreadWakeFd (theTask);
+}
+
+/* ****************** Hint to the processor that we are in a spin loop **************************************/
+inline void pulsedThreadCpuRelax (void){
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause ();
+#elif defined(__aarch64__) || (defined(__ARM_ARCH) && (__ARM_ARCH >= 7))
+	asm volatile ("yield" ::: "memory");
+#else
+	asm volatile ("" ::: "memory");
+#endif
+}
+
+/* ******************************* Spins on the trigger flag while a thread is armed ********************************************
+Returns trigger time in nanoseconds when a task is triggered, or 0 if thread was disarmed or woken, or a modification was requested, and the
+thread needs to go back to top of loop. isChained is set if the trigger is a start time posted by a chained thread, which is left in
+chainNsecs until the task is done. doTask and armMode are written by other threads under the mutex, so read them as volatile */
+inline uint64_t pulsedThreadArmSpin (taskParams * theTask, int spinMode, bool & isChained){
+	uint64_t triggerNsecs;
+	for (;;){
+		triggerNsecs = theTask->armTrigger.triggerNsecs.load (std::memory_order_acquire);
+		if (triggerNsecs != 0){
+			triggerNsecs = theTask->armTrigger.triggerNsecs.exchange (0, std::memory_order_acq_rel);
+			isChained = false;
+			return triggerNsecs;
+		}
+		if ((theTask->armTrigger.wake.load (std::memory_order_relaxed)) && (theTask->armTrigger.wake.exchange (0, std::memory_order_acq_rel))){
+			return 0;
+		}
+		triggerNsecs = theTask->armTrigger.chainNsecs.load (std::memory_order_acquire);
+		if (triggerNsecs != 0){
+			isChained = true;
+			return triggerNsecs;
+		}
+		if ((*(volatile int *)&theTask->armMode == kARM_OFF) || (*(volatile unsigned int *)&theTask->doTask & kMODANY)){
+			return 0;
+		}
+		if (spinMode == kARM_SPIN_PAUSE){
+			pulsedThreadCpuRelax ();
+		}else{
+			if (spinMode == kARM_SPIN_YIELD){
+				sched_yield ();
+			}
+		}
+	}
+}
+
+/* *************************************** wake-up latency of the host, for ACC_MODE_AUTO ****************************************************/
+unsigned int pulsedThreadHostLatency (void); // microseconds a nanosleep wakes up late, at the 95th percentile, kSLEEPTURNAROUND/2 until measured. Never measures, safe on a pthread
+unsigned int pulsedThreadMeasureHostLatency (void); // measures the latency on the calling thread, taking about 2 ms, if not yet measured, and returns it
+void pulsedThreadSetHostLatency (unsigned int latencyUsecs); // sets the latency, e.g., measured on an idle system, or 0 to measure again now, on the calling thread
+
+inline unsigned int pulsedThreadAutoTurnaround (unsigned int latencyUsecs){
+	return (2 * latencyUsecs > (unsigned int)kSLEEPTURNAROUND) ? 2 * latencyUsecs : (unsigned int)kSLEEPTURNAROUND;
+}
+
+inline int pulsedThreadAutoChoice (unsigned int microSeconds, unsigned int latencyUsecs){
+	if (microSeconds <= pulsedThreadAutoTurnaround (latencyUsecs)){
+		return kAUTO_SPINS;
+	}else if ((uint64_t)latencyUsecs * kAUTO_SLEEP_RATIO <= microSeconds){
+		return kAUTO_SLEEPS;
+	}else{
+		return kAUTO_SLEEPS_AND_SPINS;
+	}
+}
+
+/* expected time spent spinning at the end of a segment at ACC_MODE_AUTO */
+inline unsigned int pulsedThreadAutoSpin (unsigned int microSeconds, unsigned int latencyUsecs){
+	switch (pulsedThreadAutoChoice (microSeconds, latencyUsecs)){
+		case kAUTO_SLEEPS:
+			return 0;
+		case kAUTO_SPINS:
+			return microSeconds;
+		default:
+			return pulsedThreadAutoTurnaround (latencyUsecs);
+	}
+}
+
+/* *************************************** shared tick for wake-up coalescing ****************************************************************/
+unsigned int pulsedThreadCoalesceTick (void); // microseconds between ticks of the shared grid
+int pulsedThreadSetCoalesceTick (unsigned int tickUsecs); // sets the tick for waits from now on, returns 1 if tickUsecs is 0
+
+/* moves a CLOCK_MONOTONIC wake-up time to the nearest tick of the grid, if that is within toleranceUsecs */
+inline uint64_t pulsedThreadCoalesce (uint64_t wakeNsecs, unsigned int toleranceUsecs){
+	uint64_t tickNsecs = (uint64_t)pulsedThreadCoalesceTick () * 1000;
+	uint64_t tickWakeNsecs = ((wakeNsecs + tickNsecs/2) / tickNsecs) * tickNsecs;
+	uint64_t offNsecs = (tickWakeNsecs > wakeNsecs) ? tickWakeNsecs - wakeNsecs : wakeNsecs - tickWakeNsecs;
+	return (offNsecs <= (uint64_t)toleranceUsecs * 1000) ? tickWakeNsecs : wakeNsecs;
+}
+
+/* ******************* Configure timespecs and timevals for thread timing and to do the waiting for acc level 0**************
 All we do is sleep for entire duration */
 inline void configureSleeper (unsigned int microSeconds, struct timespec *Sleeper){
 	Sleeper->tv_sec = microSeconds/1e06;
@@ -180,6 +611,314 @@ inline void WAITINLINE2 (bool itSleeps, struct timeval* turnaroundTime, struct t
 }
 
 
+/* ************************* runs all queued custom modifications, in the order they were queued *****************************
+Called by the pthread with the mutex held when kMODCUSTOM is set in doTask. Clears kMODCUSTOM when the queue is empty */
+inline void pulsedThreadRunModQueue (taskParams * theTask){
+	pulsedThreadModRequestPtr request;
+	while (theTask->modDone != theTask->modQueued){
+		request = &theTask->modQueue [(theTask->modDone + 1) % kMOD_QUEUE_SIZE];
+		request->result = request->modFunc (request->modData, theTask);
+		theTask->modDone +=1;
+	}
+	theTask->doTask &= ~kMODCUSTOM;
+}
+
+/* ******************************** timing for one segment of a pulse, the delay (low) or the duration (high) ***************************
+The thread function keeps one of these for the delay and one for the duration, and reconfigures them when the timing is modified */
+typedef struct pulsedThreadSegment{
+	struct timespec sleeper; // how long to sleep, accLevel 0 and 1
+	struct timeval period; // length of segment, added to spinEndTime, accLevel 1 and 2, and by an installed clock at any accLevel
+	bool itSleeps; // false if segment is too short to sleep, accLevel 1 and 2
+	unsigned int spinUsecs; // expected time spent spinning at end of segment, accLevel 1, 2, and 3
+	int autoChoice; // kAUTO_SLEEPS, kAUTO_SLEEPS_AND_SPINS, or kAUTO_SPINS, accLevel 3
+}pulsedThreadSegment, *pulsedThreadSegmentPtr;
+
+typedef struct pulsedThreadTimers{
+	pulsedThreadSegment delay; // low part of the pulse
+	pulsedThreadSegment dur; // high part of the pulse
+	struct timeval spinEndTime; // we initialize this from current time and then increment with each period
+	struct timeval turnaroundTime; // kSLEEPTURNAROUND microseconds, for accLevel 2, or from the host latency for accLevel 3
+}pulsedThreadTimers, *pulsedThreadTimersPtr;
+
+/* ******************************* configures a segment for a new length in microseconds ******************************************/
+inline void pulsedThreadConfigSegment (int accLevel, unsigned int microSeconds, pulsedThreadSegmentPtr seg){
+	switch (accLevel){
+		case ACC_MODE_SLEEPS:
+			configureSleeper (microSeconds, &seg->sleeper);
+			configureTimer (microSeconds, &seg->period);
+			seg->itSleeps = true;
+			seg->spinUsecs = 0;
+			break;
+		case ACC_MODE_SLEEPS_AND_SPINS:
+			seg->itSleeps = configureTurnaroundSleeper (microSeconds, &seg->sleeper);
+			configureTimer (microSeconds, &seg->period);
+			seg->spinUsecs = seg->itSleeps ? kSLEEPTURNAROUND : microSeconds;
+			break;
+		case ACC_MODE_SLEEPS_AND_OR_SPINS:
+			configureTimer (microSeconds, &seg->period);
+			seg->itSleeps = configureTurnaround (microSeconds);
+			seg->spinUsecs = seg->itSleeps ? kSLEEPTURNAROUND : microSeconds;
+			break;
+		case ACC_MODE_AUTO:{
+			unsigned int latencyUsecs = pulsedThreadHostLatency ();
+			configureTimer (microSeconds, &seg->period);
+			seg->autoChoice = pulsedThreadAutoChoice (microSeconds, latencyUsecs);
+			seg->itSleeps = (seg->autoChoice != kAUTO_SPINS);
+			seg->spinUsecs = pulsedThreadAutoSpin (microSeconds, latencyUsecs);
+			break;
+		}
+	}
+}
+
+/* ***************************** configures both segments and turnaround time from the task ****************************************/
+inline void pulsedThreadConfigTimers (taskParams * theTask, pulsedThreadTimersPtr timers){
+	configureTimer ((theTask->accLevel == ACC_MODE_AUTO) ? pulsedThreadAutoTurnaround (pulsedThreadHostLatency ()) : kSLEEPTURNAROUND, &timers->turnaroundTime);
+	pulsedThreadConfigSegment (theTask->accLevel, theTask->pulseDelayUsecs, &timers->delay);
+	pulsedThreadConfigSegment (theTask->accLevel, theTask->pulseDurUsecs, &timers->dur);
+}
+
+/* ****************************** does modifications requested in the high bits of doTask *********************************************
+Called by the pthread with the mutex held. Reconfigures the segments for new delay and/or duration, and runs queued custom modifications */
+inline void pulsedThreadDoMods (taskParams * theTask, pulsedThreadTimersPtr timers){
+	if (theTask->doTask & kMODDELAY){
+#if beVerbose
+		printf ("thread received  signal with new delay = %d\n", theTask->pulseDelayUsecs);
+#endif
+		pulsedThreadConfigSegment (theTask->accLevel, theTask->pulseDelayUsecs, &timers->delay);
+		theTask->doTask -= kMODDELAY;
+	}
+	if (theTask->doTask & kMODDUR){
+#if beVerbose
+		printf ("thread received  signal with new duration = %d\n", theTask->pulseDurUsecs);
+#endif
+		pulsedThreadConfigSegment (theTask->accLevel, theTask->pulseDurUsecs, &timers->dur);
+		theTask->doTask -= kMODDUR;
+	}
+	if (theTask->doTask & kMODCUSTOM){
+		pulsedThreadRunModQueue (theTask);
+	}
+}
+
+/* ******************************** current time, from the installed clock if there is one ************************************************/
+inline void pulsedThreadGetTime (taskParams * theTask, struct timeval * currentTime){
+	if (theTask->clock == nullptr){
+		gettimeofday (currentTime, NULL);
+	}else{
+		theTask->clock->getTime (theTask->clock->clockData, currentTime);
+	}
+}
+
+/* ******************************** runs the endFunc, or queues a copy of the task for the companion thread to run it *************************/
+inline void pulsedThreadEndFunc (taskParams * theTask){
+	if (theTask->endFunc == nullptr){
+		return;
+	}
+	pulsedThreadOffloadStructPtr offload = theTask->offload;
+	if (offload == nullptr){
+		theTask->endFunc (theTask->endFuncData, theTask);
+		return;
+	}
+	uint64_t nQueued = offload->nQueued.load (std::memory_order_relaxed);
+	if (nQueued - offload->nDone.load (std::memory_order_acquire) >= kOFFLOAD_QUEUE_SIZE){
+		offload->nDropped.store (offload->nDropped.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return;
+	}
+	pulsedThreadEndFuncCopyPtr copy = &offload->queue [nQueued % kOFFLOAD_QUEUE_SIZE];
+	copy->endFunc = theTask->endFunc;
+	copy->endFuncData = theTask->endFuncData;
+	copy->doTask = theTask->doTask;
+	copy->pulseDelayUsecs = theTask->pulseDelayUsecs;
+	copy->pulseDurUsecs = theTask->pulseDurUsecs;
+	copy->nPulses = theTask->nPulses;
+	copy->trainDuration = theTask->trainDuration;
+	copy->trainFrequency = theTask->trainFrequency;
+	copy->trainDutyCycle = theTask->trainDutyCycle;
+	offload->nQueued.store (nQueued + 1, std::memory_order_release);
+	sem_post (&offload->queueSem);
+}
+
+/* ******************************** posts start times to the threads chained to an edge, without waiting *****************************************
+A post only succeeds if the target is armed and has taken its last post, else it is counted as missed */
+inline void pulsedThreadChainEdge (pulsedThreadChainStructPtr chain, unsigned int channel, int kind){
+	uint64_t edgeNsecs = 0;
+	for (unsigned int iLink =0; iLink < chain->nLinks; iLink +=1){
+		pulsedThreadChainLinkPtr link = &chain->links [iLink];
+		if ((link->edge != kind) || (link->channel != channel)){
+			continue;
+		}
+		if (edgeNsecs == 0){
+			edgeNsecs = pulsedThreadNanos ();
+		}
+		uint64_t expected = 0;
+		if ((*(volatile int *)&link->target->armMode != kARM_OFF) &&
+		(link->target->armTrigger.chainNsecs.compare_exchange_strong (expected, edgeNsecs + link->offsetNsecs, std::memory_order_acq_rel))){
+			link->nPosted.store (link->nPosted.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}else{
+			link->nMissed.store (link->nMissed.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	}
+}
+
+/* ******************************** runs everything hooked to an edge, or a task start, called by every task and pattern at each edge ***********
+Stamps the first hi edge of a triggered task, for the latency stats, records the edge if a trace is installed, and posts start times to the
+threads chained to the edge, if there is a chain */
+inline void pulsedThreadEdgeHooks (taskParams * theTask, unsigned int channel, int kind){
+	if ((kind == kTRACE_HI) && (theTask->stampFirstEdge)){
+		theTask->firstEdgeNsecs = pulsedThreadNanos ();
+		theTask->stampFirstEdge = false;
+	}
+	if (theTask->trace != nullptr){
+		pulsedThreadTraceRecord (theTask->trace, theTask, channel, kind);
+	}
+	if (theTask->chain != nullptr){
+		pulsedThreadChainEdge (theTask->chain, channel, kind);
+	}
+}
+
+/* ******************************** waits until a CLOCK_MONOTONIC time, sleeping until kSLEEPTURNAROUND before it, and spinning the rest ******/
+inline void pulsedThreadWaitNanos (uint64_t untilNsecs){
+	uint64_t sleepUntilNsecs = untilNsecs - (uint64_t)kSLEEPTURNAROUND * 1000;
+	if ((untilNsecs > (uint64_t)kSLEEPTURNAROUND * 1000) && (pulsedThreadNanos () < sleepUntilNsecs)){
+		struct timespec sleepUntil = {(time_t)(sleepUntilNsecs / 1000000000ULL), (long)(sleepUntilNsecs % 1000000000ULL)};
+		clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &sleepUntil, NULL);
+	}
+	while (pulsedThreadNanos () < untilNsecs){
+		pulsedThreadCpuRelax ();
+	}
+}
+
+/* ******************************** sleeps until a time from gettimeofday, if it has not passed *************************************************
+With a coalescing tolerance, the deadline is moved to CLOCK_MONOTONIC, where the shared grid is, and the thread sleeps until the nearest tick */
+inline void pulsedThreadSleepUntil (const struct timeval * deadline, unsigned int toleranceUsecs){
+	struct timeval currentTime;
+	gettimeofday (&currentTime, NULL);
+	if (timercmp (&currentTime, deadline, <)){
+		struct timeval remaining;
+		struct timespec sleeper;
+		timersub (deadline, &currentTime, &remaining);
+		if (toleranceUsecs == 0){
+			sleeper.tv_sec = remaining.tv_sec;
+			sleeper.tv_nsec = remaining.tv_usec * 1000;
+			nanosleep (&sleeper, NULL);
+		}else{
+			uint64_t wakeNsecs = pulsedThreadCoalesce (pulsedThreadNanos () + (uint64_t)remaining.tv_sec * 1000000000ULL + (uint64_t)remaining.tv_usec * 1000, toleranceUsecs);
+			sleeper.tv_sec = (time_t)(wakeNsecs / 1000000000ULL);
+			sleeper.tv_nsec = (long)(wakeNsecs % 1000000000ULL);
+			clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &sleeper, NULL);
+		}
+	}
+}
+
+/* ********************************** waits for the length of a segment, as per accLevel ***********************************************
+accLevel 1 starts timing the segment from the current time, accLevel 2 adds the segment to the end time of the previous segment, 
+so spinEndTime needs to be initialized from current time at the start of each task. With a clock installed, accLevel 0 and 1 segments
+start at the clock's current time, accLevel 2 segments at the end of the previous segment, and the clock does the waiting. accLevel 3
+segments are timed as for accLevel 2, and sleep, sleep and spin, or spin, as chosen when the segment was configured. accLevel 0 segments
+are also timed as for accLevel 2 when wake-ups are coalesced */
+inline void pulsedThreadWaitSegment (taskParams * theTask, pulsedThreadTimersPtr timers, pulsedThreadSegmentPtr seg){
+	pulsedThreadCpuStamp (theTask, kCPU_WAIT);
+	if (theTask->clock != nullptr){
+		if ((theTask->accLevel != ACC_MODE_SLEEPS_AND_OR_SPINS) && (theTask->accLevel != ACC_MODE_AUTO)){
+			theTask->clock->getTime (theTask->clock->clockData, &timers->spinEndTime);
+		}
+		timeradd (&timers->spinEndTime, &seg->period, &timers->spinEndTime);
+		theTask->clock->waitUntil (theTask->clock->clockData, theTask, &timers->spinEndTime);
+		pulsedThreadCpuStamp (theTask, kCPU_CALLBACK);
+		return;
+	}
+	switch (theTask->accLevel){
+		case ACC_MODE_SLEEPS:
+			if (theTask->coalesceUsecs != 0){
+				timeradd (&timers->spinEndTime, &seg->period, &timers->spinEndTime);
+				pulsedThreadSleepUntil (&timers->spinEndTime, theTask->coalesceUsecs);
+			}else{
+				nanosleep (&seg->sleeper, NULL);
+			}
+			break;
+		case ACC_MODE_SLEEPS_AND_SPINS:
+			gettimeofday (&timers->spinEndTime, NULL);
+			timeradd (&timers->spinEndTime, &seg->period, &timers->spinEndTime);
+			if (theTask->spinEntry != nullptr){
+				pulsedThreadSpinPublish (theTask->spinEntry, &timers->spinEndTime, seg->spinUsecs);
+			}
+			WAITINLINE1 (seg->itSleeps, &seg->sleeper, &timers->spinEndTime);
+			break;
+		default:
+			timeradd (&timers->spinEndTime, &seg->period, &timers->spinEndTime);
+			if (theTask->spinEntry != nullptr){
+				pulsedThreadSpinPublish (theTask->spinEntry, &timers->spinEndTime, seg->spinUsecs);
+			}
+			WAITINLINE2 (seg->itSleeps, &timers->turnaroundTime, &timers->spinEndTime);
+			break;
+		case ACC_MODE_AUTO:
+			timeradd (&timers->spinEndTime, &seg->period, &timers->spinEndTime);
+			if (seg->autoChoice == kAUTO_SLEEPS){
+				pulsedThreadSleepUntil (&timers->spinEndTime, theTask->coalesceUsecs);
+				break;
+			}
+			if (theTask->spinEntry != nullptr){
+				pulsedThreadSpinPublish (theTask->spinEntry, &timers->spinEndTime, seg->spinUsecs);
+			}
+			WAITINLINE2 (seg->itSleeps, &timers->turnaroundTime, &timers->spinEndTime);
+			break;
+	}
+	pulsedThreadCpuStamp (theTask, kCPU_CALLBACK);
+}
+
+/* ******************************** waits until an absolute deadline, for pattern tasks ***********************************************
+Pattern tasks keep a start time and compute each edge from it, so edges do not drift with the time spent in callbacks. accLevel 0 sleeps
+for the time remaining, accLevels 1 and 2 sleep until the turnaround time before the deadline, if there is time, then spin. accLevel 3
+makes its choice for the time remaining, as the edges of a pattern can each be a different length */
+inline void pulsedThreadWaitUntil (taskParams * theTask, pulsedThreadTimersPtr timers, const struct timeval * deadline){
+	timers->spinEndTime = *deadline;
+	pulsedThreadCpuStamp (theTask, kCPU_WAIT);
+	if (theTask->clock != nullptr){
+		theTask->clock->waitUntil (theTask->clock->clockData, theTask, deadline);
+		pulsedThreadCpuStamp (theTask, kCPU_CALLBACK);
+		return;
+	}
+	bool itSpins = (theTask->accLevel != ACC_MODE_SLEEPS);
+	unsigned int spinUsecs = kSLEEPTURNAROUND;
+	if (theTask->accLevel == ACC_MODE_AUTO){
+		struct timeval currentTime;
+		gettimeofday (&currentTime, NULL);
+		if (timercmp (&currentTime, deadline, <)){
+			struct timeval remaining;
+			timersub (deadline, &currentTime, &remaining);
+			unsigned int latencyUsecs = pulsedThreadHostLatency ();
+			uint64_t remainingUsecs = (uint64_t)remaining.tv_sec * 1000000 + remaining.tv_usec;
+			itSpins = (remainingUsecs < 0xFFFFFFFF) && (pulsedThreadAutoChoice ((unsigned int)remainingUsecs, latencyUsecs) != kAUTO_SLEEPS);
+			spinUsecs = pulsedThreadAutoTurnaround (latencyUsecs);
+		}
+	}
+	if (!itSpins){
+		pulsedThreadSleepUntil (deadline, theTask->coalesceUsecs);
+	}else{
+		if (theTask->spinEntry != nullptr){
+			pulsedThreadSpinPublish (theTask->spinEntry, deadline, spinUsecs);
+		}
+		WAITINLINE2 (true, &timers->turnaroundTime, &timers->spinEndTime);
+	}
+	pulsedThreadCpuStamp (theTask, kCPU_CALLBACK);
+}
+
+/* ************************************ deadline that is a number of microseconds after a start time ***********************************/
+inline void pulsedThreadDeadline (const struct timeval * startTime, uint64_t microSeconds, struct timeval * deadline){
+	struct timeval offset;
+	offset.tv_sec = microSeconds/1000000;
+	offset.tv_usec = microSeconds % 1000000;
+	timeradd (startTime, &offset, deadline);
+}
+
+/* ********************* does any timing or custom modifications requested while a pattern task is running *********************************/
+inline void pulsedThreadPatternMods (taskParams * theTask, pulsedThreadTimersPtr timers){
+	if (theTask->doTask & kMODANY){
+		pthread_mutex_lock (&theTask->taskMutex);
+		pulsedThreadDoMods (theTask, timers);
+		pthread_mutex_unlock (&theTask->taskMutex);
+	}
+}
+
 /* ************************************** Utility functions to convert between pulse timing and train frequency/duration *********************************
  **** Converts from pulse-based info (pulseDelay, pulseDuation, number of pulses) to frequency-based info (trainDuration, frequency, dutyCycle) *******/
 inline int ticks2Times (unsigned int pulseDelay, unsigned int pulseDuration, unsigned int nPulses, taskParams &theTask){
@@ -206,8 +945,9 @@ inline int ticks2Times (unsigned int pulseDelay, unsigned int pulseDuration, uns
 	return 0;
 }
 
-/* ** Converts from frequency-based info (trainDuration, frequency, dutyCycle) to pulse-based info (pulseDelay, pulseDuation, number of pulses) **/
-inline int times2Ticks (float frequency, float dutyCycle, float trainDuration, taskParams &theTask){
+/* ** Converts from frequency-based info (trainDuration, frequency, dutyCycle) to pulse-based info (pulseDelay, pulseDuation, number of pulses) **
+pulse-based info is returned in the reference variables, not written to a task, so it can be published along with other changes */
+inline int times2TicksVals (float frequency, float dutyCycle, float trainDuration, unsigned int &pulseDelay, unsigned int &pulseDuration, unsigned int &nPulses){
 #if beVerbose
 	printf ("times2Ticks requested params:  frequency = %.2f, dutyCycle = %.2f, trainDuration = %.2f\n", frequency, dutyCycle, trainDuration);
 #endif
@@ -218,10 +958,20 @@ inline int times2Ticks (float frequency, float dutyCycle, float trainDuration, t
 		return 1;
 	}
 	float pulseMicrosecs = 1e06 / frequency;
-	unsigned int newDelay= round (pulseMicrosecs * (1 - dutyCycle));
-	unsigned int newDur = round (pulseMicrosecs * dutyCycle);
-	unsigned int newnPulses = round ((trainDuration * 1e06) / pulseMicrosecs);
+	pulseDelay = round (pulseMicrosecs * (1 - dutyCycle));
+	pulseDuration = round (pulseMicrosecs * dutyCycle);
+	nPulses = round ((trainDuration * 1e06) / pulseMicrosecs);
+	return 0;
+}
 
+/* ** as above, writing pulse-based info to the task **/
+inline int times2Ticks (float frequency, float dutyCycle, float trainDuration, taskParams &theTask){
+	unsigned int newDelay;
+	unsigned int newDur;
+	unsigned int newnPulses;
+	if (times2TicksVals (frequency, dutyCycle, trainDuration, newDelay, newDur, newnPulses)){
+		return 1;
+	}
 	theTask.pulseDelayUsecs = newDelay;
 	theTask.pulseDurUsecs =  newDur;
 	theTask.nPulses = newnPulses;
@@ -234,10 +984,14 @@ class pulsedThread{
 		/* Constructors 
 		errCode is a reference variable that returns 1 if input was not ok, else 0. Should really throw an exception....
 		accLevel is 0 to trust nanosleep for the timing - may not be as accurate, but less processor intenisve, good for up to a couple hundred Hz,
-		accLevel is 1 to keep a timer going to track elapsed time, and to cycle on current time for short intervals. processor intensive, but more accurate  */
+		accLevel is 1 to keep a timer going to track elapsed time, and to cycle on current time for short intervals. processor intensive, but more accurate
+		accLevel is 3, ACC_MODE_AUTO, to choose for each delay and duration from its length and the host's wake-up latency, and choose again when they change */
 		pulsedThread (unsigned int, unsigned int, unsigned int, void *  , int (*)(void *, void *  &), void (*)(void *), void (*)(void *), int , int &);
 		pulsedThread  (float, float, float, void *, int (*)(void *, void * &), void (*)(void *), void (*)(void *), int , int &);
 		virtual ~pulsedThread(void);
+		/* taskParams is cache-line aligned, which plain new does not guarantee before C++17, so allocate aligned memory ourselves */
+		static void * operator new (size_t size);
+		static void operator delete (void * ptr);
 		/* ********************* Requesting a task and checking if we are doing a task ***********************************************************/
 		void DoTask (void); // requests that the thread perform its task once, as currently configured, if not an infinite train, or will start an infinite train
 		void DoTasks (unsigned int nTasks); // requests that the thread perform its task nTasks times, as currently configured, or
@@ -248,10 +1002,37 @@ class pulsedThread{
 		// for infinite trains
 		void startInfiniteTrain(void);  // starts an infinite train
 		void stopInfiniteTrain (void); // stops an infinite train
+		/* ******************************** Armed mode, thread spins waiting for a task instead of sleeping on condition variable ********/
+		int arm (int spinMode); // spinMode is kARM_SPIN, kARM_SPIN_PAUSE, or kARM_SPIN_YIELD. Returns 1 if spinMode is not valid
+		void disarm (void); // thread goes back to waiting on condition variable
+		int getArmMode (void); // returns kARM_OFF if not armed, else the spin mode
+		uint64_t getTriggerLatency (void); // nanoseconds from DoTask to first hi edge of most recent triggered task, 0 if no task has been triggered
+		uint64_t getTriggerLatencyStats (uint64_t & minNsecs, uint64_t & maxNsecs); // returns number of triggered tasks, fills min and max latency
+		void resetTriggerLatencyStats (void); // zeros the triggered task count and latency stats
+		/* ******************************** Chaining, an edge of this thread starts the task of another, armed, thread ********************/
+		int chainTo (pulsedThread * target, int edge, unsigned int channel, unsigned int offsetUsecs); // returns 1 if busy or armed, chain is full, or link is not valid
+		int unChain (void); // removes all links. Returns 1 if busy or armed
+		uint64_t getChainStats (unsigned int iLink, uint64_t & nMissed); // returns number of starts posted by a link, fills number of missed edges
+		/* ******************************** Offloading endFuncs to a companion thread, so they never delay edges ****************************/
+		int setEndFuncOffload (int isOffloaded); // 1 to run endFuncs on a companion thread, 0 to run them on the pthread. Returns 1 if busy or armed, or companion can not be made
+		uint64_t getEndFuncOffloadStats (uint64_t & nDropped); // returns number of endFuncs run by the companion, fills number dropped because the queue was full
+		/* ******************************** CPU cost accounting, time spinning, sleeping, in callbacks, and idle *************************/
+		int setCpuAccounting (int isAccounting); // 1 to start accounting, from zero, 0 to stop. Returns 1 if busy or armed
+		int getCpuStats (pulsedThreadCpuStats & stats); // fills stats, up to now. Returns 1 if not accounting
+		/* ******************************** Timer slack and wake-up coalescing, for threads that do not need microsecond timing ***************/
+		int setTimerSlack (unsigned long slackNsecs); // timer slack for the pthread, 0 for the default. Returns 1 if busy or armed
+		int setCoalescing (unsigned int toleranceUsecs); // moves wake-ups of waits that only sleep to the shared tick, within toleranceUsecs, 0 to stop. Returns 1 if busy or armed
+		/* ******************************** Trigger fd, thread starts a task on an event on a file descriptor ****************************/
+		int setTriggerFd (int fd, int fdMode); // fdMode is kTRIGFD_EVENTFD, kTRIGFD_PIPE, or kTRIGFD_GPIO, fd = -1 to stop. Returns 1 if thread is busy or armed
+		int getTriggerFd (void); // returns the trigger fd, or -1 if none, or if the thread stopped watching it at end of file or on an error
+		uint64_t getFdTriggerLatency (void); // nanoseconds from event to first hi edge of most recent task triggered by the trigger fd
+		uint64_t getFdTriggerStats (uint64_t & minNsecs, uint64_t & maxNsecs, uint64_t & nMissed); // returns number of triggered tasks, fills min and max latency, and missed events
+		void resetFdTriggerStats (void); // zeros the triggered task count, latency stats, and missed events
 		/* *********************************** Modifying  and Checking Timing by Pulse Time  ****************************************************************/
 		int modDelay (unsigned int newDelay); // sets delay time, before pulse, in microseconds. 0 means no delay
 		int modDur (unsigned int newDur); // sets pulse duration, in microseconds,
 		int modTrainLength (unsigned int newTicks); // sets number of pulses in a train. if set to 0 or 1, switches mode to infinite train or single pulse
+		int modTiming (unsigned int newDelay, unsigned int newDur, unsigned int newPulses); // sets delay, duration, and number of pulses together, thread sees all or none of the changes
 		unsigned int getNpulses (void); // will be 0 for infiniteTrain
 		int getpulseDurUsecs (void); // in microseconds
 		int getpulseDelayUsecs (void); // in microseconds, can be 0
@@ -259,12 +1040,16 @@ class pulsedThread{
 		int modTrainDur (float newDur); // changes duration of pulse train, in seconds (if not an infinite train)
 		int modFreq (float newFreq); // changes frequency (Hz) of train. Duration and duty cycle will not be changed
 		int modDutyCycle (float newDutyCycle); //changes duty cycle (as for PWM), frequency and duration unchanged
+		int modTrainTiming (float newFreq, float newDutyCycle, float newTrainDur); // sets frequency, duty cycle, and train duration together, thread sees all or none of the changes
 		float getTrainDuration (void); // train duration in seconds
 		float getTrainFrequency (void); //  train frequency in Hz
 		float getTrainDutyCycle (void); // duty cycle, dur/(dur + delay)
+		int getAutoChoice (int & delayChoice, int & durChoice); // fills kAUTO_SLEEPS, kAUTO_SLEEPS_AND_SPINS, or kAUTO_SPINS for delay and duration, as timed now. Returns 1 if accLevel is not ACC_MODE_AUTO
 		/* ********** Modifying custom data (taskData or endFunc data) with provided modifier data and modifier function ***************/
 		int modCustom (int (*modFunc)(void *, taskParams *), void * modData, int isLocking); // for either taskData or endFunc data
+		int queueModCustom (int (*modFunc)(void *, taskParams *), void * modData, unsigned int & requestNum); // queues a modification for the pthread, returns 1 if queue is full
 		int getModCustomStatus (void); // returns 1 if waiting for the pthread to do a requested modification for either taskData or endFunc data
+		int getModCustomStatus (unsigned int requestNum, int & result); // returns 1 if request is waiting, 0 if done with result filled, -1 if done but result was overwritten
 		void getTaskMutex (void);
 		void giveUpTaskMutex (void);
 		taskParams * getTask (void); // returns a pointer to the taskParams structure
@@ -284,14 +1069,35 @@ class pulsedThread{
 		int setUpEndFuncArray (float * newData, unsigned int nData, int isLocking); // sets up endFunc data to cycle through an array of floats
 		int setEndFuncArrayLimits (unsigned int startPosP, unsigned int endPosP, int isLocking); // sets start and end within array
 		int setEndFuncArrayPos (unsigned int arrayPosP, int isLocking); // sets current position within the array
+		/* ************************ Clock used to time the task, e.g., a virtual clock for testing *********************************/
+		int setClock (pulsedThreadClockPtr clock); // installs a clock, or nullptr for real time. Returns 1 if the thread is busy or armed
+		pulsedThreadClockPtr getClock (void); // returns the installed clock, or nullptr for real time
+		/* ************************ Recording the edges the thread makes, see pulsedThreadTrace.h **************************************/
+		int captureTrace (pulsedThreadTrace * trace); // installs a trace to record edges into, or nullptr to stop. Returns 1 if the thread is busy or armed
 		static int cosineDutyCycleArray  (float * arrayData, unsigned int arraySize, unsigned int period, float offset, float scaling); //Utility function to fill a passed-in array with a cosine
 		
 	protected:
+		void signalTask (void); // called with mutex held, signals the condition variable, or the trigger flag if thread is armed
+		void startThread (void); // called with mutex held, borrows a pthread from the pool to run the task if it does not have one yet
+		void signalMods (unsigned int modBits); // called with mutex held, sets signal bits kMODDELAY and/or kMODDUR and signals the thread, if it has a pthread
+		void stopThread (void); // stops tasks and waits for the thread function to return, for destructors of subclasses that free pattern data
 		/* *******************************taskParams structure ***********************************************************************************/
 		struct taskParams theTask;  // thread, mutex, condition variable, and task variables are all in theTask 
 		/* ********************************* function pointers for destructor to run ******************************************************/
 		void (*delTaskDataFunc)( void *); // function deletes custom Task Data used by Hifunc and LoFunc
 		void (*delEndFuncDataFunc) (void *); // function that deletes custom data used by endFunc
+		/* ********************** preallocated command slots for array endFunc modifications ********************************/
+		pulsedThreadModSlot modSlots [kMOD_SLOTS];
+		pulsedThreadModSlotPtr claimModSlot (void); // returns a free slot, or nullptr if all slots are waiting on the pthread
+		bool endFuncDataIsArray; // set when setUpEndFuncArray queues an array struct, so endFuncData is one, or will be when the request is run
+		/* ********************** threads started by edges of this thread, pointed to by theTask.chain when there are links ****************/
+		pulsedThreadChainStruct chainData;
+		/* ********************** CPU cost accounting, pointed to by theTask.cpuAccount when accounting ****************************************/
+		pulsedThreadCpuAccount cpuAccountData;
+	private:
+		void initTask (void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel); // sets all fields to starting values, before the constructor checks timing
+		int initTaskData (void *  initData, int (*initFunc)(void *, void * &)); // runs initFunc, then initializes the mutex and condition variable
+		bool taskMutexIsInit; // true once the mutex and condition variable are initialized, the destructor does not touch them otherwise
 };
 
 #endif // PULSEDTHREAD_H
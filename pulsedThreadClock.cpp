@@ -0,0 +1,150 @@
+#include "pulsedThreadClock.h"
+
+/* ********************************** real time, timeout seconds from now, for timed waits on the clock's condition variable ***********/
+static inline void clockTimeOut (float timeOutSecs, struct timespec * endTime){
+	clock_gettime (CLOCK_REALTIME, endTime);
+	uint64_t nsecs = (uint64_t)endTime->tv_nsec + (uint64_t)(timeOutSecs * 1e09);
+	endTime->tv_sec += nsecs / 1000000000;
+	endTime->tv_nsec = nsecs % 1000000000;
+}
+
+/* ****************************************************************************************************
+Constructor allocates space for edge records, so the thread never allocates memory while recording
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadVirtualClock::pulsedThreadVirtualClock (int mode, unsigned int maxRecordsP){
+	pthread_mutex_init (&clockMutex, NULL);
+	pthread_cond_init (&clockVar, NULL);
+	nowUsecs = 0;
+	limitUsecs = (mode == kCLOCK_STEPPED) ? 0 : UINT64_MAX;
+	blockedUsecs = 0;
+	maxRecords = maxRecordsP;
+	records = (maxRecords > 0) ? new uint64_t [maxRecords] : nullptr;
+	nRecords = 0;
+	clock.getTime = &pulsedThreadVirtualClock::getTime;
+	clock.waitUntil = &pulsedThreadVirtualClock::waitUntil;
+	clock.clockData = this;
+}
+
+pulsedThreadVirtualClock::~pulsedThreadVirtualClock (void){
+	pthread_mutex_destroy (&clockMutex);
+	pthread_cond_destroy (&clockVar);
+	if (records != nullptr){
+		delete [] records;
+	}
+}
+
+pulsedThreadClockPtr pulsedThreadVirtualClock::getClock (void){
+	return &clock;
+}
+
+/* ****************************************************************************************************
+Clock function for the thread, gives the virtual time
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThreadVirtualClock::getTime (void * clockData, struct timeval * currentTime){
+	pulsedThreadVirtualClock * vClock = (pulsedThreadVirtualClock *) clockData;
+	pthread_mutex_lock (&vClock->clockMutex);
+	uint64_t now = vClock->nowUsecs;
+	pthread_mutex_unlock (&vClock->clockMutex);
+	currentTime->tv_sec = now / 1000000;
+	currentTime->tv_usec = now % 1000000;
+}
+
+/* ****************************************************************************************************
+Clock function for the thread, moves virtual time to the deadline and records it. In stepped mode, first blocks until the
+limit reaches the deadline, or the pulsedThread is being destroyed. A deadline that has already passed does not move time back
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThreadVirtualClock::waitUntil (void * clockData, taskParams * theTask, const struct timeval * deadline){
+	pulsedThreadVirtualClock * vClock = (pulsedThreadVirtualClock *) clockData;
+	uint64_t deadlineUsecs = (uint64_t)deadline->tv_sec * 1000000 + deadline->tv_usec;
+	struct timespec endTime;
+	pthread_mutex_lock (&vClock->clockMutex);
+	while ((deadlineUsecs > vClock->limitUsecs) && (*(volatile int *)&theTask->killThread == 0)){
+		if (vClock->blockedUsecs == 0){
+			vClock->blockedUsecs = deadlineUsecs;
+			pthread_cond_broadcast (&vClock->clockVar);
+		}
+		clockTimeOut (kCLOCK_POLL_NSECS/1e09, &endTime);
+		pthread_cond_timedwait (&vClock->clockVar, &vClock->clockMutex, &endTime);
+	}
+	vClock->blockedUsecs = 0;
+	if (deadlineUsecs > vClock->nowUsecs){
+		vClock->nowUsecs = deadlineUsecs;
+	}
+	if (vClock->nRecords < vClock->maxRecords){
+		vClock->records [vClock->nRecords] = vClock->nowUsecs;
+	}
+	vClock->nRecords +=1;
+	pthread_mutex_unlock (&vClock->clockMutex);
+}
+
+uint64_t pulsedThreadVirtualClock::getNowUsecs (void){
+	pthread_mutex_lock (&clockMutex);
+	uint64_t now = nowUsecs;
+	pthread_mutex_unlock (&clockMutex);
+	return now;
+}
+
+/* ****************************************************************************************************
+Raises the limit, and waits for the thread to block on a wait with a deadline past the new limit. Virtual time is then the limit,
+so a modification made now is made at the limit time, and is seen by the thread at the same edge on every run
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadVirtualClock::runUntil (uint64_t newLimitUsecs, float timeOutSecs){
+	struct timespec endTime;
+	clockTimeOut (timeOutSecs, &endTime);
+	pthread_mutex_lock (&clockMutex);
+	limitUsecs = newLimitUsecs;
+	pthread_cond_broadcast (&clockVar);
+	int timedOut = 0;
+	while ((blockedUsecs == 0) || (blockedUsecs <= limitUsecs)){
+		if (pthread_cond_timedwait (&clockVar, &clockMutex, &endTime) != 0){
+			timedOut = 1;
+			break;
+		}
+	}
+	if ((!timedOut) && (limitUsecs > nowUsecs)){
+		nowUsecs = limitUsecs;
+	}
+	pthread_mutex_unlock (&clockMutex);
+	return timedOut;
+}
+
+void pulsedThreadVirtualClock::release (void){
+	pthread_mutex_lock (&clockMutex);
+	limitUsecs = UINT64_MAX;
+	pthread_cond_broadcast (&clockVar);
+	pthread_mutex_unlock (&clockMutex);
+}
+
+unsigned int pulsedThreadVirtualClock::getNumRecords (void){
+	pthread_mutex_lock (&clockMutex);
+	unsigned int n = nRecords;
+	pthread_mutex_unlock (&clockMutex);
+	return n;
+}
+
+/* ****************************************************************************************************
+Copies kept edge times to a buffer, oldest first
+Last Modified:
+2026/10/19 - initial version */
+unsigned int pulsedThreadVirtualClock::getRecords (uint64_t * buffer, unsigned int bufferSize){
+	pthread_mutex_lock (&clockMutex);
+	unsigned int nCopy = (nRecords < maxRecords) ? nRecords : maxRecords;
+	if (nCopy > bufferSize){
+		nCopy = bufferSize;
+	}
+	for (unsigned int iRecord =0; iRecord < nCopy; iRecord +=1){
+		buffer [iRecord] = records [iRecord];
+	}
+	pthread_mutex_unlock (&clockMutex);
+	return nCopy;
+}
+
+void pulsedThreadVirtualClock::resetRecords (void){
+	pthread_mutex_lock (&clockMutex);
+	nRecords = 0;
+	pthread_mutex_unlock (&clockMutex);
+}
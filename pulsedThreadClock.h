@@ -0,0 +1,45 @@
+#ifndef PULSEDTHREADCLOCK_H
+#define PULSEDTHREADCLOCK_H
+#include "pulsedThread.h"
+
+/* ******************************************** pulsedThreadVirtualClock ***************************************************************
+A virtual clock to install in a pulsedThread with setClock, for testing. Time starts at 0 and only moves when the thread waits: each wait
+sets the time to the wait's deadline at once, instead of sleeping, so a 10 minute train runs in as long as its hi, lo, and end functions take.
+The time at the end of each wait, which is the time of the edge that follows it, is recorded, so the edge schedule can be checked afterwards.
+Hi, lo, and end functions take no virtual time, so the schedule does not depend on machine load.
+
+In kCLOCK_FREE mode, the thread runs as fast as it can. In kCLOCK_STEPPED mode, the thread stops at the first wait with a deadline after the
+limit set by runUntil, so a test can make modifications at known virtual times, e.g., runUntil 5 seconds, modDelay, runUntil 10 seconds, and
+get the same schedule every run. Use one virtual clock per pulsedThread. Destroy the pulsedThread before its clock.
+Last Modified:
+2026/10/19 - initial version */
+
+const int kCLOCK_FREE = 0;		// waits return at once, with time advanced to the deadline
+const int kCLOCK_STEPPED = 1;	// waits with deadlines past the limit set by runUntil block until the limit is raised
+const long kCLOCK_POLL_NSECS = 10000000; // a blocked wait checks killThread this often, so a pulsedThread can be destroyed while stepped
+
+class pulsedThreadVirtualClock{
+	public:
+		pulsedThreadVirtualClock (int mode, unsigned int maxRecords); // maxRecords is the number of edge times kept, further edges are counted but not kept
+		~pulsedThreadVirtualClock (void);
+		pulsedThreadClockPtr getClock (void); // pass this to pulsedThread::setClock
+		uint64_t getNowUsecs (void); // virtual time, in microseconds
+		int runUntil (uint64_t limitUsecs, float timeOutSecs); // stepped mode, lets the thread run until it waits past limitUsecs. Returns 1 if it had not got there after timeOutSecs of real time, e.g., task ended first
+		void release (void); // switches to free mode, so a blocked thread runs on
+		unsigned int getNumRecords (void); // number of edges since last reset, including those not kept
+		unsigned int getRecords (uint64_t * buffer, unsigned int bufferSize); // copies kept edge times, in microseconds, to buffer. Returns number copied
+		void resetRecords (void); // forgets recorded edges, virtual time is not changed
+	private:
+		static void getTime (void * clockData, struct timeval * currentTime); // clock functions installed in the pulsedThread
+		static void waitUntil (void * clockData, taskParams * theTask, const struct timeval * deadline);
+		pulsedThreadClock clock;
+		pthread_mutex_t clockMutex;
+		pthread_cond_t clockVar;	// signalled when the limit is raised, or when the thread blocks at the limit
+		uint64_t nowUsecs;
+		uint64_t limitUsecs;		// waits with deadlines past this block, UINT64_MAX in free mode
+		uint64_t blockedUsecs;		// deadline of the wait the thread is blocked on, 0 if not blocked
+		uint64_t * records;
+		unsigned int maxRecords;
+		unsigned int nRecords;
+};
+#endif
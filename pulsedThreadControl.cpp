@@ -0,0 +1,415 @@
+#include "pulsedThreadControl.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+pthread_mutex_t pulsedThreadControl::listMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t pulsedThreadControl::servedVar = PTHREAD_COND_INITIALIZER;
+pulsedThreadControl * pulsedThreadControl::controlList = nullptr;
+pulsedThreadControl * pulsedThreadControl::serving = nullptr;
+pthread_t pulsedThreadControl::executor;
+std::atomic<int> pulsedThreadControl::executorRunning (0);
+std::atomic<unsigned int> pulsedThreadControl::pollUsecs (kCTRL_POLL_USECS);
+
+/* ****************************************************************************************************
+Returns true if a segment with this name is a control segment left by an owner process that is no longer running, so it can be removed.
+A segment that is not a control segment, or that was made by a running process, is never stale
+Last Modified:
+2026/10/19 - initial version */
+static bool pulsedThreadControlIsStale (const char * name){
+	int fd = shm_open (name, O_RDONLY, 0);
+	if (fd < 0){
+		return false;
+	}
+	struct stat fileStat;
+	if ((fstat (fd, &fileStat) != 0) || (fileStat.st_size < (off_t) sizeof (pulsedThreadControlPage))){
+		close (fd);
+		return false;
+	}
+	void * mapBase = mmap (NULL, sizeof (pulsedThreadControlPage), PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (mapBase == MAP_FAILED){
+		return false;
+	}
+	pulsedThreadControlPagePtr page = (pulsedThreadControlPagePtr) mapBase;
+	bool isStale = false;
+	if (__atomic_load_n (&page->magic, __ATOMIC_ACQUIRE) == kCTRL_MAGIC){
+		pid_t ownerPid = page->ownerPid;
+		isStale = ((ownerPid != getpid ()) && (kill (ownerPid, 0) != 0) && (errno == ESRCH));
+	}
+	munmap (mapBase, sizeof (pulsedThreadControlPage));
+	return isStale;
+}
+
+/* ****************************************************************************************************
+Maps a control segment. The owner makes the segment exclusively, removing first an old one left by a process that died, and sets up the ring
+and status page before setting the magic number. A segment of an owner that is still running is never touched. A client maps an existing
+segment and checks its size, magic number, and version. Returns nullptr if the segment can not be made, opened or mapped, or is not a control
+segment of this version
+Last Modified:
+2026/10/19 - clears the ticket stored with each result
+2026/10/19 - owner makes the segment with O_EXCL, unlinking only a stale segment whose owner is dead, instead of truncating any segment
+2026/10/19 - initial version */
+pulsedThreadControlPagePtr pulsedThreadControlMap (const char * name, bool isOwner){
+	int fd = shm_open (name, (isOwner) ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0660);
+	if ((fd < 0) && (isOwner) && (errno == EEXIST) && (pulsedThreadControlIsStale (name))){
+		shm_unlink (name);
+		fd = shm_open (name, O_CREAT | O_EXCL | O_RDWR, 0660);
+	}
+	if (fd < 0){
+#if beVerbose
+		printf ("pulsedThreadControlMap error: could not open shared memory %s.\n", name);
+#endif
+		return nullptr;
+	}
+	struct stat fileStat;
+	if (((isOwner) && (ftruncate (fd, sizeof (pulsedThreadControlPage)) != 0)) ||
+	((!isOwner) && ((fstat (fd, &fileStat) != 0) || (fileStat.st_size < (off_t) sizeof (pulsedThreadControlPage))))){
+#if beVerbose
+		printf ("pulsedThreadControlMap error: shared memory %s is not the size of a control segment.\n", name);
+#endif
+		close (fd);
+		if (isOwner){
+			shm_unlink (name);
+		}
+		return nullptr;
+	}
+	void * mapBase = mmap (NULL, sizeof (pulsedThreadControlPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (mapBase == MAP_FAILED){
+#if beVerbose
+		printf ("pulsedThreadControlMap error: could not map shared memory %s.\n", name);
+#endif
+		if (isOwner){
+			shm_unlink (name);
+		}
+		return nullptr;
+	}
+	pulsedThreadControlPagePtr page = (pulsedThreadControlPagePtr) mapBase;
+	if (isOwner){
+		// the segment is new, and zeroed by ftruncate, so no other process has it mapped yet
+		page = new (mapBase) pulsedThreadControlPage;
+		page->version = kCTRL_VERSION;
+		page->ownerPid = getpid ();
+		page->nEnqueued.store (0);
+		page->nDequeued.store (0);
+		for (unsigned int iSlot = 0; iSlot < kCTRL_RING_SIZE; iSlot +=1){
+			page->ring [iSlot].seq.store (iSlot);
+			page->results [iSlot].store (0);
+			page->resultTickets [iSlot].store (0);
+		}
+		memset (&page->status, 0, sizeof (pulsedThreadStatus));
+		page->statusSeq.store (0);
+		std::atomic_thread_fence (std::memory_order_release);
+		__atomic_store_n (&page->magic, kCTRL_MAGIC, __ATOMIC_RELEASE);
+	}else if ((__atomic_load_n (&page->magic, __ATOMIC_ACQUIRE) != kCTRL_MAGIC) || (page->version != kCTRL_VERSION)){
+#if beVerbose
+		printf ("pulsedThreadControlMap error: shared memory %s is not a version %d control segment.\n", name, kCTRL_VERSION);
+#endif
+		munmap (mapBase, sizeof (pulsedThreadControlPage));
+		return nullptr;
+	}
+	return page;
+}
+
+/* ****************************************************************************************************
+Constructor makes the segment and adds the control to the list served by the executor, starting the executor if it is not running
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadControl::pulsedThreadControl (pulsedThread * gThread, const char * gName, int &errCode){
+	thread = gThread;
+	name = nullptr;
+	next = nullptr;
+	page = ((gThread == nullptr) || (gName == nullptr)) ? nullptr : pulsedThreadControlMap (gName, true);
+	if (page == nullptr){
+		errCode = 1;
+		return;
+	}
+	name = strdup (gName);
+	pthread_mutex_lock (&listMutex);
+	next = controlList;
+	controlList = this;
+	if (executorRunning.load () == 0){
+		pthread_attr_t attr;
+		pthread_attr_init (&attr);
+		pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+		errCode = pthread_create (&executor, &attr, &pulsedThreadControl::executorFunc, nullptr);
+		pthread_attr_destroy (&attr);
+		if (errCode){
+#if beVerbose
+			printf ("pulsedThreadControl error: could not start executor thread.\n");
+#endif
+			controlList = next;
+			pthread_mutex_unlock (&listMutex);
+			munmap (page, sizeof (pulsedThreadControlPage));
+			shm_unlink (name);
+			page = nullptr;
+			return;
+		}
+		executorRunning.store (1);
+	}
+	pthread_mutex_unlock (&listMutex);
+	errCode = 0;
+}
+
+/* ****************************************************************************************************
+Destructor waits for the executor to be done serving the control, then removes it from the list, so the executor does not serve it again,
+then unmaps and removes the segment. Clients that still have it mapped keep their mapping, but nothing runs their commands. The executor
+exits when the list is empty
+Last Modified:
+2026/10/19 - waits on servedVar for the executor to be done with the control, as the executor no longer holds listMutex while serving
+2026/10/19 - initial version */
+pulsedThreadControl::~pulsedThreadControl (void){
+	if (page == nullptr){
+		return;
+	}
+	pthread_mutex_lock (&listMutex);
+	while (serving == this){
+		pthread_cond_wait (&servedVar, &listMutex);
+	}
+	for (pulsedThreadControl ** link = &controlList; *link != nullptr; link = &(*link)->next){
+		if (*link == this){
+			*link = next;
+			break;
+		}
+	}
+	pthread_mutex_unlock (&listMutex);
+	munmap (page, sizeof (pulsedThreadControlPage));
+	shm_unlink (name);
+	free (name);
+}
+
+void pulsedThreadControl::setPollUsecs (unsigned int gPollUsecs){
+	pollUsecs.store (gPollUsecs);
+}
+
+pulsedThreadControlPagePtr pulsedThreadControl::getPage (void){
+	return page;
+}
+
+/* ****************************************************************************************************
+Executor thread, serves each control in the list, then sleeps pollUsecs, or pauses if pollUsecs is 0. Exits when the list is empty,
+clearing executorRunning under listMutex, so a new control starts a new executor. listMutex is released while a control is served, with
+serving set so its destructor waits, and the control stays in the list, so its next pointer is still good when the executor gets the mutex back
+Last Modified:
+2026/10/19 - releases listMutex while serving each control, so controls are not held up while commands run, or while spinning
+2026/10/19 - initial version */
+void * pulsedThreadControl::executorFunc (void * unused){
+	struct timespec pollTime;
+	for (;;){
+		pthread_mutex_lock (&listMutex);
+		if (controlList == nullptr){
+			executorRunning.store (0);
+			pthread_mutex_unlock (&listMutex);
+			return nullptr;
+		}
+		for (pulsedThreadControl * control = controlList; control != nullptr; control = control->next){
+			serving = control;
+			pthread_mutex_unlock (&listMutex);
+			control->serve ();
+			pthread_mutex_lock (&listMutex);
+			serving = nullptr;
+			pthread_cond_broadcast (&servedVar);
+		}
+		pthread_mutex_unlock (&listMutex);
+		unsigned int usecs = pollUsecs.load (std::memory_order_relaxed);
+		if (usecs == 0){
+			pulsedThreadCpuRelax ();
+		}else{
+			pollTime.tv_sec = usecs / 1000000;
+			pollTime.tv_nsec = (usecs % 1000000) * 1000;
+			nanosleep (&pollTime, NULL);
+		}
+	}
+}
+
+/* ****************************************************************************************************
+Runs each published command, in ticket order, stopping at the first slot not yet published, then writes the status with the sequence lock.
+Each slot is freed for the command kCTRL_RING_SIZE tickets later after its result is stored, and nDone is only passed in the status after
+that, so a client that sees its command done finds its result. Each result is stored with its ticket, as for a sequence lock: the ticket is
+cleared, the result is stored, and the ticket + 1 is stored, so a client can tell if the result it read was overwritten by a later command.
+lastResult and nFailed are only written inside the sequence lock, with the rest of the status
+Last Modified:
+2026/10/19 - stores the ticket of each result with the result
+2026/10/19 - writes lastResult and nFailed inside the sequence lock
+2026/10/19 - initial version */
+void pulsedThreadControl::serve (void){
+	uint64_t nDequeued = page->nDequeued.load (std::memory_order_relaxed);
+	pulsedThreadStatus & status = page->status;
+	// the executor is the only writer of the status, so it can read its own last values outside the sequence lock
+	int lastResult = status.lastResult;
+	uint64_t nFailed = status.nFailed;
+	for (;;){
+		pulsedThreadCommandPtr command = &page->ring [nDequeued % kCTRL_RING_SIZE];
+		if (command->seq.load (std::memory_order_acquire) != nDequeued + 1){
+			break;
+		}
+		int result = runCommand (command);
+		unsigned int resultSlot = nDequeued % kCTRL_RING_SIZE;
+		page->resultTickets [resultSlot].store (0, std::memory_order_relaxed);
+		std::atomic_thread_fence (std::memory_order_release);
+		page->results [resultSlot].store (result, std::memory_order_relaxed);
+		page->resultTickets [resultSlot].store (nDequeued + 1, std::memory_order_release);
+		command->seq.store (nDequeued + kCTRL_RING_SIZE, std::memory_order_release);
+		nDequeued +=1;
+		page->nDequeued.store (nDequeued, std::memory_order_relaxed);
+		lastResult = result;
+		if (result){
+			nFailed +=1;
+		}
+	}
+	uint64_t statusSeq = page->statusSeq.load (std::memory_order_relaxed);
+	page->statusSeq.store (statusSeq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence (std::memory_order_release);
+	status.nDone = nDequeued;
+	status.nFailed = nFailed;
+	status.lastResult = lastResult;
+	status.busy = thread->isBusy ();
+	status.armMode = thread->getArmMode ();
+	status.nPulses = thread->getNpulses ();
+	status.delayUsecs = thread->getpulseDelayUsecs ();
+	status.durUsecs = thread->getpulseDurUsecs ();
+	status.trainFrequency = thread->getTrainFrequency ();
+	status.trainDutyCycle = thread->getTrainDutyCycle ();
+	status.trainDuration = thread->getTrainDuration ();
+	status.updateNsecs = pulsedThreadNanos ();
+	page->statusSeq.store (statusSeq + 2, std::memory_order_release);
+}
+
+/* ****************************************************************************************************
+Runs a command with the pulsedThread method for its op. Returns the result of the method, 0 for methods with no result, or 1 if op is not valid
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadControl::runCommand (pulsedThreadCommandPtr command){
+	switch (command->op){
+		case kCTRL_DO_TASKS:
+			thread->DoTasks (command->uArg);
+			return 0;
+		case kCTRL_UNDO_TASKS:
+			thread->UnDoTasks ();
+			return 0;
+		case kCTRL_START_TRAIN:
+			thread->startInfiniteTrain ();
+			return 0;
+		case kCTRL_STOP_TRAIN:
+			thread->stopInfiniteTrain ();
+			return 0;
+		case kCTRL_MOD_DELAY:
+			return thread->modDelay (command->uArg);
+		case kCTRL_MOD_DUR:
+			return thread->modDur (command->uArg);
+		case kCTRL_MOD_LENGTH:
+			return thread->modTrainLength (command->uArg);
+		case kCTRL_MOD_FREQ:
+			return thread->modFreq (command->fArg);
+		case kCTRL_MOD_DUTY:
+			return thread->modDutyCycle (command->fArg);
+		case kCTRL_MOD_TRAIN_DUR:
+			return thread->modTrainDur (command->fArg);
+		case kCTRL_ARM:
+			return thread->arm ((int) command->uArg);
+		case kCTRL_DISARM:
+			thread->disarm ();
+			return 0;
+		default:
+#if beVerbose
+			printf ("pulsedThreadControl error: %d is not a valid command.\n", command->op);
+#endif
+			return 1;
+	}
+}
+
+/* ****************************************************************************************************
+Client constructor maps a segment made by a pulsedThreadControl, in this process or another
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadControlClient::pulsedThreadControlClient (const char * name, int &errCode){
+	page = (name == nullptr) ? nullptr : pulsedThreadControlMap (name, false);
+	errCode = (page == nullptr);
+}
+
+pulsedThreadControlClient::~pulsedThreadControlClient (void){
+	if (page != nullptr){
+		munmap (page, sizeof (pulsedThreadControlPage));
+	}
+}
+
+/* ****************************************************************************************************
+Claims the slot for the next ticket with a compare and swap on the enqueue count, retrying only if another client claimed it first, writes
+the command, and publishes it. Never blocks, so it is safe from any thread of any process
+Last Modified:
+2026/10/19 - initial version */
+uint64_t pulsedThreadControlClient::post (int op, unsigned int uArg, float fArg){
+	if ((page == nullptr) || (op < 0) || (op > kCTRL_MAX_OP)){
+		return 0;
+	}
+	uint64_t ticket = page->nEnqueued.load (std::memory_order_relaxed);
+	pulsedThreadCommandPtr command;
+	for (;;){
+		command = &page->ring [ticket % kCTRL_RING_SIZE];
+		int64_t diff = (int64_t)(command->seq.load (std::memory_order_acquire) - ticket);
+		if (diff == 0){
+			if (page->nEnqueued.compare_exchange_weak (ticket, ticket + 1, std::memory_order_relaxed)){
+				break;
+			}
+		}else if (diff < 0){ // slot still has a command from kCTRL_RING_SIZE tickets ago, ring is full
+			return 0;
+		}else{
+			ticket = page->nEnqueued.load (std::memory_order_relaxed);
+		}
+	}
+	command->op = op;
+	command->uArg = uArg;
+	command->fArg = fArg;
+	command->seq.store (ticket + 1, std::memory_order_release);
+	return ticket + 1;
+}
+
+/* ****************************************************************************************************
+Copies the status, retrying if the executor was writing it, as shown by an odd sequence number, or a sequence number that changed
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThreadControlClient::readStatus (pulsedThreadStatus & status){
+	for (;;){
+		uint64_t statusSeq = page->statusSeq.load (std::memory_order_acquire);
+		if (statusSeq & 1){
+			pulsedThreadCpuRelax ();
+			continue;
+		}
+		memcpy (&status, (const void *) &page->status, sizeof (pulsedThreadStatus));
+		std::atomic_thread_fence (std::memory_order_acquire);
+		if (page->statusSeq.load (std::memory_order_relaxed) == statusSeq){
+			return;
+		}
+	}
+}
+
+/* ****************************************************************************************************
+Waits, polling the status, for the command with a ticket from post to be done, and gets its result, which is good until the command
+kCTRL_RING_SIZE tickets later is done. The result is only returned if the ticket stored with it is this ticket both before and after it is
+read, else the result was overwritten and -1 is returned
+Last Modified:
+2026/10/19 - checks the ticket stored with the result, instead of nDone, which the executor passes only after a batch of commands
+2026/10/19 - initial version */
+int pulsedThreadControlClient::waitDone (uint64_t ticketPlusOne, float timeOutSecs, int & result){
+	uint64_t ticket = ticketPlusOne - 1;
+	uint64_t endNsecs = pulsedThreadNanos () + (uint64_t)(timeOutSecs * 1e9);
+	struct timespec pollTime = {0, 10000};
+	pulsedThreadStatus status;
+	for (readStatus (status); status.nDone <= ticket; readStatus (status)){
+		if (pulsedThreadNanos () > endNsecs){
+			return 1;
+		}
+		nanosleep (&pollTime, NULL);
+	}
+	unsigned int resultSlot = ticket % kCTRL_RING_SIZE;
+	if (page->resultTickets [resultSlot].load (std::memory_order_acquire) != ticketPlusOne){
+		return -1;
+	}
+	result = page->results [resultSlot].load (std::memory_order_relaxed);
+	std::atomic_thread_fence (std::memory_order_acquire);
+	return (page->resultTickets [resultSlot].load (std::memory_order_relaxed) == ticketPlusOne) ? 0 : -1;
+}
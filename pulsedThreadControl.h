@@ -0,0 +1,123 @@
+#ifndef PULSEDTHREADCONTROL_H
+#define PULSEDTHREADCONTROL_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadControl ***************************************************************
+A shared memory control plane, so other processes, e.g., a GUI or a logger, can request tasks, change timing, and watch a pulsedThread, with
+no sockets, and no system calls on their side. pulsedThreadControl makes a POSIX shared memory segment, with shm_open, for a pulsedThread,
+holding a ring of commands and a status page. A process opens the segment by name with pulsedThreadControlClient, posts commands to the ring
+with atomic operations only, and reads the status page.
+
+The ring takes commands from any number of clients: each claims a slot by incrementing the enqueue count, writes the command, and publishes it
+by setting the slot's sequence number. One executor thread per process, shared by all the controls of the process, takes commands from every
+ring, runs them with the pulsedThread methods, and updates each status page, every pollUsecs, or spinning with a pause if pollUsecs is 0.
+The status page is written with a sequence lock, so a client reads a consistent copy without ever blocking the executor. Each command gets
+a ticket number, and the page has the number of commands done, and the results of the last kCTRL_RING_SIZE commands, so a client can wait
+for its command and get its result. A client that dies after claiming a slot, before publishing it, stops the ring. The executor runs while
+any control is made, and leaves the pulsedThread's timing to its own pthread, so a slow poll delays commands, never edges. The executor
+releases the list mutex while it serves each control, so making and deleting controls is not held up by commands or by a spinning executor.
+A segment name can only have one owner. A segment left by an owner process that died is removed and made again, but not one with a live owner.
+Last Modified:
+2026/10/19 - each result slot has the ticket of its result, so a client can tell when its result was overwritten, layout version 2
+2026/10/19 - executor does not hold the list mutex while serving, segments are made exclusively
+2026/10/19 - initial version */
+
+const uint32_t kCTRL_MAGIC = 0x70744331;		// "ptC1", marks a control segment
+const uint32_t kCTRL_VERSION = 2;				// layout version, a client only opens a segment of the same version
+const unsigned int kCTRL_RING_SIZE = 64;		// commands that can be waiting, a power of 2
+const unsigned int kCTRL_POLL_USECS = 100;		// default time between executor polls
+
+/* ********************************** commands, with uArg or fArg as the argument of the pulsedThread method ************************/
+const int kCTRL_DO_TASKS = 0;		// DoTasks (uArg)
+const int kCTRL_UNDO_TASKS = 1;		// UnDoTasks ()
+const int kCTRL_START_TRAIN = 2;	// startInfiniteTrain ()
+const int kCTRL_STOP_TRAIN = 3;		// stopInfiniteTrain ()
+const int kCTRL_MOD_DELAY = 4;		// modDelay (uArg)
+const int kCTRL_MOD_DUR = 5;		// modDur (uArg)
+const int kCTRL_MOD_LENGTH = 6;		// modTrainLength (uArg)
+const int kCTRL_MOD_FREQ = 7;		// modFreq (fArg)
+const int kCTRL_MOD_DUTY = 8;		// modDutyCycle (fArg)
+const int kCTRL_MOD_TRAIN_DUR = 9;	// modTrainDur (fArg)
+const int kCTRL_ARM = 10;			// arm (uArg)
+const int kCTRL_DISARM = 11;		// disarm ()
+const int kCTRL_MAX_OP = 11;
+
+/* ******************************************* a command slot in the ring ****************************************************
+seq is the ticket of the command the slot is free for, and ticket + 1 once the command is written */
+typedef struct pulsedThreadCommand{
+	std::atomic<uint64_t> seq;
+	int op;
+	unsigned int uArg;
+	float fArg;
+}pulsedThreadCommand, *pulsedThreadCommandPtr;
+
+/* ********************************** status of the pulsedThread, written by the executor *****************************************/
+typedef struct pulsedThreadStatus{
+	uint64_t nDone;				// commands done, the command with ticket n is done when nDone > n
+	uint64_t nFailed;			// commands that were not valid, or returned an error
+	int lastResult;				// result of the most recent command, 0 for success
+	int busy;					// tasks left to do, as from isBusy
+	int armMode;
+	unsigned int nPulses;
+	unsigned int delayUsecs;
+	unsigned int durUsecs;
+	float trainFrequency;
+	float trainDutyCycle;
+	float trainDuration;
+	uint64_t updateNsecs;		// CLOCK_MONOTONIC time of the update, so a client can tell the executor is running
+}pulsedThreadStatus, *pulsedThreadStatusPtr;
+
+/* ******************************************* the shared memory segment ************************************************************
+Fields written by clients and by the executor are kept on separate cache lines */
+typedef struct pulsedThreadControlPage{
+	uint32_t magic;
+	uint32_t version;
+	int32_t ownerPid;											// process with the executor
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> nEnqueued;	// tickets claimed by clients
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> nDequeued;	// commands taken by the executor
+	alignas(kCACHE_LINE_SIZE) pulsedThreadCommand ring [kCTRL_RING_SIZE];
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> statusSeq;	// odd while the executor writes the status
+	pulsedThreadStatus status;
+	std::atomic<int> results [kCTRL_RING_SIZE];				// result of command with ticket n at results [n % kCTRL_RING_SIZE], written before nDone passes n
+	std::atomic<uint64_t> resultTickets [kCTRL_RING_SIZE];	// ticket + 1 of the result in results, 0 while the executor writes it
+}pulsedThreadControlPage, *pulsedThreadControlPagePtr;
+
+/* ******************************************* maps a control segment, for either side ********************************************/
+pulsedThreadControlPagePtr pulsedThreadControlMap (const char * name, bool isOwner);
+
+class pulsedThreadControl{
+	public:
+		/* name is a shared memory name, e.g., "/rig1_laser", the segment is made, or remade if its owner died, and removed by the destructor */
+		pulsedThreadControl (pulsedThread * thread, const char * name, int &errCode);
+		~pulsedThreadControl (void);
+		static void setPollUsecs (unsigned int pollUsecs); // time between executor polls, 0 to spin
+		pulsedThreadControlPagePtr getPage (void);
+	private:
+		void serve (void); // called by executor, runs waiting commands and updates status
+		int runCommand (pulsedThreadCommandPtr command);
+		static void * executorFunc (void * unused);
+		pulsedThread * thread;
+		pulsedThreadControlPagePtr page;
+		char * name;
+		pulsedThreadControl * next;				// next control served by the executor
+		static pthread_mutex_t listMutex;		// protects the list and serving
+		static pthread_cond_t servedVar;		// signalled, with listMutex, when the executor is done serving a control
+		static pulsedThreadControl * controlList;
+		static pulsedThreadControl * serving;	// control the executor is serving with listMutex released, stays in the list till done
+		static pthread_t executor;
+		static std::atomic<int> executorRunning;
+		static std::atomic<unsigned int> pollUsecs;
+};
+
+class pulsedThreadControlClient{
+	public:
+		pulsedThreadControlClient (const char * name, int &errCode); // opens a segment made by a pulsedThreadControl in any process
+		~pulsedThreadControlClient (void);
+		uint64_t post (int op, unsigned int uArg, float fArg); // posts a command, returns its ticket + 1, or 0 if the ring is full or op is not valid
+		void readStatus (pulsedThreadStatus & status); // copies a consistent status, spinning only while the executor is writing it
+		int waitDone (uint64_t ticketPlusOne, float timeOutSecs, int & result); // waits for a posted command. Returns 1 if timed out, 0 if done with result filled, -1 if done but result was overwritten
+	private:
+		pulsedThreadControlPagePtr page;
+};
+
+#endif // PULSEDTHREADCONTROL_H
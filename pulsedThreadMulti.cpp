@@ -0,0 +1,304 @@
+#include "pulsedThreadMulti.h"
+
+/* ******************************* starts a channel's pattern at a time, microseconds from start of task ******************************/
+static inline void multiStartChannel (pulsedThreadChannelPtr channel, pulsedThreadChannelStatePtr state, uint64_t startUsecs){
+	state->active = channel->enabled;
+	state->nextIsHi = 1;
+	state->pulsesLeft = channel->nPulses;
+	state->nextEdgeUsecs = startUsecs + channel->offsetUsecs;
+	// a single pulse has its delay before the pulse, trains start with the pulse
+	if (channel->nPulses == kPULSE){
+		state->nextEdgeUsecs += channel->delayUsecs;
+	}
+}
+
+/* ******************* schedules next edge of a channel after an edge, returns time the channel is done if it has finished ***************
+Follows the pulsedThread thread function: a train with no delay never goes low, and a train or pulse ends after its last delay */
+static inline void multiAdvanceChannel (pulsedThreadChannelPtr channel, pulsedThreadChannelStatePtr state, uint64_t & endUsecs){
+	uint64_t edgeUsecs = state->nextEdgeUsecs;
+	bool more;
+	if (channel->nPulses == kPULSE){
+		if (state->nextIsHi){
+			state->nextIsHi = 0;
+			state->nextEdgeUsecs = edgeUsecs + channel->durUsecs;
+		}else{
+			state->active = 0;
+			if (edgeUsecs > endUsecs){
+				endUsecs = edgeUsecs;
+			}
+		}
+		return;
+	}
+	if (state->nextIsHi){
+		if (channel->nPulses != kINFINITETRAIN){
+			state->pulsesLeft -=1;
+		}
+		if (channel->delayUsecs > 0){
+			state->nextIsHi = 0;
+			state->nextEdgeUsecs = edgeUsecs + channel->durUsecs;
+			return;
+		}
+		more = (channel->enabled) && ((channel->nPulses == kINFINITETRAIN) || (state->pulsesLeft > 0));
+		edgeUsecs += channel->durUsecs;
+	}else{
+		more = (channel->enabled) && ((channel->nPulses == kINFINITETRAIN) || (state->pulsesLeft > 0));
+		edgeUsecs += channel->delayUsecs;
+		state->nextIsHi = 1;
+	}
+	if (more){
+		state->nextEdgeUsecs = edgeUsecs;
+	}else{
+		state->active = 0;
+		if (edgeUsecs > endUsecs){
+			endUsecs = edgeUsecs;
+		}
+	}
+}
+
+/* ****************************************************************************************************
+Copies changed channel configurations for the thread, called at an edge while a task is running. At an edge the mutex is only tried, so the
+thread never blocks on a caller holding it; if it is busy, changedMask is left set and the changes are taken up at a later edge. An idle
+infinite task, with no edges to keep, waits for the mutex
+Last Modified:
+2026/10/19 - tries the mutex at an edge instead of waiting for it, and starts newly enabled channels no earlier than the next pending edge
+2026/10/19 - initial version */
+static void multiApplyChanges (taskParams * theTask, pulsedThreadMultiStructPtr multi, const struct timeval * startTime, bool mayWait){
+	if (mayWait){
+		pthread_mutex_lock (&theTask->taskMutex);
+	}else if (pthread_mutex_trylock (&theTask->taskMutex) != 0){
+		return;
+	}
+	uint32_t changed = multi->changedMask.exchange (0);
+	for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+		if (changed & (1u << iChan)){
+			multi->running [iChan] = multi->config [iChan];
+		}
+	}
+	pthread_mutex_unlock (&theTask->taskMutex);
+	/* channels that had stopped, or never started, and are now enabled, start from now, clamped to the next edge pending on the other
+	channels, so their first deadline is not already past and they join the running channels on the same edge */
+	struct timeval currentTime;
+	struct timeval sinceStart;
+	pulsedThreadGetTime (theTask, &currentTime);
+	timersub (&currentTime, startTime, &sinceStart);
+	uint64_t startUsecs = (uint64_t)sinceStart.tv_sec * 1000000 + sinceStart.tv_usec;
+	bool hasEdge = false;
+	uint64_t nextUsecs = 0;
+	for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+		if ((multi->state [iChan].active) && ((!hasEdge) || (multi->state [iChan].nextEdgeUsecs < nextUsecs))){
+			nextUsecs = multi->state [iChan].nextEdgeUsecs;
+			hasEdge = true;
+		}
+	}
+	if ((hasEdge) && (nextUsecs > startUsecs)){
+		startUsecs = nextUsecs;
+	}
+	for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+		if (!(changed & (1u << iChan))){
+			continue;
+		}
+		if (multi->running [iChan].enabled){
+			if (!multi->state [iChan].active){
+				multiStartChannel (&multi->running [iChan], &multi->state [iChan], startUsecs);
+			}
+		}else{
+			// a disabled channel that is low stops now, one that is high stops after its next low edge
+			if ((multi->state [iChan].active) && (multi->state [iChan].nextIsHi)){
+				multi->state [iChan].active = 0;
+			}
+		}
+	}
+}
+
+/* ****************************************************************************************************
+Pattern function for multi-channel tasks. Finds the earliest next edge over all active channels, collects every channel with an edge at that time
+into set and clear masks, waits until that time, and calls the output function once
+Last Modified:
+2026/10/19 - counts edges with a relaxed atomic, and applies channel changes without blocking at an edge
+2026/10/19 - runs the edge hooks for each channel when a trace or a chain is installed, so chains fire on multi-channel edges
+2026/10/19 - records edges of each channel to the installed trace, if there is one
+2026/10/19 - initial version */
+void pulsedThreadMultiPattern (taskParams * theTask, pulsedThreadTimers * timers){
+	pulsedThreadMultiStructPtr multi = (pulsedThreadMultiStructPtr) theTask->patternData;
+	bool isInfinite = (theTask->nPulses == kINFINITETRAIN);
+	// take up any changes made since the last task, and start all enabled channels
+	pthread_mutex_lock (&theTask->taskMutex);
+	multi->changedMask.store (0);
+	for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+		multi->running [iChan] = multi->config [iChan];
+	}
+	pthread_mutex_unlock (&theTask->taskMutex);
+	for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+		multiStartChannel (&multi->running [iChan], &multi->state [iChan], 0);
+	}
+	struct timeval startTime;
+	struct timeval deadline;
+	pulsedThreadGetTime (theTask, &startTime);
+	uint64_t endUsecs = 0;
+	for (;;){
+		if (theTask->killThread){
+			break;
+		}
+		if (isInfinite){
+			if (!(theTask->doTask & 1)){
+				break;
+			}
+			pulsedThreadPatternMods (theTask, timers);
+		}
+		if (multi->changedMask.load (std::memory_order_relaxed)){
+			multiApplyChanges (theTask, multi, &startTime, false);
+		}
+		// earliest edge of all active channels
+		bool hasEdge = false;
+		uint64_t edgeUsecs = 0;
+		for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+			if ((multi->state [iChan].active) && ((!hasEdge) || (multi->state [iChan].nextEdgeUsecs < edgeUsecs))){
+				edgeUsecs = multi->state [iChan].nextEdgeUsecs;
+				hasEdge = true;
+			}
+		}
+		if (!hasEdge){
+			if (!isInfinite){
+				break;
+			}
+			// an infinite task with no active channels waits for a channel to be changed, or to be stopped
+			pthread_mutex_lock (&theTask->taskMutex);
+			while ((multi->changedMask.load () == 0) && (theTask->doTask & 1) && (theTask->killThread == 0)){
+				pthread_cond_wait (&theTask->taskVar, &theTask->taskMutex);
+			}
+			pthread_mutex_unlock (&theTask->taskMutex);
+			// no edge is waiting, so take up the changes now rather than spinning on a busy mutex
+			if (multi->changedMask.load (std::memory_order_relaxed)){
+				multiApplyChanges (theTask, multi, &startTime, true);
+			}
+			continue;
+		}
+		// masks for all the channels with an edge at that time
+		uint32_t setMask = 0;
+		uint32_t clearMask = 0;
+		for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+			if ((multi->state [iChan].active) && (multi->state [iChan].nextEdgeUsecs == edgeUsecs)){
+				if (multi->state [iChan].nextIsHi){
+					setMask |= (1u << iChan);
+				}else{
+					clearMask |= (1u << iChan);
+				}
+				multiAdvanceChannel (&multi->running [iChan], &multi->state [iChan], endUsecs);
+			}
+		}
+		pulsedThreadDeadline (&startTime, edgeUsecs, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+		// edge hooks, for trace and chains, per channel, only looped over when there is a hook
+		if ((theTask->trace != nullptr) || (theTask->chain != nullptr)){
+			for (unsigned int iChan =0; iChan < multi->nChannels; iChan +=1){
+				if (setMask & (1u << iChan)){
+					pulsedThreadEdgeHooks (theTask, iChan, kTRACE_HI);
+				}
+				if (clearMask & (1u << iChan)){
+					pulsedThreadEdgeHooks (theTask, iChan, kTRACE_LO);
+				}
+			}
+		}
+		multi->multiFunc (theTask->taskData, setMask, clearMask);
+		multi->nEdges.store (multi->nEdges.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+	// wait out the last delay, so repeated tasks are spaced as for a train
+	if ((!isInfinite) && (endUsecs > 0) && (theTask->killThread == 0)){
+		pulsedThreadDeadline (&startTime, endUsecs, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+	}
+	if (!isInfinite){
+		pulsedThreadEndFunc (theTask);
+	}
+}
+
+/* ****************************************************************************************************
+Constructor makes a pulsedThread with dummy pulse timing and installs the pattern function. All channels start disabled
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadMulti::pulsedThreadMulti (unsigned int gMode, unsigned int gChannels, void * initData, int (*initFunc)(void *, void * &), void (*gMultiFunc)(void *, uint32_t, uint32_t), int gAccLevel, int &errCode) :
+	pulsedThread ((unsigned int) 0, (unsigned int) 1, (gMode == kINFINITETRAIN) ? (unsigned int) kINFINITETRAIN : (unsigned int) kPULSE, initData, initFunc, nullptr, nullptr, gAccLevel, errCode){
+	if (errCode){
+		return;
+	}
+	if ((gChannels == 0) || (gChannels > kMULTI_MAX_CHANNELS) || (gMultiFunc == nullptr) || ((gMode != kPULSE) && (gMode != kINFINITETRAIN))){
+#if beVerbose
+		printf ("pulsedThreadMulti error: %d channels, mode %d, output function %p.\n", gChannels, gMode, (void *) gMultiFunc);
+#endif
+		errCode = 1;
+		return;
+	}
+	multiData.multiFunc = gMultiFunc;
+	multiData.nChannels = gChannels;
+	for (unsigned int iChan =0; iChan < kMULTI_MAX_CHANNELS; iChan +=1){
+		multiData.config [iChan] = {0, 1, kPULSE, 0, 0};
+		multiData.state [iChan].active = 0;
+	}
+	multiData.changedMask.store (0);
+	multiData.nEdges.store (0);
+	theTask.patternData = &multiData;
+	theTask.patternFunc = &pulsedThreadMultiPattern;
+}
+
+/* ****************************************************************************************************
+Destructor stops the thread, as the pattern function uses multiData, which is gone once this destructor returns, before ~pulsedThread stops it
+Last Modified:
+2026/10/19 - stops the thread with stopThread
+2026/10/19 - initial version */
+pulsedThreadMulti::~pulsedThreadMulti (void){
+	stopThread ();
+}
+
+/* ****************************************************************************************************
+Configures and enables a channel. Duration must be > 0, and infinite channels need a kINFINITETRAIN task
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadMulti::setChannel (unsigned int channel, unsigned int delayUsecs, unsigned int durUsecs, unsigned int nPulses, unsigned int offsetUsecs){
+	if ((channel >= multiData.nChannels) || (durUsecs == 0) || ((nPulses == kINFINITETRAIN) && (theTask.nPulses != kINFINITETRAIN))){
+#if beVerbose
+		printf ("setChannel error: channel = %d, duration = %d, nPulses = %d.\n", channel, durUsecs, nPulses);
+#endif
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	multiData.config [channel] = {delayUsecs, durUsecs, nPulses, offsetUsecs, 1};
+	multiData.changedMask.fetch_or (1u << channel);
+	pulsedThreadSignal (&theTask);
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return 0;
+}
+
+int pulsedThreadMulti::enableChannel (unsigned int channel, int enable){
+	if (channel >= multiData.nChannels){
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	multiData.config [channel].enabled = (enable != 0);
+	multiData.changedMask.fetch_or (1u << channel);
+	pulsedThreadSignal (&theTask);
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return 0;
+}
+
+int pulsedThreadMulti::getChannel (unsigned int channel, pulsedThreadChannel & channelConfig){
+	if (channel >= multiData.nChannels){
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	channelConfig = multiData.config [channel];
+	pthread_mutex_unlock( &theTask.taskMutex);
+	return 0;
+}
+
+unsigned int pulsedThreadMulti::getNumChannels (void){
+	return multiData.nChannels;
+}
+
+/* ****************************************************************************************************
+Returns number of times the output function has been called. Read while the thread runs, so nEdges is atomic
+Last Modified:
+2026/10/19 - reads nEdges with a relaxed atomic load
+2026/10/19 - initial version */
+uint64_t pulsedThreadMulti::getNumEdges (void){
+	return multiData.nEdges.load (std::memory_order_relaxed);
+}
@@ -0,0 +1,67 @@
+#ifndef PULSEDTHREADMULTI_H
+#define PULSEDTHREADMULTI_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadMulti ***************************************************************
+A pulsedThread that drives up to 32 channels from one pthread with a shared time base. Each channel has its own delay, duration, number
+of pulses, and start offset, with the same meanings as for a pulsedThread. The thread merges the edges of all the channels into one
+timeline, and at each edge time calls a single output function with a mask of channels to set and a mask of channels to clear, so edges
+of different channels that fall at the same time are output together, e.g., by one write to a GPIO set or clear register.
+
+A pulsedThreadMulti made with kPULSE runs every enabled channel once for each task requested with DoTask/DoTasks, and the task ends when
+the last channel has finished its final delay. A pulsedThreadMulti made with kINFINITETRAIN runs from startInfiniteTrain to stopInfiniteTrain,
+and channels can be infinite (nPulses = 0). Channel changes made while a task is running are picked up at the next edge: new timing of an
+active channel is used from the next edge it schedules, a disabled channel finishes its current pulse and stops, and an enabled channel that
+had stopped starts again after its offset, counted from the time of the change, or from the next pending edge of the running channels if
+that is later. The thread only tries the mutex at an edge, so a change made while it is held may be picked up an edge later.
+Last Modified:
+2026/10/19 - newly enabled channels are clamped to the next edge, changes are applied without blocking, and nEdges is atomic
+2026/10/19 - initial version */
+
+const unsigned int kMULTI_MAX_CHANNELS = 32;	// channels are bits in 32 bit masks
+
+/* **************************************** configuration of a channel ****************************************************************/
+typedef struct pulsedThreadChannel{
+	unsigned int delayUsecs;	// delay before the pulse for a single pulse, or low time of each pulse in a train
+	unsigned int durUsecs;		// high time of each pulse, must be > 0
+	unsigned int nPulses;		// 1 for a single pulse, >= 2 for a train, 0 for infinite (only for kINFINITETRAIN)
+	unsigned int offsetUsecs;	// from start of the task to start of the channel
+	int enabled;				// 1 if channel is to be run, else 0
+}pulsedThreadChannel, *pulsedThreadChannelPtr;
+
+/* ********************** where a channel is in its pattern, used only by the thread *****************************************/
+typedef struct pulsedThreadChannelState{
+	uint64_t nextEdgeUsecs;		// time of next edge, microseconds from start of task
+	unsigned int pulsesLeft;	// pulses not yet started, not used for infinite channels
+	int nextIsHi;				// 1 if next edge sets the channel, 0 if it clears it
+	int active;					// 1 if channel has edges still to come
+}pulsedThreadChannelState, *pulsedThreadChannelStatePtr;
+
+/* ******************************** pattern data for a multi-channel task ***************************************************/
+typedef struct pulsedThreadMultiStruct{
+	void (*multiFunc)(void *, uint32_t, uint32_t); // output function, gets taskData, mask of channels to set, mask of channels to clear
+	unsigned int nChannels;
+	pulsedThreadChannel config [kMULTI_MAX_CHANNELS]; // written by setChannel with mutex held
+	std::atomic<uint32_t> changedMask; // channels whose config was changed since the thread last copied it
+	pulsedThreadChannel running [kMULTI_MAX_CHANNELS]; // thread's copy of config
+	pulsedThreadChannelState state [kMULTI_MAX_CHANNELS];
+	std::atomic<uint64_t> nEdges; // number of times output function has been called, written by the thread, read by getNumEdges
+}pulsedThreadMultiStruct, *pulsedThreadMultiStructPtr;
+
+void pulsedThreadMultiPattern (taskParams * theTask, pulsedThreadTimers * timers); // the pattern function
+
+class pulsedThreadMulti : public pulsedThread{
+	public:
+		/* gMode is kPULSE or kINFINITETRAIN, channels are all disabled to start with */
+		pulsedThreadMulti (unsigned int gMode, unsigned int gChannels, void * initData, int (*initFunc)(void *, void * &), void (*gMultiFunc)(void *, uint32_t, uint32_t), int gAccLevel, int &errCode);
+		~pulsedThreadMulti (void);
+		int setChannel (unsigned int channel, unsigned int delayUsecs, unsigned int durUsecs, unsigned int nPulses, unsigned int offsetUsecs); // configures and enables a channel, returns 1 if timing is not ok
+		int enableChannel (unsigned int channel, int enable); // enables or disables a channel, returns 1 if channel does not exist
+		int getChannel (unsigned int channel, pulsedThreadChannel & channelConfig); // copies configuration of a channel, returns 1 if channel does not exist
+		unsigned int getNumChannels (void);
+		uint64_t getNumEdges (void); // number of times the output function has been called
+	protected:
+		pulsedThreadMultiStruct multiData;
+};
+
+#endif // PULSEDTHREADMULTI_H
@@ -0,0 +1,171 @@
+#include "pulsedThreadNested.h"
+
+/* ****************************************************************************************************
+Pattern function for nested tasks. Steps through the pulses with a counter for each level, and waits until the start time of each pulse, the sum
+over levels of counter times period, counted from the start of the task or repeat
+Last Modified:
+2026/10/19 - counts pulses with a relaxed atomic
+2026/10/19 - initial version */
+void pulsedThreadNestedPattern (taskParams * theTask, pulsedThreadTimers * timers){
+	pulsedThreadNestStructPtr nest = (pulsedThreadNestStructPtr) theTask->patternData;
+	bool isInfinite = (theTask->nPulses == kINFINITETRAIN);
+	struct timeval startTime;
+	struct timeval deadline;
+	pulsedThreadGetTime (theTask, &startTime);
+	uint64_t repeatUsecs = 0; // start of current repeat, from start of task
+	unsigned int counters [kNEST_MAX_LEVELS];
+	do{
+		// take up a new pattern at the start of each task or repeat
+		if (nest->changed.load (std::memory_order_relaxed)){
+			pthread_mutex_lock (&theTask->taskMutex);
+			nest->running = nest->config;
+			nest->changed.store (0);
+			pthread_mutex_unlock (&theTask->taskMutex);
+		}
+		pulsedThreadNestConfigPtr config = &nest->running;
+		for (unsigned int iLevel =0; iLevel < config->nLevels; iLevel +=1){
+			counters [iLevel] = 0;
+		}
+		uint64_t pulseUsecs = repeatUsecs;
+		for (;;){
+			if (theTask->killThread){
+				return;
+			}
+			if (isInfinite){
+				if (!(theTask->doTask & 1)){
+					return;
+				}
+				pulsedThreadPatternMods (theTask, timers);
+			}
+			pulsedThreadDeadline (&startTime, pulseUsecs, &deadline);
+			pulsedThreadWaitUntil (theTask, timers, &deadline);
+			pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+			theTask->hiFunc (theTask->taskData);
+			pulsedThreadDeadline (&startTime, pulseUsecs + config->durUsecs, &deadline);
+			pulsedThreadWaitUntil (theTask, timers, &deadline);
+			pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+			theTask->loFunc (theTask->taskData);
+			nest->nPulses.store (nest->nPulses.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			// advance the counters, carrying to the level above when a level is done
+			unsigned int iLevel;
+			for (iLevel =0; iLevel < config->nLevels; iLevel +=1){
+				counters [iLevel] +=1;
+				if (counters [iLevel] < config->levels [iLevel].count){
+					break;
+				}
+				counters [iLevel] = 0;
+			}
+			if (iLevel == config->nLevels){
+				break;
+			}
+			pulseUsecs = repeatUsecs;
+			for (iLevel =0; iLevel < config->nLevels; iLevel +=1){
+				pulseUsecs += (uint64_t)counters [iLevel] * config->levels [iLevel].periodUsecs;
+			}
+		}
+		// wait out the last period of the top level, so repeats and repeated tasks are spaced by the top level period
+		pulsedThreadNestLevelPtr top = &config->levels [config->nLevels - 1];
+		repeatUsecs += (uint64_t)top->count * top->periodUsecs;
+		pulsedThreadDeadline (&startTime, repeatUsecs, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+		pulsedThreadEndFunc (theTask);
+	}while ((isInfinite) && (theTask->doTask & 1) && (theTask->killThread == 0));
+}
+
+/* ****************************************************************************************************
+Checks that each unit of a level ends before the next unit of the level starts, i.e., the period of each level is at least the time from the start
+of the first pulse of a unit of the level below to the end of its last pulse
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadNested::checkNest (unsigned int durUsecs, unsigned int nLevels, const pulsedThreadNestLevel * levels){
+	if ((durUsecs == 0) || (nLevels == 0) || (nLevels > kNEST_MAX_LEVELS) || (levels == nullptr)){
+#if beVerbose
+		printf ("checkNest error: duration = %d, number of levels = %d.\n", durUsecs, nLevels);
+#endif
+		return 1;
+	}
+	uint64_t extentUsecs = durUsecs;
+	for (unsigned int iLevel =0; iLevel < nLevels; iLevel +=1){
+		if ((levels [iLevel].count == 0) || (levels [iLevel].periodUsecs < extentUsecs)){
+#if beVerbose
+			printf ("checkNest error: level %d has count %d and period %d, which is shorter than the %llu microseconds of the level below.\n", iLevel, levels [iLevel].count, levels [iLevel].periodUsecs, (unsigned long long)extentUsecs);
+#endif
+			return 1;
+		}
+		extentUsecs += (uint64_t)(levels [iLevel].count - 1) * levels [iLevel].periodUsecs;
+	}
+	return 0;
+}
+
+/* ****************************************************************************************************
+Constructor makes a pulsedThread with the pulse timing of level 0, for getters, and installs the pattern function
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadNested::pulsedThreadNested (unsigned int gMode, unsigned int durUsecs, unsigned int nLevels, const pulsedThreadNestLevel * levels, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode) :
+	pulsedThread ((unsigned int) 0, (unsigned int) 1, (gMode == kINFINITETRAIN) ? (unsigned int) kINFINITETRAIN : (unsigned int) kPULSE, initData, initFunc, gLoFunc, gHiFunc, gAccLevel, errCode){
+	nestData.changed.store (0);
+	nestData.nPulses.store (0);
+	if (errCode){
+		return;
+	}
+	if (((gMode != kPULSE) && (gMode != kINFINITETRAIN)) || (gHiFunc == nullptr) || (gLoFunc == nullptr) || (checkNest (durUsecs, nLevels, levels))){
+#if beVerbose
+		printf ("pulsedThreadNested error: mode %d, needs hi and lo functions and a pattern that fits.\n", gMode);
+#endif
+		errCode = 1;
+		return;
+	}
+	setNest (durUsecs, nLevels, levels);
+	theTask.patternData = &nestData;
+	theTask.patternFunc = &pulsedThreadNestedPattern;
+}
+
+/* ****************************************************************************************************
+Destructor stops the thread, as the pattern function uses nestData, which is gone once this destructor returns, before ~pulsedThread stops it
+Last Modified:
+2026/10/19 - stops the thread with stopThread
+2026/10/19 - initial version */
+pulsedThreadNested::~pulsedThreadNested (void){
+	stopThread ();
+}
+
+/* ****************************************************************************************************
+Sets a new pattern, used from the start of the next task or repeat
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadNested::setNest (unsigned int durUsecs, unsigned int nLevels, const pulsedThreadNestLevel * levels){
+	if (checkNest (durUsecs, nLevels, levels)){
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	nestData.config.durUsecs = durUsecs;
+	nestData.config.nLevels = nLevels;
+	for (unsigned int iLevel =0; iLevel < nLevels; iLevel +=1){
+		nestData.config.levels [iLevel] = levels [iLevel];
+	}
+	nestData.changed.store (1);
+	// keep pulse timing of the task the same as level 0, for getters
+	theTask.pulseDurUsecs = durUsecs;
+	theTask.pulseDelayUsecs = levels [0].periodUsecs - durUsecs;
+	ticks2Times (theTask.pulseDelayUsecs, theTask.pulseDurUsecs, theTask.nPulses, theTask);
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+void pulsedThreadNested::getNest (pulsedThreadNestConfig & config){
+	pthread_mutex_lock (&theTask.taskMutex);
+	config = nestData.config;
+	pthread_mutex_unlock (&theTask.taskMutex);
+}
+
+uint64_t pulsedThreadNested::getNestDuration (void){
+	pthread_mutex_lock (&theTask.taskMutex);
+	pulsedThreadNestLevelPtr top = &nestData.config.levels [nestData.config.nLevels - 1];
+	uint64_t durUsecs = (uint64_t)top->count * top->periodUsecs;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return durUsecs;
+}
+
+uint64_t pulsedThreadNested::getNumPulses (void){
+	return nestData.nPulses.load (std::memory_order_relaxed);
+}
@@ -0,0 +1,58 @@
+#ifndef PULSEDTHREADNESTED_H
+#define PULSEDTHREADNESTED_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadNested ***************************************************************
+A pulsedThread that makes trains of trains, e.g., pulses inside bursts inside blocks, from one task. Level 0 is pulses, with count pulses per burst
+started periodUsecs apart, each high for durUsecs. Level 1 is bursts, with count bursts per block started periodUsecs apart, and so on for up to
+kNEST_MAX_LEVELS levels. Every pulse time is counted from the start of the task, so the thread makes the whole pattern as one sequence in absolute
+time, with no drift and no trip through DoTask and the condition variable between bursts.
+
+A pulsedThreadNested made with kPULSE makes the whole pattern for each task requested with DoTask/DoTasks, and the task ends one top level period
+after the start of the last top level unit, as a train ends after its last delay. The endFunc runs at the end of the task. A pulsedThreadNested
+made with kINFINITETRAIN repeats the whole pattern from startInfiniteTrain until stopInfiniteTrain, and runs the endFunc after each repeat.
+A new pattern set with setNest is used from the start of the next task or repeat.
+Last Modified:
+2026/10/19 - nPulses is a relaxed atomic, as getNumPulses reads it while the thread runs
+2026/10/19 - initial version */
+
+const unsigned int kNEST_MAX_LEVELS = 8;
+
+/* **************************************** one level of the pattern ****************************************************************/
+typedef struct pulsedThreadNestLevel{
+	unsigned int count;			// number of units of the level below (or pulses, for level 0) in a unit of this level, >= 1
+	unsigned int periodUsecs;	// start to start time of units of this level, in microseconds
+}pulsedThreadNestLevel, *pulsedThreadNestLevelPtr;
+
+/* **************************************** the whole pattern ***********************************************************************/
+typedef struct pulsedThreadNestConfig{
+	unsigned int durUsecs;		// high time of each pulse
+	unsigned int nLevels;		// number of levels used, 1 to kNEST_MAX_LEVELS
+	pulsedThreadNestLevel levels [kNEST_MAX_LEVELS];
+}pulsedThreadNestConfig, *pulsedThreadNestConfigPtr;
+
+/* ******************************** pattern data for a nested task ***************************************************/
+typedef struct pulsedThreadNestStruct{
+	pulsedThreadNestConfig config;	// written by setNest with mutex held
+	std::atomic<int> changed;		// 1 if config was changed since the thread last copied it
+	pulsedThreadNestConfig running;	// thread's copy of config
+	std::atomic<uint64_t> nPulses;	// number of pulses made, written by the thread, read by getNumPulses
+}pulsedThreadNestStruct, *pulsedThreadNestStructPtr;
+
+void pulsedThreadNestedPattern (taskParams * theTask, pulsedThreadTimers * timers); // the pattern function
+
+class pulsedThreadNested : public pulsedThread{
+	public:
+		/* gMode is kPULSE or kINFINITETRAIN, levels [0] is for pulses, levels [nLevels -1] for the top level */
+		pulsedThreadNested (unsigned int gMode, unsigned int durUsecs, unsigned int nLevels, const pulsedThreadNestLevel * levels, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode);
+		~pulsedThreadNested (void);
+		int setNest (unsigned int durUsecs, unsigned int nLevels, const pulsedThreadNestLevel * levels); // returns 1 if units of a level do not fit in the period of the level above
+		void getNest (pulsedThreadNestConfig & config); // copies the pattern
+		uint64_t getNestDuration (void); // microseconds from start of a task to its end
+		uint64_t getNumPulses (void); // number of pulses made since thread was made
+		static int checkNest (unsigned int durUsecs, unsigned int nLevels, const pulsedThreadNestLevel * levels); // returns 1 if the pattern is not ok
+	protected:
+		pulsedThreadNestStruct nestData;
+};
+
+#endif // PULSEDTHREADNESTED_H
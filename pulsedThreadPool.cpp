@@ -0,0 +1,237 @@
+#include "pulsedThreadPool.h"
+#include <string.h>
+#include <limits.h>
+
+/* ************************************** static members of the pool *******************************************/
+pthread_mutex_t pulsedThreadPool::poolMutex = PTHREAD_MUTEX_INITIALIZER;
+pulsedThreadWorkerPtr pulsedThreadPool::idleList = nullptr;
+unsigned int pulsedThreadPool::nIdle = 0;
+unsigned int pulsedThreadPool::maxIdle = kPOOL_MAX_IDLE;
+size_t pulsedThreadPool::stackSize = kPOOL_STACK_SIZE;
+size_t pulsedThreadPool::guardSize = kPOOL_GUARD_SIZE;
+size_t pulsedThreadPool::maxStackUsed = 0;
+
+/* ***************************** touches stack pages so the first task does not page fault *****************************/
+static void __attribute__ ((noinline)) prefaultStack (void){
+	volatile char stackBytes [kPOOL_PREFAULT];
+	memset ((char *)stackBytes, 0, kPOOL_PREFAULT);
+}
+
+/* ************ paints stack from paintStart up to a little below our own frame, which faults in the whole stack ***************/
+static void __attribute__ ((noinline)) paintStack (char * paintStart){
+	char * paintEnd = (char *) __builtin_frame_address (0) - 1024;
+	if (paintEnd > paintStart){
+		memset (paintStart, kPOOL_STACK_PAINT, paintEnd - paintStart);
+	}
+}
+
+/* ****************************************************************************************************
+Called by a worker after its task is done. Finds the lowest byte of stack that is no longer paint, updates maxStackUsed,
+and paints the used part again for the next task
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThreadPool::checkStack (pulsedThreadWorkerPtr worker){
+	char * lowest = worker->stackLo;
+	while ((lowest < worker->stackHi) && ((unsigned char)*lowest == kPOOL_STACK_PAINT)){
+		lowest +=1;
+	}
+	size_t used = worker->stackHi - lowest;
+	pthread_mutex_lock (&poolMutex);
+	if (used > maxStackUsed){
+		maxStackUsed = used;
+	}
+	pthread_mutex_unlock (&poolMutex);
+	paintStack (lowest);
+}
+
+/* ****************************************************************************************************
+Thread function of a pool pthread. Waits with the pool mutex for a task, runs the pulsedThread thread function for the task
+until the task is killed, marks the task done, and goes back to the pool, or exits if the pool already has enough idle pthreads
+Last Modified:
+2026/10/19 - initial version */
+void * pulsedThreadPool::workerFunc (void * workerData){
+	pulsedThreadWorkerPtr worker = (pulsedThreadWorkerPtr) workerData;
+	// timing is imp., so give thread high priority now, not when it gets a task
+	struct sched_param param ;
+	param.sched_priority = sched_get_priority_max (SCHED_RR) ;
+	pthread_setschedparam (pthread_self (), SCHED_RR, &param) ;
+	// a stack of configured size is painted, which also faults it in, else just fault in the part we expect to use
+	worker->stackLo = nullptr;
+	worker->stackHi = nullptr;
+	pthread_attr_t attr;
+	if ((worker->painted) && (pthread_getattr_np (pthread_self (), &attr) == 0)){
+		void * stackAddr;
+		size_t stackBytes;
+		pthread_attr_getstack (&attr, &stackAddr, &stackBytes);
+		pthread_attr_destroy (&attr);
+		worker->stackLo = (char *) stackAddr;
+		worker->stackHi = (char *) stackAddr + stackBytes;
+		paintStack (worker->stackLo);
+	}else{
+		prefaultStack ();
+	}
+	// cores we may run on, tasks pinned by the spin coordinator are put back to these when they are done
+	cpu_set_t poolCpus;
+	pthread_getaffinity_np (pthread_self (), sizeof (cpu_set_t), &poolCpus);
+	pthread_mutex_lock (&poolMutex);
+	for (;;){
+		while (worker->task == nullptr){
+			pthread_cond_wait (&worker->workVar, &poolMutex);
+		}
+		taskParams * theTask = worker->task;
+		pthread_mutex_unlock (&poolMutex);
+		pulsedThreadFunc ((void *) theTask);
+		pthread_setaffinity_np (pthread_self (), sizeof (cpu_set_t), &poolCpus);
+		if (worker->stackLo != nullptr){
+			checkStack (worker);
+		}
+		// tell the destructor, waiting on the task condition variable, that we are done. theTask may be gone after we unlock
+		pthread_mutex_lock (&theTask->taskMutex);
+		theTask->threadState = kTHREAD_DONE;
+		pthread_cond_broadcast (&theTask->taskVar);
+		pthread_mutex_unlock (&theTask->taskMutex);
+		// go back to the pool, or exit if pool is full
+		pthread_mutex_lock (&poolMutex);
+		worker->task = nullptr;
+		if (nIdle >= maxIdle){
+			pthread_mutex_unlock (&poolMutex);
+			pthread_cond_destroy (&worker->workVar);
+			delete worker;
+			return NULL;
+		}
+		worker->next = idleList;
+		idleList = worker;
+		nIdle +=1;
+	}
+	return NULL;
+}
+
+/* ****************************************************************************************************
+Makes a new detached pool pthread, called with pool mutex held. The new worker is not on the idle list
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadWorkerPtr pulsedThreadPool::makeWorker (void){
+	pulsedThreadWorkerPtr worker = new pulsedThreadWorker;
+	worker->task = nullptr;
+	worker->next = nullptr;
+	pthread_cond_init (&worker->workVar, NULL);
+	pthread_attr_t attr;
+	pthread_attr_init (&attr);
+	pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_DETACHED);
+	worker->painted = (stackSize != 0);
+	if (stackSize != 0){
+		pthread_attr_setstacksize (&attr, stackSize);
+		pthread_attr_setguardsize (&attr, guardSize);
+	}
+	int err = pthread_create (&worker->thread, &attr, &workerFunc, (void *) worker);
+	pthread_attr_destroy (&attr);
+	if (err){
+#if beVerbose
+		printf ("pulsedThreadPool could not create a pthread, error %d.\n", err);
+#endif
+		pthread_cond_destroy (&worker->workVar);
+		delete worker;
+		return nullptr;
+	}
+	return worker;
+}
+
+/* ****************************************************************************************************
+Makes pool pthreads until nThreads are idle, so later tasks do not pay for pthread_create
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadPool::prefill (unsigned int nThreads){
+	int nFailed =0;
+	pthread_mutex_lock (&poolMutex);
+	if (nThreads > maxIdle){
+		maxIdle = nThreads;
+	}
+	while (nIdle < nThreads){
+		pulsedThreadWorkerPtr worker = makeWorker ();
+		if (worker == nullptr){
+			nFailed = nThreads - nIdle;
+			break;
+		}
+		worker->next = idleList;
+		idleList = worker;
+		nIdle +=1;
+	}
+	pthread_mutex_unlock (&poolMutex);
+	return nFailed;
+}
+
+/* ****************************************************************************************************
+Sets number of idle pthreads kept when pthreads are given back. Idle pthreads above the new limit are not stopped
+until they have been borrowed and given back
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThreadPool::setMaxIdle (unsigned int newMaxIdle){
+	pthread_mutex_lock (&poolMutex);
+	maxIdle = newMaxIdle;
+	pthread_mutex_unlock (&poolMutex);
+}
+
+unsigned int pulsedThreadPool::getNumIdle (void){
+	pthread_mutex_lock (&poolMutex);
+	unsigned int returnVal = nIdle;
+	pthread_mutex_unlock (&poolMutex);
+	return returnVal;
+}
+
+/* ****************************************************************************************************
+Called by pulsedThread::startThread with the task mutex held. Hands the task to an idle pool pthread, or a new one
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadPool::runTask (taskParams * theTask){
+	pthread_mutex_lock (&poolMutex);
+	pulsedThreadWorkerPtr worker = idleList;
+	if (worker != nullptr){
+		idleList = worker->next;
+		nIdle -=1;
+	}else{
+		worker = makeWorker ();
+		if (worker == nullptr){
+			pthread_mutex_unlock (&poolMutex);
+			return 1;
+		}
+	}
+	theTask->taskThread = worker->thread;
+	theTask->threadState = kTHREAD_RUNNING;
+	worker->task = theTask;
+	pthread_cond_signal (&worker->workVar);
+	pthread_mutex_unlock (&poolMutex);
+	return 0;
+}
+
+/* ****************************************************************************************************
+Sets stack and guard size for pool pthreads made from now on. Pthreads already in the pool keep their stacks,
+so set this before prefill, or before making any pulsedThreads. stackSize of 0 gives the system default stack, not painted
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadPool::setStack (size_t newStackSize, size_t newGuardSize){
+	if ((newStackSize != 0) && (newStackSize < (size_t) PTHREAD_STACK_MIN)){
+#if beVerbose
+		printf ("setStack error: stack size %zu is less than PTHREAD_STACK_MIN, %zu.\n", newStackSize, (size_t) PTHREAD_STACK_MIN);
+#endif
+		return 1;
+	}
+	pthread_mutex_lock (&poolMutex);
+	stackSize = newStackSize;
+	guardSize = newGuardSize;
+	pthread_mutex_unlock (&poolMutex);
+	return 0;
+}
+
+size_t pulsedThreadPool::getStackSize (void){
+	pthread_mutex_lock (&poolMutex);
+	size_t returnVal = stackSize;
+	pthread_mutex_unlock (&poolMutex);
+	return returnVal;
+}
+
+size_t pulsedThreadPool::getMaxStackUsed (void){
+	pthread_mutex_lock (&poolMutex);
+	size_t returnVal = maxStackUsed;
+	pthread_mutex_unlock (&poolMutex);
+	return returnVal;
+}
@@ -0,0 +1,61 @@
+#ifndef PULSEDTHREADPOOL_H
+#define PULSEDTHREADPOOL_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadPool ***************************************************************
+A process-wide pool of pthreads that run pulsedThread tasks. A pulsedThread does not create a pthread in its constructor, it borrows
+one from the pool the first time a task, an arm, or a custom modification needs the pthread, and the destructor waits for the thread
+function to return and gives the pthread back to the pool. Pool pthreads are given SCHED_RR priority and fault in their stacks when
+they are made, so with a prefilled pool, making and destroying pulsedThreads for each trial of an experiment costs no pthread_create,
+no priority change, and no page faults. Pool pthreads above the idle limit exit when they are given back, so nothing leaks.
+
+Pool pthreads are made with a small stack, not the 8 MB default, so hundreds of them fit when memory is locked with mlockall. The stack
+is painted with a known byte when the pthread is made, and checked each time a task gives the pthread back, so getMaxStackUsed reports
+the deepest stack any task has used. Run StackCheck (stackCheck.cpp) after changing the thread function, or with your own hi, lo, and
+end functions, to confirm the stack size is safe.
+Last Modified:
+2026/10/19 - added configurable stack and guard size, and stack high-water mark
+2026/10/19 - initial version */
+
+extern "C" void* pulsedThreadFunc (void * tData); // the thread function, in pulsedThread.cpp
+
+const unsigned int kPOOL_MAX_IDLE = 32;		// default number of idle pthreads kept in the pool
+const unsigned int kPOOL_PREFAULT = 16384;	// bytes of stack each pool pthread faults in when it is made, if stack size is system default
+const size_t kPOOL_STACK_SIZE = 131072;		// default stack size. StackCheck measures about 8 kB for thread loop and bundled endFuncs, the rest is headroom for hi, lo, and end functions, e.g., Python callbacks
+const size_t kPOOL_GUARD_SIZE = 4096;		// default size of guard area below the stack
+const unsigned char kPOOL_STACK_PAINT = 0xA5;	// byte painted on unused stack to measure high-water mark
+
+/* ********************************************** a pool pthread and its assignment *************************************************/
+typedef struct pulsedThreadWorker{
+	pthread_t thread;
+	taskParams * task;				// task to run, nullptr when idle
+	pthread_cond_t workVar;			// signalled, with pool mutex, when the worker is given a task
+	bool painted;					// true if stack is of configured size, and is painted to measure use
+	char * stackLo;					// lowest address of usable stack, nullptr if stack is not painted
+	char * stackHi;					// highest address of usable stack
+	struct pulsedThreadWorker * next;	// next idle worker
+}pulsedThreadWorker, *pulsedThreadWorkerPtr;
+
+class pulsedThreadPool{
+	public:
+		static int prefill (unsigned int nThreads); // makes pool pthreads until there are nThreads idle, returns number that could not be made
+		static void setMaxIdle (unsigned int maxIdle); // number of idle pthreads kept in the pool when tasks give pthreads back
+		static unsigned int getNumIdle (void); // number of pthreads waiting in the pool
+		static int runTask (taskParams * theTask); // runs thread function for theTask on an idle pthread, or a new one if none are idle. Returns 0 for success
+		static int setStack (size_t stackSize, size_t guardSize); // for pthreads made from now on, stackSize 0 for system default. Returns 1 if stackSize is too small
+		static size_t getStackSize (void); // stack size for new pthreads, 0 if system default
+		static size_t getMaxStackUsed (void); // deepest stack use of any task run on a pthread with a painted stack, in bytes
+	private:
+		static void * workerFunc (void * workerData); // thread function of pool pthreads
+		static pulsedThreadWorkerPtr makeWorker (void); // called with pool mutex held, makes a new pool pthread, or returns nullptr
+		static void checkStack (pulsedThreadWorkerPtr worker); // updates maxStackUsed from worker's stack, and paints the used part again
+		static pthread_mutex_t poolMutex;
+		static pulsedThreadWorkerPtr idleList;
+		static unsigned int nIdle;
+		static unsigned int maxIdle;
+		static size_t stackSize;
+		static size_t guardSize;
+		static size_t maxStackUsed;
+};
+
+#endif // PULSEDTHREADPOOL_H
@@ -0,0 +1,218 @@
+#include "pulsedThreadRamp.h"
+
+/* ***************** table of powers of 2 from 2^0 to 2^1, in 31 bit fixed point, filled before main runs ***********************/
+static uint64_t rampExp2Table [(1 << kRAMP_TABLE_BITS) + 1];
+
+static struct rampExp2TableInit{
+	rampExp2TableInit (void){
+		for (int iEntry =0; iEntry <= (1 << kRAMP_TABLE_BITS); iEntry +=1){
+			rampExp2Table [iEntry] = (uint64_t) round (pow (2.0, 31.0 + (double) iEntry / (1 << kRAMP_TABLE_BITS)));
+		}
+	}
+}rampExp2TableInitializer;
+
+/* ***************************** 2 to the power of x, x in kRAMP_LOG_BITS fixed point, interpolating between table entries ************/
+static inline uint64_t rampExp2 (int64_t x){
+	unsigned int wholePart = (unsigned int)(x >> kRAMP_LOG_BITS);
+	uint64_t fracPart = x & ((1 << kRAMP_LOG_BITS) - 1);
+	unsigned int iEntry = fracPart >> (kRAMP_LOG_BITS - kRAMP_TABLE_BITS);
+	uint64_t remainder = fracPart & ((1 << (kRAMP_LOG_BITS - kRAMP_TABLE_BITS)) - 1);
+	uint64_t mantissa = rampExp2Table [iEntry] + (((rampExp2Table [iEntry + 1] - rampExp2Table [iEntry]) * remainder) >> (kRAMP_LOG_BITS - kRAMP_TABLE_BITS));
+	return (wholePart >= 31) ? (mantissa << (wholePart - 31)) : (mantissa >> (31 - wholePart));
+}
+
+/* ***************************** value of a linear term at time tUsecs from start of sweep ***************************************/
+static inline int64_t rampTermValue (pulsedThreadRampTermPtr term, uint64_t tUsecs){
+	int64_t change = (int64_t)((term->slopeMag * tUsecs) >> term->shift);
+	return (term->isNeg) ? term->start - change : term->start + change;
+}
+
+/* ************************** sets up a term going from startVal to endVal in rampUsecs, called by setRamp ***********************/
+static void rampSetTerm (int64_t startVal, int64_t endVal, uint64_t rampUsecs, pulsedThreadRampTermPtr term){
+	term->start = startVal;
+	term->isNeg = (endVal < startVal);
+	uint64_t mag = (term->isNeg) ? startVal - endVal : endVal - startVal;
+	term->shift = 0;
+	while ((term->shift < 32) && ((mag >> (61 - term->shift)) == 0)){
+		term->shift +=1;
+	}
+	term->slopeMag = (mag << term->shift) / rampUsecs;
+}
+
+/* **************************** copies a new sweep for the thread if setRamp has been called *********************************/
+static inline bool rampTakeChanges (taskParams * theTask, pulsedThreadRampStructPtr ramp){
+	if (!ramp->changed.load (std::memory_order_relaxed)){
+		return false;
+	}
+	pthread_mutex_lock (&theTask->taskMutex);
+	ramp->running = ramp->config;
+	ramp->changed.store (0);
+	pthread_mutex_unlock (&theTask->taskMutex);
+	return true;
+}
+
+/* ****************************************************************************************************
+Pattern function for ramp tasks. Works out period and duty cycle of each pulse from the time of its start, counted from start of the sweep, and
+waits until the start and end of each pulse, counted from start of the task
+Last Modified:
+2026/10/19 - stores period and pulse count with relaxed atomics
+2026/10/19 - initial version */
+void pulsedThreadRampPattern (taskParams * theTask, pulsedThreadTimers * timers){
+	pulsedThreadRampStructPtr ramp = (pulsedThreadRampStructPtr) theTask->patternData;
+	pulsedThreadRampConfigPtr config = &ramp->running;
+	bool isInfinite = (theTask->nPulses == kINFINITETRAIN);
+	struct timeval startTime;
+	struct timeval deadline;
+	pulsedThreadGetTime (theTask, &startTime);
+	uint64_t sweepQ16 = 0; // start of current sweep, from start of task, in 1/65536 microseconds
+	uint64_t pulseQ16 = 0; // start of current pulse, from start of sweep
+	uint64_t periodQ16;
+	uint64_t durQ16;
+	uint64_t tUsecs;
+	rampTakeChanges (theTask, ramp);
+	for (;;){
+		if (theTask->killThread){
+			return;
+		}
+		if (isInfinite){
+			if (!(theTask->doTask & 1)){
+				return;
+			}
+			pulsedThreadPatternMods (theTask, timers);
+		}
+		tUsecs = pulseQ16 >> 16;
+		if (tUsecs >= config->rampUsecs){
+			if (!isInfinite){
+				pulsedThreadDeadline (&startTime, pulseQ16 >> 16, &deadline);
+				pulsedThreadWaitUntil (theTask, timers, &deadline);
+				pulsedThreadEndFunc (theTask);
+				return;
+			}
+			if (config->endMode == kRAMP_REPEAT){
+				pulsedThreadEndFunc (theTask);
+				sweepQ16 += pulseQ16;
+				pulseQ16 = 0;
+				tUsecs = 0;
+				rampTakeChanges (theTask, ramp);
+			}else{
+				// holding at end values, a new sweep starts now
+				if (rampTakeChanges (theTask, ramp)){
+					sweepQ16 += pulseQ16;
+					pulseQ16 = 0;
+					tUsecs = 0;
+				}else{
+					tUsecs = config->rampUsecs;
+				}
+			}
+		}
+		if (config->shape == kRAMP_EXPONENTIAL){
+			periodQ16 = rampExp2 (rampTermValue (&config->freq, tUsecs) + ((int64_t)16 << kRAMP_LOG_BITS));
+		}else{
+			periodQ16 = ((uint64_t)1000000 << 32) / (uint64_t)rampTermValue (&config->freq, tUsecs);
+		}
+		durQ16 = (periodQ16 * (uint64_t)rampTermValue (&config->duty, tUsecs)) >> 16;
+		pulsedThreadDeadline (&startTime, (sweepQ16 + pulseQ16) >> 16, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+		pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+		theTask->hiFunc (theTask->taskData);
+		// a duty cycle of 1 has no low edge, as for a train with no delay
+		if (durQ16 < periodQ16){
+			pulsedThreadDeadline (&startTime, (sweepQ16 + pulseQ16 + durQ16) >> 16, &deadline);
+			pulsedThreadWaitUntil (theTask, timers, &deadline);
+			pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+			theTask->loFunc (theTask->taskData);
+		}
+		ramp->periodQ16.store (periodQ16, std::memory_order_relaxed);
+		ramp->nPulses.store (ramp->nPulses.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		pulseQ16 += periodQ16;
+	}
+}
+
+/* ****************************************************************************************************
+Constructor makes a pulsedThread with the pulse timing of the start of the sweep, for getters, and installs the pattern function
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadRamp::pulsedThreadRamp (unsigned int gMode, int shape, float startFreq, float endFreq, float startDuty, float endDuty, float rampSecs, int endMode, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode) :
+	pulsedThread ((unsigned int) 0, (unsigned int) 1, (gMode == kINFINITETRAIN) ? (unsigned int) kINFINITETRAIN : (unsigned int) kPULSE, initData, initFunc, gLoFunc, gHiFunc, gAccLevel, errCode){
+	rampData.changed.store (0);
+	rampData.periodQ16.store (0);
+	rampData.nPulses.store (0);
+	if (errCode){
+		return;
+	}
+	if (((gMode != kPULSE) && (gMode != kINFINITETRAIN)) || (gHiFunc == nullptr) || (gLoFunc == nullptr) || (setRamp (shape, startFreq, endFreq, startDuty, endDuty, rampSecs, endMode))){
+#if beVerbose
+		printf ("pulsedThreadRamp error: mode %d, needs hi and lo functions and a sweep in range.\n", gMode);
+#endif
+		errCode = 1;
+		return;
+	}
+	theTask.patternData = &rampData;
+	theTask.patternFunc = &pulsedThreadRampPattern;
+}
+
+/* ****************************************************************************************************
+Destructor stops the thread, as the pattern function uses rampData, which is gone once this destructor returns, before ~pulsedThread stops it
+Last Modified:
+2026/10/19 - stops the thread with stopThread
+2026/10/19 - initial version */
+pulsedThreadRamp::~pulsedThreadRamp (void){
+	stopThread ();
+}
+
+/* ****************************************************************************************************
+Converts a sweep to fixed point, on the calling thread, and gives it to the thread for the start of the next task or sweep
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadRamp::setRamp (int shape, float startFreq, float endFreq, float startDuty, float endDuty, float rampSecs, int endMode){
+	if (((shape != kRAMP_LINEAR) && (shape != kRAMP_EXPONENTIAL)) || ((endMode != kRAMP_REPEAT) && (endMode != kRAMP_HOLD)) ||
+	(startFreq < kRAMP_MIN_FREQ) || (startFreq > kRAMP_MAX_FREQ) || (endFreq < kRAMP_MIN_FREQ) || (endFreq > kRAMP_MAX_FREQ) ||
+	(startDuty <= 0) || (startDuty > 1) || (endDuty <= 0) || (endDuty > 1) || (rampSecs * 1e06 < 1)){
+#if beVerbose
+		printf ("setRamp error: shape = %d, frequency %.2f to %.2f Hz, duty cycle %.2f to %.2f, over %.2f seconds, end mode %d.\n", shape, startFreq, endFreq, startDuty, endDuty, rampSecs, endMode);
+#endif
+		return 1;
+	}
+	pulsedThreadRampConfig newConfig;
+	newConfig.shape = shape;
+	newConfig.endMode = endMode;
+	newConfig.rampUsecs = (uint64_t) round (rampSecs * 1e06);
+	if (shape == kRAMP_EXPONENTIAL){
+		rampSetTerm ((int64_t) round (log2 (1e06 / startFreq) * (1 << kRAMP_LOG_BITS)), (int64_t) round (log2 (1e06 / endFreq) * (1 << kRAMP_LOG_BITS)), newConfig.rampUsecs, &newConfig.freq);
+	}else{
+		rampSetTerm ((int64_t) round (startFreq * 65536), (int64_t) round (endFreq * 65536), newConfig.rampUsecs, &newConfig.freq);
+	}
+	rampSetTerm ((int64_t) round (startDuty * 65536), (int64_t) round (endDuty * 65536), newConfig.rampUsecs, &newConfig.duty);
+	newConfig.startFreq = startFreq;
+	newConfig.endFreq = endFreq;
+	newConfig.startDuty = startDuty;
+	newConfig.endDuty = endDuty;
+	unsigned int startDelay = 0;
+	unsigned int startDur = 0;
+	unsigned int startPulses = 0;
+	times2TicksVals (startFreq, startDuty, 0, startDelay, startDur, startPulses);
+	pthread_mutex_lock (&theTask.taskMutex);
+	rampData.config = newConfig;
+	rampData.changed.store (1);
+	// keep pulse timing of the task the same as start of sweep, for getters
+	theTask.pulseDelayUsecs = startDelay;
+	theTask.pulseDurUsecs = startDur;
+	ticks2Times (startDelay, startDur, theTask.nPulses, theTask);
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+void pulsedThreadRamp::getRamp (pulsedThreadRampConfig & config){
+	pthread_mutex_lock (&theTask.taskMutex);
+	config = rampData.config;
+	pthread_mutex_unlock (&theTask.taskMutex);
+}
+
+float pulsedThreadRamp::getRampFrequency (void){
+	uint64_t periodQ16 = rampData.periodQ16.load (std::memory_order_relaxed);
+	return (periodQ16 == 0) ? 0 : 65536e06 / periodQ16;
+}
+
+uint64_t pulsedThreadRamp::getNumPulses (void){
+	return rampData.nPulses.load (std::memory_order_relaxed);
+}
@@ -0,0 +1,76 @@
+#ifndef PULSEDTHREADRAMP_H
+#define PULSEDTHREADRAMP_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadRamp ***************************************************************
+A pulsedThread that sweeps frequency and duty cycle from start values to end values over a set time, e.g., a chirp, with no array and no endFunc.
+Frequency changes linearly or exponentially with time, and duty cycle changes linearly with time. The thread works out each pulse from the time
+of its start, with integer fixed point arithmetic: times are kept in 1/65536 microseconds, so pulse times do not drift, linear terms are a multiply
+and a shift, and exponential frequency is done in the log2 domain, with a 256 entry table for powers of 2, so it takes no divide at all. A linear
+frequency sweep takes one integer divide per pulse, to get period from frequency. Nothing is reconfigured, and no floating point is used, on the thread.
+
+A pulsedThreadRamp made with kPULSE does one sweep for each task requested with DoTask/DoTasks. The task ends at the end of the period of the last
+pulse that starts before the end of the sweep, and the endFunc runs at the end of the task. A pulsedThreadRamp made with kINFINITETRAIN sweeps from
+startInfiniteTrain, and then, with kRAMP_REPEAT, starts the sweep again, running the endFunc after each sweep, or, with kRAMP_HOLD, keeps making
+pulses at the end values until stopInfiniteTrain. A new sweep set with setRamp is used from the start of the next task or sweep.
+Last Modified:
+2026/10/19 - periodQ16 and nPulses are relaxed atomics, as they are read while the thread runs
+2026/10/19 - initial version */
+
+const int kRAMP_LINEAR = 0;			// frequency changes linearly with time
+const int kRAMP_EXPONENTIAL = 1;	// frequency changes by the same ratio in equal times
+const int kRAMP_REPEAT = 0;			// infinite train starts the sweep again after it ends
+const int kRAMP_HOLD = 1;			// infinite train stays at end values after sweep ends
+const float kRAMP_MIN_FREQ = 0.01;	// lowest frequency, in Hz, at start or end of a sweep
+const float kRAMP_MAX_FREQ = 250000;// highest frequency, in Hz, at start or end of a sweep
+const int kRAMP_LOG_BITS = 24;		// fractional bits of log2 frequency for exponential sweeps
+const int kRAMP_TABLE_BITS = 8;		// log2 of number of entries in table of powers of 2
+
+/* ************************ a value that changes linearly with time, start + slope * t, in fixed point ******************************
+slopeMag is the magnitude of the change per microsecond, shifted left by shift bits, with shift chosen as large as it can be without slopeMag
+times the sweep time overflowing 64 bits */
+typedef struct pulsedThreadRampTerm{
+	int64_t start;		// value at time 0
+	uint64_t slopeMag;	// magnitude of slope, << shift
+	int isNeg;			// 1 if value decreases with time
+	unsigned int shift;
+}pulsedThreadRampTerm, *pulsedThreadRampTermPtr;
+
+/* ****************************************** a sweep, in fixed point, ready for the thread *****************************************/
+typedef struct pulsedThreadRampConfig{
+	int shape;					// kRAMP_LINEAR or kRAMP_EXPONENTIAL
+	int endMode;				// kRAMP_REPEAT or kRAMP_HOLD
+	uint64_t rampUsecs;			// length of sweep, in microseconds
+	pulsedThreadRampTerm freq;	// frequency in 1/65536 Hz for linear sweeps, log2 of period in microseconds in kRAMP_LOG_BITS fixed point for exponential sweeps
+	pulsedThreadRampTerm duty;	// duty cycle, in 1/65536
+	float startFreq;			// values as set, for getters
+	float endFreq;
+	float startDuty;
+	float endDuty;
+}pulsedThreadRampConfig, *pulsedThreadRampConfigPtr;
+
+/* ******************************** pattern data for a ramp task ***************************************************/
+typedef struct pulsedThreadRampStruct{
+	pulsedThreadRampConfig config;	// written by setRamp with mutex held
+	std::atomic<int> changed;		// 1 if config was changed since the thread last copied it
+	pulsedThreadRampConfig running;	// thread's copy of config
+	std::atomic<uint64_t> periodQ16;	// period of most recent pulse, in 1/65536 microseconds, written by the thread, read by getRampFrequency
+	std::atomic<uint64_t> nPulses;		// number of pulses made, written by the thread, read by getNumPulses
+}pulsedThreadRampStruct, *pulsedThreadRampStructPtr;
+
+void pulsedThreadRampPattern (taskParams * theTask, pulsedThreadTimers * timers); // the pattern function
+
+class pulsedThreadRamp : public pulsedThread{
+	public:
+		/* gMode is kPULSE or kINFINITETRAIN, frequencies in Hz, duty cycles > 0 and <= 1, rampSecs > 0 */
+		pulsedThreadRamp (unsigned int gMode, int shape, float startFreq, float endFreq, float startDuty, float endDuty, float rampSecs, int endMode, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode);
+		~pulsedThreadRamp (void);
+		int setRamp (int shape, float startFreq, float endFreq, float startDuty, float endDuty, float rampSecs, int endMode); // returns 1 if values are out of range
+		void getRamp (pulsedThreadRampConfig & config); // copies the sweep
+		float getRampFrequency (void); // frequency of most recent pulse, in Hz
+		uint64_t getNumPulses (void); // number of pulses made since thread was made
+	protected:
+		pulsedThreadRampStruct rampData;
+};
+
+#endif // PULSEDTHREADRAMP_H
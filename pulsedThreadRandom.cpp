@@ -0,0 +1,234 @@
+#include "pulsedThreadRandom.h"
+
+/* ****************************************************************************************************
+Draws an interval from a distribution, using random numbers from count on, clamped to the bounds of the distribution
+Last Modified:
+2026/10/19 - initial version */
+unsigned int pulsedThreadRandom::drawUsecs (const pulsedThreadRandomDist & dist, uint64_t seed, uint64_t count){
+	switch (dist.dist){
+		case kRAND_UNIFORM:{
+			uint64_t range = (uint64_t)(dist.maxUsecs - dist.minUsecs) + 1;
+			return dist.minUsecs + (unsigned int)(((pulsedThreadRandom64 (seed, count) >> 32) * range) >> 32);
+		}
+		case kRAND_EXPONENTIAL:
+		case kRAND_GAMMA:{
+			// sum of shape exponentials, each with mean meanUsecs/shape, from uniform numbers in (0,1]
+			unsigned int shape = (dist.dist == kRAND_EXPONENTIAL) ? 1 : dist.shape;
+			double sum = 0;
+			for (unsigned int iShape =0; iShape < shape; iShape +=1){
+				sum -= log (((pulsedThreadRandom64 (seed, count + iShape) >> 11) + 1) * (1.0 / 9007199254740992.0));
+			}
+			double usecs = sum * dist.meanUsecs / shape;
+			if (usecs <= dist.minUsecs){
+				return dist.minUsecs;
+			}
+			if (usecs >= dist.maxUsecs){
+				return dist.maxUsecs;
+			}
+			return (unsigned int)(usecs + 0.5);
+		}
+		default: // kRAND_FIXED
+			return dist.meanUsecs;
+	}
+}
+
+/* ****************************************************************************************************
+Checks a distribution has bounds in order and a mean inside them, and can not give an interval shorter than leastUsecs
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadRandom::checkDist (const pulsedThreadRandomDist & dist, unsigned int leastUsecs){
+	int isBad;
+	switch (dist.dist){
+		case kRAND_FIXED:
+			isBad = (dist.meanUsecs < leastUsecs);
+			break;
+		case kRAND_UNIFORM:
+			isBad = ((dist.minUsecs < leastUsecs) || (dist.maxUsecs < dist.minUsecs));
+			break;
+		case kRAND_EXPONENTIAL:
+		case kRAND_GAMMA:
+			isBad = ((dist.minUsecs < leastUsecs) || (dist.maxUsecs < dist.minUsecs) || (dist.meanUsecs < dist.minUsecs) || (dist.meanUsecs > dist.maxUsecs) ||
+			((dist.dist == kRAND_GAMMA) && ((dist.shape == 0) || (dist.shape > kRAND_MAX_SHAPE))));
+			break;
+		default:
+			isBad = 1;
+			break;
+	}
+#if beVerbose
+	if (isBad){
+		printf ("checkDist error: distribution %d, mean = %d, min = %d, max = %d, shape = %d.\n", dist.dist, dist.meanUsecs, dist.minUsecs, dist.maxUsecs, dist.shape);
+	}
+#endif
+	return isBad;
+}
+
+/* **************************** copies new distributions and seed for the thread, at the start of a task *********************************/
+static inline void randomTakeChanges (taskParams * theTask, pulsedThreadRandomStructPtr random){
+	if (!random->changed.load (std::memory_order_relaxed)){
+		return;
+	}
+	pthread_mutex_lock (&theTask->taskMutex);
+	random->running = random->config;
+	if (random->config.reseed){
+		random->pulseNum.store (0, std::memory_order_relaxed);
+		random->config.reseed = 0;
+	}
+	random->changed.store (0);
+	pthread_mutex_unlock (&theTask->taskMutex);
+}
+
+/* ****************************************************************************************************
+Pattern function for random tasks. Draws duration and delay of each pulse, writes them to the interval buffer, if there is one, and waits until the
+start and end of the pulse, counted from start of the task
+Last Modified:
+2026/10/19 - counts pulses with a relaxed atomic
+2026/10/19 - initial version */
+void pulsedThreadRandomPattern (taskParams * theTask, pulsedThreadTimers * timers){
+	pulsedThreadRandomStructPtr random = (pulsedThreadRandomStructPtr) theTask->patternData;
+	pulsedThreadRandomConfigPtr config = &random->running;
+	bool isInfinite = (theTask->nPulses == kINFINITETRAIN);
+	randomTakeChanges (theTask, random);
+	struct timeval startTime;
+	struct timeval deadline;
+	pulsedThreadGetTime (theTask, &startTime);
+	uint64_t pulseUsecs = 0; // start of pulse, from start of task
+	unsigned int durUsecs;
+	unsigned int delayUsecs;
+	for (unsigned int iPulse =0; (isInfinite) || (iPulse < config->nPulses); iPulse +=1){
+		if (theTask->killThread){
+			return;
+		}
+		if (isInfinite){
+			if (!(theTask->doTask & 1)){
+				return;
+			}
+			pulsedThreadPatternMods (theTask, timers);
+		}
+		uint64_t pulseNum = random->pulseNum.load (std::memory_order_relaxed);
+		durUsecs = pulsedThreadRandom::drawUsecs (config->dur, config->seed, (2 * pulseNum) * kRAND_MAX_SHAPE);
+		delayUsecs = pulsedThreadRandom::drawUsecs (config->delay, config->seed, (2 * pulseNum + 1) * kRAND_MAX_SHAPE);
+		if (random->buffer != nullptr){
+			uint64_t nIntervals = random->nIntervals.load (std::memory_order_relaxed);
+			random->buffer [nIntervals % random->bufferSize] = {durUsecs, delayUsecs};
+			random->nIntervals.store (nIntervals + 1, std::memory_order_release);
+		}
+		random->pulseNum.store (pulseNum + 1, std::memory_order_relaxed);
+		pulsedThreadDeadline (&startTime, pulseUsecs, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+		pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+		theTask->hiFunc (theTask->taskData);
+		pulsedThreadDeadline (&startTime, pulseUsecs + durUsecs, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+		pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+		theTask->loFunc (theTask->taskData);
+		pulseUsecs += (uint64_t)durUsecs + delayUsecs;
+		if (isInfinite){
+			pulsedThreadEndFunc (theTask);
+		}
+	}
+	// wait out the last delay, as a train does
+	pulsedThreadDeadline (&startTime, pulseUsecs, &deadline);
+	pulsedThreadWaitUntil (theTask, timers, &deadline);
+	pulsedThreadEndFunc (theTask);
+}
+
+/* ****************************************************************************************************
+Constructor makes a pulsedThread with the mean pulse timing, for getters, and installs the pattern function
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadRandom::pulsedThreadRandom (unsigned int gPulses, const pulsedThreadRandomDist & delayDist, const pulsedThreadRandomDist & durDist, uint64_t seed, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode) :
+	pulsedThread ((unsigned int) 0, (unsigned int) 1, (gPulses == kINFINITETRAIN) ? (unsigned int) kINFINITETRAIN : (unsigned int) kPULSE, initData, initFunc, gLoFunc, gHiFunc, gAccLevel, errCode){
+	randomData.changed.store (0);
+	randomData.pulseNum.store (0);
+	randomData.buffer = nullptr;
+	randomData.bufferSize = 0;
+	randomData.nIntervals.store (0);
+	randomData.config.nPulses = gPulses;
+	randomData.config.seed = seed;
+	randomData.config.reseed = 1;
+	if (errCode){
+		return;
+	}
+	if ((gHiFunc == nullptr) || (gLoFunc == nullptr) || (setDists (delayDist, durDist))){
+#if beVerbose
+		printf ("pulsedThreadRandom error: needs hi and lo functions and good distributions.\n");
+#endif
+		errCode = 1;
+		return;
+	}
+	theTask.patternData = &randomData;
+	theTask.patternFunc = &pulsedThreadRandomPattern;
+}
+
+/* ****************************************************************************************************
+Destructor stops the thread, as the pattern function uses randomData, which is gone once this destructor returns, before ~pulsedThread stops it
+Last Modified:
+2026/10/19 - stops the thread with stopThread
+2026/10/19 - initial version */
+pulsedThreadRandom::~pulsedThreadRandom (void){
+	stopThread ();
+}
+
+/* ****************************************************************************************************
+Sets new distributions, used from start of next task
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadRandom::setDists (const pulsedThreadRandomDist & delayDist, const pulsedThreadRandomDist & durDist){
+	if ((checkDist (delayDist, 0)) || (checkDist (durDist, 1))){
+		return 1;
+	}
+	pthread_mutex_lock (&theTask.taskMutex);
+	randomData.config.delay = delayDist;
+	randomData.config.dur = durDist;
+	randomData.changed.store (1);
+	// keep pulse timing of the task the same as the means, for getters
+	theTask.pulseDelayUsecs = (delayDist.dist == kRAND_UNIFORM) ? (delayDist.minUsecs + delayDist.maxUsecs)/2 : delayDist.meanUsecs;
+	theTask.pulseDurUsecs = (durDist.dist == kRAND_UNIFORM) ? (durDist.minUsecs + durDist.maxUsecs)/2 : durDist.meanUsecs;
+	ticks2Times (theTask.pulseDelayUsecs, theTask.pulseDurUsecs, theTask.nPulses, theTask);
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+void pulsedThreadRandom::setSeed (uint64_t seed){
+	pthread_mutex_lock (&theTask.taskMutex);
+	randomData.config.seed = seed;
+	randomData.config.reseed = 1;
+	randomData.changed.store (1);
+	pthread_mutex_unlock (&theTask.taskMutex);
+}
+
+/* ****************************************************************************************************
+Sets the ring buffer the thread writes realized intervals to, only when thread is not busy or armed, as the thread writes to it at every pulse
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadRandom::setIntervalBuffer (pulsedThreadIntervalPtr buffer, unsigned int bufferSize){
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+#if beVerbose
+		printf ("setIntervalBuffer error: buffer can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	randomData.buffer = (bufferSize > 0) ? buffer : nullptr;
+	randomData.bufferSize = bufferSize;
+	randomData.nIntervals.store (0);
+	pthread_mutex_unlock (&theTask.taskMutex);
+	return 0;
+}
+
+uint64_t pulsedThreadRandom::getNumIntervals (void){
+	return randomData.nIntervals.load (std::memory_order_acquire);
+}
+
+void pulsedThreadRandom::getInterval (uint64_t pulseNum, pulsedThreadInterval & interval){
+	pthread_mutex_lock (&theTask.taskMutex);
+	pulsedThreadRandomConfig config = randomData.config;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	interval.durUsecs = drawUsecs (config.dur, config.seed, (2 * pulseNum) * kRAND_MAX_SHAPE);
+	interval.delayUsecs = drawUsecs (config.delay, config.seed, (2 * pulseNum + 1) * kRAND_MAX_SHAPE);
+}
+
+uint64_t pulsedThreadRandom::getPulseNum (void){
+	return randomData.pulseNum.load (std::memory_order_relaxed);
+}
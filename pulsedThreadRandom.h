@@ -0,0 +1,92 @@
+#ifndef PULSEDTHREADRANDOM_H
+#define PULSEDTHREADRANDOM_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadRandom ***************************************************************
+A pulsedThread that makes trains with random pulse durations and/or delays, e.g., Poisson stimuli, drawn by the thread for each pulse from a set
+distribution. Like a train, each pulse calls hiFunc, waits for its duration, calls loFunc, and waits for its delay, and pulse times are counted from
+the start of the task, so they do not drift with time spent drawing numbers or in the hi and lo functions.
+
+Random numbers come from a counter-based generator: the n-th number for a seed is a hash of the seed and n, with no state to keep. The duration of
+pulse i is drawn from the numbers starting at 2i * kRAND_MAX_SHAPE, and the delay from (2i + 1) * kRAND_MAX_SHAPE, so the intervals of a run are fixed
+by its seed, and getInterval can work out the interval of any pulse of a run without the thread. Pulses are numbered from the last setSeed, across
+tasks, so repeated tasks get new intervals, and a run can be repeated exactly by setting the same seed again. Realized intervals are also written,
+as the thread makes them, to a ring buffer given by the caller with setIntervalBuffer, so no memory is allocated on the thread.
+
+A pulsedThreadRandom made with a number of pulses makes that many pulses for each task requested with DoTask/DoTasks, waits the delay after the last
+pulse, and runs the endFunc at the end of the task. Made with kINFINITETRAIN, it makes pulses from startInfiniteTrain until stopInfiniteTrain, and
+runs the endFunc after each pulse. New distributions and seeds set while a task is running are used from the start of the next task
+Last Modified:
+2026/10/19 - pulseNum is a relaxed atomic, as getPulseNum reads it while the thread runs
+2026/10/19 - initial version */
+
+const int kRAND_FIXED = 0;			// always meanUsecs
+const int kRAND_UNIFORM = 1;		// uniform from minUsecs to maxUsecs
+const int kRAND_EXPONENTIAL = 2;	// exponential with mean meanUsecs, clamped to minUsecs and maxUsecs, for Poisson processes
+const int kRAND_GAMMA = 3;			// gamma with integer shape and mean meanUsecs, clamped to minUsecs and maxUsecs, less variable than exponential
+const unsigned int kRAND_MAX_SHAPE = 16;	// largest shape for gamma distributions
+const uint64_t kRAND_GOLDEN = 0x9E3779B97F4A7C15ULL; // counter increment of splitmix64
+
+/* ******************************************* a distribution of intervals ****************************************************************/
+typedef struct pulsedThreadRandomDist{
+	int dist;				// kRAND_FIXED, kRAND_UNIFORM, kRAND_EXPONENTIAL, or kRAND_GAMMA
+	unsigned int meanUsecs;	// mean interval, for fixed, exponential, and gamma
+	unsigned int minUsecs;	// shortest interval, for uniform, or intervals are clamped to it
+	unsigned int maxUsecs;	// longest interval, for uniform, or intervals are clamped to it
+	unsigned int shape;		// shape of gamma distribution, 1 to kRAND_MAX_SHAPE. 1 is the same as exponential
+}pulsedThreadRandomDist, *pulsedThreadRandomDistPtr;
+
+/* ******************************************* a realized interval ****************************************************************/
+typedef struct pulsedThreadInterval{
+	uint32_t durUsecs;		// high time of the pulse
+	uint32_t delayUsecs;	// low time after the pulse
+}pulsedThreadInterval, *pulsedThreadIntervalPtr;
+
+/* ****************************************** the random pulse set up *************************************************************/
+typedef struct pulsedThreadRandomConfig{
+	unsigned int nPulses;			// pulses per task, unused for kINFINITETRAIN
+	pulsedThreadRandomDist delay;
+	pulsedThreadRandomDist dur;
+	uint64_t seed;
+	int reseed;						// 1 if pulse count is to start again from 0 at start of next task
+}pulsedThreadRandomConfig, *pulsedThreadRandomConfigPtr;
+
+/* ******************************** pattern data for a random task ***************************************************/
+typedef struct pulsedThreadRandomStruct{
+	pulsedThreadRandomConfig config;	// written by calling thread with mutex held
+	std::atomic<int> changed;			// 1 if config was changed since the thread last copied it
+	pulsedThreadRandomConfig running;	// thread's copy of config
+	std::atomic<uint64_t> pulseNum;	// number of next pulse, from last setSeed, written by the thread, read by getPulseNum
+	pulsedThreadIntervalPtr buffer;		// ring buffer for realized intervals, or nullptr
+	unsigned int bufferSize;
+	std::atomic<uint64_t> nIntervals;	// number of intervals written to buffer, interval n is at buffer [n % bufferSize]
+}pulsedThreadRandomStruct, *pulsedThreadRandomStructPtr;
+
+/* ******************************* counter-based random number, the splitmix64 hash of seed and count *********************************/
+inline uint64_t pulsedThreadRandom64 (uint64_t seed, uint64_t count){
+	uint64_t z = seed + (count + 1) * kRAND_GOLDEN;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+void pulsedThreadRandomPattern (taskParams * theTask, pulsedThreadTimers * timers); // the pattern function
+
+class pulsedThreadRandom : public pulsedThread{
+	public:
+		/* gPulses is pulses per task, or kINFINITETRAIN */
+		pulsedThreadRandom (unsigned int gPulses, const pulsedThreadRandomDist & delayDist, const pulsedThreadRandomDist & durDist, uint64_t seed, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), int gAccLevel, int &errCode);
+		~pulsedThreadRandom (void);
+		int setDists (const pulsedThreadRandomDist & delayDist, const pulsedThreadRandomDist & durDist); // returns 1 if a distribution is not ok, duration must be at least 1
+		void setSeed (uint64_t seed); // pulses are numbered from 0 again from start of next task
+		int setIntervalBuffer (pulsedThreadIntervalPtr buffer, unsigned int bufferSize); // buffer for realized intervals, or nullptr. Returns 1 if thread is busy or armed
+		uint64_t getNumIntervals (void); // number of intervals written to the buffer, the last bufferSize of them are still there
+		void getInterval (uint64_t pulseNum, pulsedThreadInterval & interval); // works out the interval of a pulse from current seed and distributions
+		uint64_t getPulseNum (void); // number of pulses made since last seed was used
+		static int checkDist (const pulsedThreadRandomDist & dist, unsigned int leastUsecs); // returns 1 if distribution is not ok, or could give less than leastUsecs
+		static unsigned int drawUsecs (const pulsedThreadRandomDist & dist, uint64_t seed, uint64_t count); // draws an interval using numbers from count on
+	protected:
+		pulsedThreadRandomStruct randomData;
+};
+
+#endif // PULSEDTHREADRANDOM_H
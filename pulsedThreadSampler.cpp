@@ -0,0 +1,214 @@
+#include "pulsedThreadSampler.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <string.h>
+
+/* ************************************* reads a value from the source, -1 for a failed read from a file descriptor *************************/
+static inline int64_t samplerRead (taskParams * theTask, pulsedThreadSamplerStructPtr sampler){
+	switch (sampler->kind){
+		case kSAMPLE_FUNC:
+			return sampler->sampleFunc (theTask->taskData);
+		case kSAMPLE_FD:{
+			uint8_t bytes [8];
+			ssize_t nBytes = (sampler->canSeek) ? pread (sampler->fd, bytes, sampler->width, 0) : read (sampler->fd, bytes, sampler->width);
+			if (nBytes != (ssize_t) sampler->width){
+				sampler->nErrors.store (sampler->nErrors.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+				return -1;
+			}
+			int64_t value = 0;
+			for (int iByte = sampler->width - 1; iByte >= 0; iByte -=1){
+				value = (value << 8) | bytes [iByte];
+			}
+			return value;
+		}
+		default: // kSAMPLE_MMAP
+			return *sampler->addr;
+	}
+}
+
+/* ****************************************************************************************************
+Pattern function for sampler tasks. Waits until the time of each sample, counted from start of the task, reads the source, and pushes the sample
+into the ring, or drops it if the ring is full
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThreadSamplerPattern (taskParams * theTask, pulsedThreadTimers * timers){
+	pulsedThreadSamplerStructPtr sampler = (pulsedThreadSamplerStructPtr) theTask->patternData;
+	bool isInfinite = (theTask->nPulses == kINFINITETRAIN);
+	struct timeval startTime;
+	struct timeval deadline;
+	pulsedThreadGetTime (theTask, &startTime);
+	uint64_t sampleUsecs = 0; // time of next sample, from start of task
+	uint64_t nWritten = sampler->nWritten.load (std::memory_order_relaxed);
+	for (unsigned int iSample =0; (isInfinite) || (iSample < theTask->nPulses); iSample +=1){
+		if (theTask->killThread){
+			return;
+		}
+		if (isInfinite){
+			if (!(theTask->doTask & 1)){
+				return;
+			}
+			pulsedThreadPatternMods (theTask, timers);
+		}
+		pulsedThreadDeadline (&startTime, sampleUsecs, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+		pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+		uint64_t nsecs = pulsedThreadNanos ();
+		int64_t value = samplerRead (theTask, sampler);
+		if (nWritten - sampler->nRead.load (std::memory_order_acquire) < sampler->ringSize){
+			pulsedThreadSamplePtr sample = &sampler->ring [nWritten % sampler->ringSize];
+			sample->nsecs = nsecs;
+			sample->value = value;
+			nWritten +=1;
+			sampler->nWritten.store (nWritten, std::memory_order_release);
+		}else{
+			sampler->nDropped.store (sampler->nDropped.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+		sampleUsecs += (uint64_t)theTask->pulseDelayUsecs + theTask->pulseDurUsecs;
+	}
+	// wait out the last period, as a train does
+	pulsedThreadDeadline (&startTime, sampleUsecs, &deadline);
+	pulsedThreadWaitUntil (theTask, timers, &deadline);
+	pulsedThreadEndFunc (theTask);
+}
+
+/* ****************************************************************************************************
+Constructor makes a pulsedThread with the sample period as the train period, opens or maps the source, and allocates the ring, touching each
+page of it, so the thread never allocates memory or takes a page fault while sampling
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadSampler::pulsedThreadSampler (unsigned int gPulses, unsigned int periodUsecs, unsigned int ringSize, const pulsedThreadSamplerSource & source, void * initData, int (*initFunc)(void *, void * &), int64_t (*sampleFunc)(void *), int gAccLevel, int &errCode) :
+	pulsedThread (periodUsecs - periodUsecs/2, periodUsecs/2, gPulses, initData, initFunc, nullptr, nullptr, gAccLevel, errCode){
+	samplerData.nWritten.store (0);
+	samplerData.nDropped.store (0);
+	samplerData.nRead.store (0);
+	samplerData.ring = nullptr;
+	samplerData.ringSize = ringSize;
+	samplerData.kind = source.kind;
+	samplerData.sampleFunc = sampleFunc;
+	samplerData.fd = -1;
+	samplerData.ownsFd = 0;
+	samplerData.canSeek = 0;
+	samplerData.width = source.width;
+	samplerData.addr = nullptr;
+	samplerData.mapBase = nullptr;
+	samplerData.mapSize = source.mapSize;
+	samplerData.nErrors.store (0);
+	if (errCode){
+		return;
+	}
+	bool isBad;
+	switch (source.kind){
+		case kSAMPLE_FUNC:
+			isBad = (sampleFunc == nullptr);
+			break;
+		case kSAMPLE_FD:
+			isBad = ((source.width == 0) || (source.width > 8));
+			break;
+		case kSAMPLE_MMAP:
+			isBad = ((source.mapSize < 4) || (source.mapOffset % sysconf (_SC_PAGESIZE)) || (source.offset % 4) || (source.offset > source.mapSize - 4));
+			break;
+		default:
+			isBad = true;
+			break;
+	}
+	if ((isBad) || (periodUsecs < 2) || (ringSize == 0)){
+#if beVerbose
+		printf ("pulsedThreadSampler error: source %d, width = %d, map of %zu bytes from %lld, offset = %d, period = %d, ring size = %d.\n", source.kind, source.width, source.mapSize, (long long)source.mapOffset, source.offset, periodUsecs, ringSize);
+#endif
+		errCode = 1;
+		return;
+	}
+	if (source.kind != kSAMPLE_FUNC){
+		samplerData.fd = source.fd;
+		if (source.path != nullptr){
+			samplerData.fd = open (source.path, ((source.kind == kSAMPLE_MMAP) ? O_RDWR | O_SYNC : O_RDONLY) | O_CLOEXEC);
+			samplerData.ownsFd = 1;
+		}
+		if (samplerData.fd < 0){
+#if beVerbose
+			printf ("pulsedThreadSampler error: could not open %s.\n", (source.path != nullptr) ? source.path : "file descriptor");
+#endif
+			samplerData.ownsFd = 0;
+			errCode = 1;
+			return;
+		}
+		if (source.kind == kSAMPLE_FD){
+			samplerData.canSeek = (lseek (samplerData.fd, 0, SEEK_CUR) >= 0);
+		}else{
+			void * mapBase = mmap (NULL, source.mapSize, PROT_READ, MAP_SHARED, samplerData.fd, source.mapOffset);
+			if (mapBase == MAP_FAILED){
+#if beVerbose
+				printf ("pulsedThreadSampler error: could not map %zu bytes from %lld.\n", source.mapSize, (long long)source.mapOffset);
+#endif
+				errCode = 1;
+				return;
+			}
+			samplerData.mapBase = mapBase;
+			samplerData.addr = (volatile uint32_t *)((char *) mapBase + source.offset);
+		}
+	}
+	samplerData.ring = new pulsedThreadSample [ringSize];
+	memset (samplerData.ring, 0, ringSize * sizeof (pulsedThreadSample));
+	theTask.patternData = &samplerData;
+	theTask.patternFunc = &pulsedThreadSamplerPattern;
+}
+
+/* ****************************************************************************************************
+Destructor stops the thread before freeing the ring and closing the source, as the pattern function uses them
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadSampler::~pulsedThreadSampler (void){
+	stopThread ();
+	if (samplerData.mapBase != nullptr){
+		munmap (samplerData.mapBase, samplerData.mapSize);
+	}
+	if (samplerData.ownsFd){
+		close (samplerData.fd);
+	}
+	if (samplerData.ring != nullptr){
+		delete [] samplerData.ring;
+	}
+}
+
+/* ****************************************************************************************************
+Copies the oldest samples out of the ring, in up to 2 pieces if they wrap at the end of the ring, then frees them for the thread
+Last Modified:
+2026/10/19 - initial version */
+unsigned int pulsedThreadSampler::drainSamples (pulsedThreadSamplePtr buffer, unsigned int maxSamples){
+	uint64_t firstSample;
+	unsigned int nSamples = peekSamples (firstSample);
+	if (nSamples > maxSamples){
+		nSamples = maxSamples;
+	}
+	unsigned int ringPos = firstSample % samplerData.ringSize;
+	unsigned int nFirst = samplerData.ringSize - ringPos;
+	if (nFirst > nSamples){
+		nFirst = nSamples;
+	}
+	memcpy (buffer, &samplerData.ring [ringPos], nFirst * sizeof (pulsedThreadSample));
+	memcpy (buffer + nFirst, samplerData.ring, (nSamples - nFirst) * sizeof (pulsedThreadSample));
+	releaseSamples (nSamples);
+	return nSamples;
+}
+
+unsigned int pulsedThreadSampler::peekSamples (uint64_t & firstSample){
+	firstSample = samplerData.nRead.load (std::memory_order_relaxed);
+	return (unsigned int)(samplerData.nWritten.load (std::memory_order_acquire) - firstSample);
+}
+
+void pulsedThreadSampler::releaseSamples (unsigned int nSamples){
+	uint64_t nRead = samplerData.nRead.load (std::memory_order_relaxed);
+	uint64_t nReady = samplerData.nWritten.load (std::memory_order_acquire) - nRead;
+	samplerData.nRead.store (nRead + ((nSamples < nReady) ? nSamples : nReady), std::memory_order_release);
+}
+
+pulsedThreadSamplePtr pulsedThreadSampler::getRing (unsigned int & ringSize){
+	ringSize = samplerData.ringSize;
+	return samplerData.ring;
+}
+
+uint64_t pulsedThreadSampler::getSamplerStats (uint64_t & nDropped, uint64_t & nErrors){
+	nDropped = samplerData.nDropped.load (std::memory_order_relaxed);
+	nErrors = samplerData.nErrors.load (std::memory_order_relaxed);
+	return samplerData.nWritten.load (std::memory_order_acquire);
+}
@@ -0,0 +1,84 @@
+#ifndef PULSEDTHREADSAMPLER_H
+#define PULSEDTHREADSAMPLER_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadSampler ***************************************************************
+A pulsedThread that reads an input at a fixed rate, e.g., a lick detector or an encoder, with the same timing as a train, and pushes each
+timestamped value into a ring of samples allocated when the thread is made. The thread is the only writer and one consumer is the only reader,
+so neither ever waits or takes a lock: a consumer copies samples out with drainSamples, or reads them in place, with peekSamples and
+releaseSamples, e.g., from a numpy array made on the memory of the ring. When the ring is full, new samples are dropped and counted, never
+written over samples not yet read.
+
+Each sample reads from a source: a sample function called with the task data, as a hi function is, the first width bytes of a file descriptor,
+read from the start of the file if it can seek, e.g., a sysfs value file, or the next bytes if not, e.g., a pipe, or a 32 bit word in memory
+mapped from a file, e.g., a GPIO level register or a shared memory file. The sample period is the period of the train, pulse delay plus
+duration, so modFreq, modDelay, modDur change it. Samples are timed from the start of the task, so they do not drift with time spent reading.
+
+A pulsedThreadSampler made with a number of samples takes that many for each task requested with DoTask/DoTasks, and runs the endFunc at the
+end of the task. Made with kINFINITETRAIN, it samples from startInfiniteTrain until stopInfiniteTrain. Timestamps are CLOCK_MONOTONIC nanoseconds
+Last Modified:
+2026/10/19 - initial version */
+
+const int kSAMPLE_FUNC = 0;	// calls the sample function
+const int kSAMPLE_FD = 1;	// reads from a file descriptor
+const int kSAMPLE_MMAP = 2;	// reads a word of mapped memory
+
+/* ***************************************** a sample, as kept in the ring *******************************************************/
+typedef struct pulsedThreadSample{
+	uint64_t nsecs;		// CLOCK_MONOTONIC time of the read, in nanoseconds
+	int64_t value;		// value read
+}pulsedThreadSample, *pulsedThreadSamplePtr;
+
+/* ***************************************** where samples are read from ***********************************************************/
+typedef struct pulsedThreadSamplerSource{
+	int kind;				// kSAMPLE_FUNC, kSAMPLE_FD, or kSAMPLE_MMAP
+	const char * path;		// file to open, or nullptr to use fd
+	int fd;					// file descriptor to read or map, if path is nullptr. The sampler does not close it
+	unsigned int width;		// bytes read for kSAMPLE_FD, 1 to 8, low byte first
+	unsigned int offset;	// byte offset, in the map, of the word read, a multiple of 4
+	size_t mapSize;			// bytes mapped for kSAMPLE_MMAP
+	off_t mapOffset;		// offset in the file of the start of the map, a multiple of the page size
+}pulsedThreadSamplerSource, *pulsedThreadSamplerSourcePtr;
+
+/* ******************************** pattern data for a sampler task, source and ring ***************************************************
+nWritten and nRead count samples from when the thread was made, sample n is at ring [n % ringSize]. Each is written by only one side, and
+they are on separate cache lines, so the thread and the consumer do not share a line they both write. nDropped and nErrors are also written
+only by the thread, and are relaxed atomics, as getSamplerStats reads them from another thread
+Last Modified:
+2026/10/19 - nDropped and nErrors are relaxed atomics
+2026/10/19 - initial version */
+typedef struct pulsedThreadSamplerStruct{
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> nWritten;	// written by the thread, with release, after the sample
+	std::atomic<uint64_t> nDropped;								// samples dropped because the ring was full, written by the thread
+	alignas(kCACHE_LINE_SIZE) std::atomic<uint64_t> nRead;		// written by the consumer, with release, after it is done with samples
+	alignas(kCACHE_LINE_SIZE) pulsedThreadSamplePtr ring;
+	unsigned int ringSize;
+	int kind;
+	int64_t (*sampleFunc)(void *);	// for kSAMPLE_FUNC, gets taskData
+	int fd;							// for kSAMPLE_FD, or fd that was mapped
+	int ownsFd;						// 1 if the sampler opened fd, and closes it
+	int canSeek;					// 1 if fd is read from the start each time
+	unsigned int width;
+	volatile uint32_t * addr;		// word read for kSAMPLE_MMAP
+	void * mapBase;					// start of map, or nullptr
+	size_t mapSize;
+	std::atomic<uint64_t> nErrors;	// reads from fd that failed, the sample is still pushed, with value -1, written by the thread
+}pulsedThreadSamplerStruct, *pulsedThreadSamplerStructPtr;
+
+void pulsedThreadSamplerPattern (taskParams * theTask, pulsedThreadTimers * timers); // the pattern function
+
+class pulsedThreadSampler : public pulsedThread{
+	public:
+		/* gPulses is samples per task, or kINFINITETRAIN, periodUsecs at least 2, ringSize in samples. sampleFunc is only used for kSAMPLE_FUNC */
+		pulsedThreadSampler (unsigned int gPulses, unsigned int periodUsecs, unsigned int ringSize, const pulsedThreadSamplerSource & source, void * initData, int (*initFunc)(void *, void * &), int64_t (*sampleFunc)(void *), int gAccLevel, int &errCode);
+		~pulsedThreadSampler (void);
+		unsigned int drainSamples (pulsedThreadSamplePtr buffer, unsigned int maxSamples); // copies up to maxSamples of the oldest samples to buffer and frees them in the ring. Returns number copied
+		unsigned int peekSamples (uint64_t & firstSample); // number of samples ready to read in place, from sample firstSample, at ring [firstSample % ringSize], wrapping at the end of the ring
+		void releaseSamples (unsigned int nSamples); // frees the oldest nSamples samples in the ring, after reading them in place
+		pulsedThreadSamplePtr getRing (unsigned int & ringSize); // the ring, for reading samples in place
+		uint64_t getSamplerStats (uint64_t & nDropped, uint64_t & nErrors); // returns number of samples pushed, and numbers dropped and failed
+	protected:
+		pulsedThreadSamplerStruct samplerData;
+};
+
+#endif // PULSEDTHREADSAMPLER_H
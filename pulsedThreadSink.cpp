@@ -0,0 +1,143 @@
+#include "pulsedThreadSink.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/* ****************************************************************************************************
+Checks the config, opens the path, if given, and maps the memory for memory sinks, so the hi and lo functions only write
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadSinkInit (void * initData, void * &taskData){
+	pulsedThreadSinkConfigPtr config = (pulsedThreadSinkConfigPtr) initData;
+	bool isMem = (config->kind != kSINK_FD);
+	long pageSize = sysconf (_SC_PAGESIZE);
+	if ((config->kind < kSINK_FD) || (config->kind > kSINK_SHM_TOGGLE) ||
+	((!isMem) && (config->width != 1) && (config->width != 2) && (config->width != 4)) ||
+	((isMem) && ((config->mapSize < 4) || (config->mapOffset % pageSize) || (config->hiOffset % 4) || (config->loOffset % 4) ||
+	(config->hiOffset > config->mapSize - 4) || (config->loOffset > config->mapSize - 4)))){
+#if beVerbose
+		printf ("pulsedThreadSinkInit error: kind = %d, width = %d, map of %zu bytes from %lld, hi offset = %d, lo offset = %d.\n", config->kind, config->width, config->mapSize, (long long)config->mapOffset, config->hiOffset, config->loOffset);
+#endif
+		return 1;
+	}
+	int fd = config->fd;
+	if (config->path != nullptr){
+		fd = open (config->path, ((isMem) ? O_RDWR | O_SYNC : O_WRONLY) | O_CLOEXEC);
+	}
+	if (fd < 0){
+#if beVerbose
+		printf ("pulsedThreadSinkInit error: could not open %s.\n", (config->path != nullptr) ? config->path : "file descriptor");
+#endif
+		return 1;
+	}
+	void * mapBase = nullptr;
+	if (isMem){
+		mapBase = mmap (NULL, config->mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, config->mapOffset);
+		if (mapBase == MAP_FAILED){
+#if beVerbose
+			printf ("pulsedThreadSinkInit error: could not map %zu bytes from %lld.\n", config->mapSize, (long long)config->mapOffset);
+#endif
+			if (config->path != nullptr){
+				close (fd);
+			}
+			return 1;
+		}
+	}
+	pulsedThreadSinkPtr sink = new pulsedThreadSink;
+	sink->kind = config->kind;
+	sink->fd = fd;
+	sink->ownsFd = (config->path != nullptr);
+	sink->hiValue = config->hiValue;
+	sink->loValue = config->loValue;
+	sink->width = config->width;
+	sink->mapBase = mapBase;
+	sink->mapSize = config->mapSize;
+	sink->hiAddr = (isMem) ? (volatile uint32_t *)((char *) mapBase + config->hiOffset) : nullptr;
+	sink->loAddr = (isMem) ? (volatile uint32_t *)((char *) mapBase + config->loOffset) : nullptr;
+	sink->nErrors.store (0);
+	taskData = sink;
+	return 0;
+}
+
+/* ******************************** writes value to the fd, the low width bytes of it, low byte first, counting failed writes ******************/
+static inline void sinkWriteFd (pulsedThreadSinkPtr sink, uint32_t value){
+	uint8_t bytes [4] = {(uint8_t) value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+	if (write (sink->fd, bytes, sink->width) != (ssize_t) sink->width){
+		sink->nErrors.store (sink->nErrors.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+}
+
+void pulsedThreadSinkHi (void * taskData){
+	pulsedThreadSinkPtr sink = (pulsedThreadSinkPtr) taskData;
+	switch (sink->kind){
+		case kSINK_FD:
+			sinkWriteFd (sink, sink->hiValue);
+			break;
+		case kSINK_MMAP_SETCLR:
+			*sink->hiAddr = sink->hiValue;
+			break;
+		case kSINK_MMAP_BITS:
+			*sink->hiAddr |= sink->hiValue;
+			break;
+		default: // kSINK_SHM_TOGGLE
+			__atomic_fetch_xor (sink->hiAddr, sink->hiValue, __ATOMIC_RELEASE);
+			break;
+	}
+}
+
+void pulsedThreadSinkLo (void * taskData){
+	pulsedThreadSinkPtr sink = (pulsedThreadSinkPtr) taskData;
+	switch (sink->kind){
+		case kSINK_FD:
+			sinkWriteFd (sink, sink->loValue);
+			break;
+		case kSINK_MMAP_SETCLR:
+			*sink->loAddr = sink->loValue;
+			break;
+		case kSINK_MMAP_BITS:
+			*sink->loAddr &= ~sink->loValue;
+			break;
+		default: // kSINK_SHM_TOGGLE
+			__atomic_fetch_xor (sink->loAddr, sink->loValue, __ATOMIC_RELEASE);
+			break;
+	}
+}
+
+void pulsedThreadSinkDel (void * taskData){
+	pulsedThreadSinkPtr sink = (pulsedThreadSinkPtr) taskData;
+	if (sink == nullptr){
+		return;
+	}
+	if (sink->mapBase != nullptr){
+		munmap (sink->mapBase, sink->mapSize);
+	}
+	if (sink->ownsFd){
+		close (sink->fd);
+	}
+	delete sink;
+}
+
+uint64_t pulsedThreadSinkErrors (void * taskData){
+	return ((pulsedThreadSinkPtr) taskData)->nErrors.load (std::memory_order_relaxed);
+}
+
+/* ****************************************************************************************************
+Sink thread constructors make the sink with pulsedThreadSinkInit, and install pulsedThreadSinkDel once it is made, so the destructor closes it
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadSinkThread::pulsedThreadSinkThread (unsigned int gDelay, unsigned int gDur, unsigned int gPulses, const pulsedThreadSinkConfig & config, int gAccLevel, int &errCode) :
+	pulsedThread (gDelay, gDur, gPulses, (void *) &config, &pulsedThreadSinkInit, &pulsedThreadSinkLo, &pulsedThreadSinkHi, gAccLevel, errCode){
+	if (errCode == 0){
+		setTaskDataDelFunc (&pulsedThreadSinkDel);
+	}
+}
+
+pulsedThreadSinkThread::pulsedThreadSinkThread (float gFrequency, float gDutyCycle, float gTrainDuration, const pulsedThreadSinkConfig & config, int gAccLevel, int &errCode) :
+	pulsedThread (gFrequency, gDutyCycle, gTrainDuration, (void *) &config, &pulsedThreadSinkInit, &pulsedThreadSinkLo, &pulsedThreadSinkHi, gAccLevel, errCode){
+	if (errCode == 0){
+		setTaskDataDelFunc (&pulsedThreadSinkDel);
+	}
+}
+
+uint64_t pulsedThreadSinkThread::getSinkErrors (void){
+	return pulsedThreadSinkErrors (getTaskData ());
+}
@@ -0,0 +1,73 @@
+#ifndef PULSEDTHREADSINK_H
+#define PULSEDTHREADSINK_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadSink ***************************************************************
+Built-in outputs for a pulsedThread, so common outputs need no user hi and lo functions, and a train set up from Python runs without ever
+taking the GIL. A sink is task data for pulsedThreadSinkHi and pulsedThreadSinkLo, made by pulsedThreadSinkInit from a pulsedThreadSinkConfig,
+which opens, or maps, its target once, so each edge is a single write. Install pulsedThreadSinkDel with setTaskDataDelFunc to close it.
+	kSINK_FD writes hiValue at hi and loValue at lo, 1, 2, or 4 bytes of it, low byte first, to a file descriptor, e.g., a pipe, a serial port,
+or a sysfs value file, with hiValue = '1' and loValue = '0'. Failed writes are counted.
+	kSINK_MMAP_SETCLR maps a register block and writes hiValue to the word at hiOffset at hi, and loValue to the word at loOffset at lo, e.g.,
+a pin mask to GPIO set and clear registers, so no read is needed.
+	kSINK_MMAP_BITS maps memory and sets the bits of hiValue in the word at hiOffset at hi, and clears the bits of loValue in the word at loOffset
+at lo, with a read-modify-write, for registers with no separate set and clear registers.
+	kSINK_SHM_TOGGLE maps memory, e.g., a file in /dev/shm shared with another process, and toggles the bits of hiValue in the word at hiOffset at
+hi, and the bits of loValue in the word at loOffset at lo, with an atomic exclusive or, so several threads can share a word.
+Memory sinks map mapSize bytes from mapOffset, which must be a multiple of the page size, and offsets are in bytes from the start of the map.
+A pulsedThreadSinkThread is a pulsedThread made with a sink, and its delete function installed, so the type of a thread can be checked before
+its task data is used as a sink.
+Last Modified:
+2026/10/19 - nErrors is a relaxed atomic, as it is read while the thread runs
+2026/10/19 - added pulsedThreadSinkThread
+2026/10/19 - initial version */
+
+const int kSINK_FD = 0;				// writes a value to a file descriptor
+const int kSINK_MMAP_SETCLR = 1;	// writes a mask to a set register at hi, and to a clear register at lo
+const int kSINK_MMAP_BITS = 2;		// sets bits of a word at hi, clears them at lo
+const int kSINK_SHM_TOGGLE = 3;		// toggles bits of a word at hi and at lo, atomically
+
+/* ***************************************** what a sink writes, and to where **********************************************************/
+typedef struct pulsedThreadSinkConfig{
+	int kind;					// kSINK_FD, kSINK_MMAP_SETCLR, kSINK_MMAP_BITS, or kSINK_SHM_TOGGLE
+	const char * path;			// file to open, or nullptr to use fd
+	int fd;						// file descriptor to write or map, if path is nullptr. The sink does not close it
+	uint32_t hiValue;			// value written, or bits set or toggled, at hi
+	uint32_t loValue;			// value written, or bits cleared or toggled, at lo
+	unsigned int width;			// bytes written for kSINK_FD, 1, 2, or 4
+	unsigned int hiOffset;		// byte offset, in the map, of the word changed at hi, a multiple of 4
+	unsigned int loOffset;		// byte offset, in the map, of the word changed at lo, a multiple of 4
+	size_t mapSize;				// bytes mapped for memory sinks
+	off_t mapOffset;			// offset in the file of the start of the map, a multiple of the page size
+}pulsedThreadSinkConfig, *pulsedThreadSinkConfigPtr;
+
+/* ************************************************** task data for sink hi and lo functions ******************************************/
+typedef struct pulsedThreadSink{
+	int kind;
+	int fd;						// file descriptor written or mapped
+	int ownsFd;					// 1 if the sink opened fd, and closes it
+	uint32_t hiValue;
+	uint32_t loValue;
+	unsigned int width;
+	volatile uint32_t * hiAddr;	// word changed at hi, for memory sinks
+	volatile uint32_t * loAddr;	// word changed at lo, for memory sinks
+	void * mapBase;				// start of map, or nullptr
+	size_t mapSize;
+	std::atomic<uint64_t> nErrors;	// writes that failed, for kSINK_FD, written by the thread, read by pulsedThreadSinkErrors
+}pulsedThreadSink, *pulsedThreadSinkPtr;
+
+int pulsedThreadSinkInit (void * initData, void * &taskData); // initFunc, initData is a pulsedThreadSinkConfigPtr. Returns 1 if the target can not be opened or mapped
+void pulsedThreadSinkHi (void * taskData); // hi function
+void pulsedThreadSinkLo (void * taskData); // lo function
+void pulsedThreadSinkDel (void * taskData); // task data delete function, unmaps and closes what the sink opened
+uint64_t pulsedThreadSinkErrors (void * taskData); // number of failed writes
+
+class pulsedThreadSinkThread : public pulsedThread{
+	public:
+		/* config is only used by the constructor, the sink opens, or maps, its target once */
+		pulsedThreadSinkThread (unsigned int gDelay, unsigned int gDur, unsigned int gPulses, const pulsedThreadSinkConfig & config, int gAccLevel, int &errCode);
+		pulsedThreadSinkThread (float gFrequency, float gDutyCycle, float gTrainDuration, const pulsedThreadSinkConfig & config, int gAccLevel, int &errCode);
+		uint64_t getSinkErrors (void); // number of failed writes
+};
+
+#endif // PULSEDTHREADSINK_H
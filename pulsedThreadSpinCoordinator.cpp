@@ -0,0 +1,316 @@
+#include "pulsedThreadSpinCoordinator.h"
+
+/* ************************************** static members of the coordinator *******************************************/
+pthread_mutex_t pulsedThreadSpinCoordinator::coordMutex = PTHREAD_MUTEX_INITIALIZER;
+pulsedThreadSpinEntry pulsedThreadSpinCoordinator::entries [kSPIN_MAX_THREADS];
+
+/* ******************************** spin time estimates from current timing of a thread ********************************
+A segment long enough to sleep spins for kSLEEPTURNAROUND at its end, a shorter segment spins for its whole length. At ACC_MODE_AUTO,
+a segment spins as chosen from the host latency */
+static inline unsigned int segmentSpin (int accLevel, unsigned int segUsecs){
+	if (accLevel == ACC_MODE_AUTO){
+		return pulsedThreadAutoSpin (segUsecs, pulsedThreadHostLatency ());
+	}
+	return (segUsecs < (unsigned int)kSLEEPTURNAROUND) ? segUsecs : (unsigned int)kSLEEPTURNAROUND;
+}
+
+float pulsedThreadSpinCoordinator::threadLoad (pulsedThread * thread){
+	taskParams * theTask = thread->getTask ();
+	if (theTask->accLevel == ACC_MODE_SLEEPS){
+		return 0;
+	}
+	unsigned int period = threadPeriod (thread);
+	if (period == 0){
+		return 0;
+	}
+	unsigned int spin = segmentSpin (theTask->accLevel, theTask->pulseDurUsecs) + segmentSpin (theTask->accLevel, theTask->pulseDelayUsecs);
+	return (float)spin/(float)period;
+}
+
+unsigned int pulsedThreadSpinCoordinator::threadPeriod (pulsedThread * thread){
+	taskParams * theTask = thread->getTask ();
+	return theTask->pulseDurUsecs + theTask->pulseDelayUsecs;
+}
+
+unsigned int pulsedThreadSpinCoordinator::threadWindow (pulsedThread * thread){
+	taskParams * theTask = thread->getTask ();
+	if (theTask->accLevel == ACC_MODE_SLEEPS){
+		return 0;
+	}
+	unsigned int durSpin = segmentSpin (theTask->accLevel, theTask->pulseDurUsecs);
+	unsigned int delaySpin = segmentSpin (theTask->accLevel, theTask->pulseDelayUsecs);
+	return (durSpin > delaySpin) ? durSpin : delaySpin;
+}
+
+static unsigned int gcd (unsigned int a, unsigned int b){
+	while (b != 0){
+		unsigned int t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/* ******************************* checks a core for predicted overlap and overload *************************************
+called with coordMutex held. newThread can be nullptr to check the core as it is */
+int pulsedThreadSpinCoordinator::checkCore (int core, pulsedThread * newThread){
+	int status = kSPIN_OK;
+	float load = (newThread == nullptr) ? 0 : threadLoad (newThread);
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		pulsedThread * thread = entries [iEntry].thread.load ();
+		if ((thread == nullptr) || (thread == newThread) || (entries [iEntry].core.load () != core)){
+			continue;
+		}
+		load += threadLoad (thread);
+		if (newThread != nullptr){
+			unsigned int w1 = threadWindow (thread);
+			unsigned int w2 = threadWindow (newThread);
+			if ((w1 > 0) && (w2 > 0) && (gcd (threadPeriod (thread), threadPeriod (newThread)) < w1 + w2)){
+				status = kSPIN_OVERLAP;
+			}
+		}
+	}
+	if (load > 1){
+		status = kSPIN_OVERLOAD;
+	}
+	return status;
+}
+
+/* ***************************** per-core index of the entries each pthread checks its windows against ***************************
+called with coordMutex held, whenever a thread is added, moved, or removed. A pthread reading its index while it is remade may check
+an entry that just left its core, or miss one that just joined, which can only add to, or miss, an overlap count */
+void pulsedThreadSpinCoordinator::indexPeers (void){
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		int nPeers =0;
+		int core = entries [iEntry].core.load ();
+		if (entries [iEntry].thread.load () != nullptr){
+			for (int jEntry =0; jEntry < kSPIN_MAX_THREADS; jEntry +=1){
+				if ((jEntry != iEntry) && (entries [jEntry].thread.load () != nullptr) && (entries [jEntry].core.load () == core)){
+					entries [iEntry].peers [nPeers].store ((unsigned char) jEntry, std::memory_order_relaxed);
+					nPeers +=1;
+				}
+			}
+		}
+		entries [iEntry].nPeers.store (nPeers, std::memory_order_release);
+	}
+}
+
+/* ****************************************** registering a thread ********************************************************
+Pins the thread to core, or to the allowed core with least projected load if core is kSPIN_CORE_AUTO, and fills core with the core used.
+If refuseWarnings is non-zero, a thread that would be given kSPIN_OVERLAP or kSPIN_OVERLOAD is not registered, and kSPIN_REFUSED is returned.
+Adding a thread that is already registered moves it to the new core. A thread that has not borrowed its pthread yet is pinned when it does */
+int pulsedThreadSpinCoordinator::addThread (pulsedThread * thread, int & core, int refuseWarnings){
+	cpu_set_t allowed;
+	CPU_ZERO (&allowed);
+	if (sched_getaffinity (0, sizeof (cpu_set_t), &allowed) != 0){
+		return kSPIN_REFUSED;
+	}
+	pthread_mutex_lock (&coordMutex);
+	// pick a core
+	if (core == kSPIN_CORE_AUTO){
+		float leastLoad = 0;
+		for (int iCore =0; iCore < CPU_SETSIZE; iCore +=1){
+			if (!CPU_ISSET (iCore, &allowed)){
+				continue;
+			}
+			float load = 0;
+			for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+				pulsedThread * other = entries [iEntry].thread.load ();
+				if ((other != nullptr) && (other != thread) && (entries [iEntry].core.load () == iCore)){
+					load += threadLoad (other);
+				}
+			}
+			if ((core == kSPIN_CORE_AUTO) || (load < leastLoad)){
+				core = iCore;
+				leastLoad = load;
+			}
+		}
+	}
+	if ((core < 0) || (core >= CPU_SETSIZE) || (!CPU_ISSET (core, &allowed))){
+		pthread_mutex_unlock (&coordMutex);
+		return kSPIN_REFUSED;
+	}
+	int status = checkCore (core, thread);
+#if beVerbose
+	if (status == kSPIN_OVERLAP){
+		printf ("Spin windows of thread may overlap those of another thread on core %d.\n", core);
+	}else if (status == kSPIN_OVERLOAD){
+		printf ("Projected spin load on core %d is more than the whole core.\n", core);
+	}
+#endif
+	if ((status != kSPIN_OK) && (refuseWarnings)){
+		pthread_mutex_unlock (&coordMutex);
+		return kSPIN_REFUSED;
+	}
+	// find existing entry for the thread, or a free entry
+	pulsedThreadSpinEntry * entry = nullptr;
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		if (entries [iEntry].thread.load () == thread){
+			entry = &entries [iEntry];
+			break;
+		}
+		if ((entry == nullptr) && (entries [iEntry].thread.load () == nullptr)){
+			entry = &entries [iEntry];
+		}
+	}
+	if (entry == nullptr){
+		pthread_mutex_unlock (&coordMutex);
+		return kSPIN_REFUSED;
+	}
+	// pin the pthread, if it has one yet, else the pthread pins itself when it starts
+	taskParams * theTask = thread->getTask ();
+	thread->getTaskMutex ();
+	if (theTask->threadState == kTHREAD_RUNNING){
+		cpu_set_t cpuSet;
+		CPU_ZERO (&cpuSet);
+		CPU_SET (core, &cpuSet);
+		if (pthread_setaffinity_np (theTask->taskThread, sizeof (cpu_set_t), &cpuSet) != 0){
+			thread->giveUpTaskMutex ();
+			pthread_mutex_unlock (&coordMutex);
+			return kSPIN_REFUSED;
+		}
+	}
+	if (entry->thread.load () != thread){
+		entry->windowStart.store (0);
+		entry->windowEnd.store (0);
+		entry->nWindows.store (0);
+		entry->nOverlaps.store (0);
+	}
+	entry->core.store (core);
+	entry->thread.store (thread);
+	indexPeers ();
+	// give the entry to the pthread
+	theTask->spinEntry = entry;
+	thread->giveUpTaskMutex ();
+	pthread_mutex_unlock (&coordMutex);
+	return status;
+}
+
+/* *************************************** unregistering a thread **********************************************************
+The pthread is left pinned to its core */
+int pulsedThreadSpinCoordinator::removeThread (pulsedThread * thread){
+	int returnVal = 1;
+	pthread_mutex_lock (&coordMutex);
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		if (entries [iEntry].thread.load () == thread){
+			thread->getTaskMutex ();
+			thread->getTask ()->spinEntry = nullptr;
+			thread->giveUpTaskMutex ();
+			entries [iEntry].core.store (-1);
+			entries [iEntry].thread.store (nullptr);
+			indexPeers ();
+			returnVal = 0;
+			break;
+		}
+	}
+	pthread_mutex_unlock (&coordMutex);
+	return returnVal;
+}
+
+int pulsedThreadSpinCoordinator::getCore (pulsedThread * thread){
+	int core = -1;
+	pthread_mutex_lock (&coordMutex);
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		if (entries [iEntry].thread.load () == thread){
+			core = entries [iEntry].core.load ();
+			break;
+		}
+	}
+	pthread_mutex_unlock (&coordMutex);
+	return core;
+}
+
+/* ***************************** reporting projected load and predicted overlap for a core *********************************/
+float pulsedThreadSpinCoordinator::getProjectedLoad (int core){
+	float load = 0;
+	pthread_mutex_lock (&coordMutex);
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		pulsedThread * thread = entries [iEntry].thread.load ();
+		if ((thread != nullptr) && (entries [iEntry].core.load () == core)){
+			load += threadLoad (thread);
+		}
+	}
+	pthread_mutex_unlock (&coordMutex);
+	return load;
+}
+
+int pulsedThreadSpinCoordinator::getNumOverlapRisks (int core){
+	int nRisks =0;
+	pthread_mutex_lock (&coordMutex);
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		pulsedThread * thread = entries [iEntry].thread.load ();
+		if ((thread == nullptr) || (entries [iEntry].core.load () != core)){
+			continue;
+		}
+		unsigned int w1 = threadWindow (thread);
+		for (int jEntry = iEntry + 1; jEntry < kSPIN_MAX_THREADS; jEntry +=1){
+			pulsedThread * other = entries [jEntry].thread.load ();
+			if ((other == nullptr) || (entries [jEntry].core.load () != core)){
+				continue;
+			}
+			unsigned int w2 = threadWindow (other);
+			if ((w1 > 0) && (w2 > 0) && (gcd (threadPeriod (thread), threadPeriod (other)) < w1 + w2)){
+				nRisks +=1;
+			}
+		}
+	}
+	pthread_mutex_unlock (&coordMutex);
+	return nRisks;
+}
+
+/* ************************************ measured overlaps, from windows published by the pthreads ***************************/
+uint64_t pulsedThreadSpinCoordinator::getOverlaps (pulsedThread * thread, uint64_t & nWindows){
+	uint64_t nOverlaps =0;
+	nWindows =0;
+	pthread_mutex_lock (&coordMutex);
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		if (entries [iEntry].thread.load () == thread){
+			nWindows = entries [iEntry].nWindows.load ();
+			nOverlaps = entries [iEntry].nOverlaps.load ();
+			break;
+		}
+	}
+	pthread_mutex_unlock (&coordMutex);
+	return nOverlaps;
+}
+
+void pulsedThreadSpinCoordinator::resetOverlaps (void){
+	pthread_mutex_lock (&coordMutex);
+	for (int iEntry =0; iEntry < kSPIN_MAX_THREADS; iEntry +=1){
+		entries [iEntry].nWindows.store (0);
+		entries [iEntry].nOverlaps.store (0);
+	}
+	pthread_mutex_unlock (&coordMutex);
+}
+
+/* ********************************* called by a registered pthread each time it schedules a spin window *************************
+spinEndTime is the end of the segment, the window is the spinUsecs before that. Each pthread checks its new window against the most
+recent window of the other threads on its core, found from its peer index, so an overlapping pair is counted by whichever thread schedules
+second. The core and thread of a peer are checked again, as the index may be remade while it is read */
+void pulsedThreadSpinPublish (pulsedThreadSpinEntry * entry, const struct timeval * spinEndTime, unsigned int spinUsecs){
+	if (spinUsecs == 0){
+		return;
+	}
+	uint64_t windowEnd = (uint64_t)spinEndTime->tv_sec * 1000000 + spinEndTime->tv_usec;
+	uint64_t windowStart = windowEnd - spinUsecs;
+	int core = entry->core.load (std::memory_order_relaxed);
+	pulsedThreadSpinEntry * entries = pulsedThreadSpinCoordinator::entries;
+	bool overlaps = false;
+	int nPeers = entry->nPeers.load (std::memory_order_acquire);
+	for (int iPeer =0; iPeer < nPeers; iPeer +=1){
+		pulsedThreadSpinEntry * other = &entries [entry->peers [iPeer].load (std::memory_order_relaxed)];
+		if ((other == entry) || (other->core.load (std::memory_order_relaxed) != core) || (other->thread.load (std::memory_order_relaxed) == nullptr)){
+			continue;
+		}
+		if ((windowStart < other->windowEnd.load (std::memory_order_relaxed)) && (other->windowStart.load (std::memory_order_relaxed) < windowEnd)){
+			overlaps = true;
+			break;
+		}
+	}
+	entry->windowStart.store (windowStart, std::memory_order_relaxed);
+	entry->windowEnd.store (windowEnd, std::memory_order_relaxed);
+	entry->nWindows.store (entry->nWindows.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (overlaps){
+		entry->nOverlaps.store (entry->nOverlaps.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+}
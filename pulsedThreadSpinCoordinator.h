@@ -0,0 +1,67 @@
+#ifndef PULSEDTHREADSPINCOORDINATOR_H
+#define PULSEDTHREADSPINCOORDINATOR_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadSpinCoordinator ***************************************************
+pulsedThreads at accLevel 1 or 2 finish each delay and duration by spinning on the clock. Two such threads at the same SCHED_RR
+priority that land on the same core preempt each other mid-spin, and both miss edges. The coordinator is a process-wide registry
+that pins registered threads to cores, predicts when the spin windows of threads sharing a core can collide, and reports the
+fraction of each core that is projected to be spent spinning.
+
+Prediction is made from pulse timing only, as phase between threads is not known: windows of two trains with periods P1 and P2
+and spin windows w1 and w2 collide sooner or later, whatever the phase, if gcd (P1, P2) < w1 + w2. Otherwise, they can be kept
+apart by starting the trains at the right phase. Registered threads also publish every spin window as it is scheduled, and count
+windows that actually overlap windows of other threads on the same core, which shows if the phase is wrong. Each entry is on its own
+cache lines, so publishing a window does not write a line other pthreads read for their own entries, and each entry has an index of
+the other entries on its core, kept by the coordinator, so a pthread checks only the threads it can collide with.
+
+Threads at accLevel 0 never spin, and can be registered to be pinned, but add no spin load.
+Last Modified:
+2026/10/19 - entries aligned to cache lines, with a per-core index of peer entries
+2026/10/19 - initial version */
+
+const int kSPIN_MAX_THREADS = 64;	// maximum number of registered threads
+const int kSPIN_CORE_AUTO = -1;		// pass for core to let the coordinator pick the core with least projected spin load
+
+/* *************************** status codes returned when adding a thread ******************************************/
+const int kSPIN_REFUSED = -1;		// thread was not registered, because the registry is full, the core is not valid, or a warning was refused
+const int kSPIN_OK = 0;				// thread registered, spin windows on its core can be kept apart with the right phase
+const int kSPIN_OVERLAP = 1;		// thread registered, but its spin windows will overlap those of another thread on its core
+const int kSPIN_OVERLOAD = 2;		// thread registered, but projected spin load on its core is more than the whole core
+
+/* ************************ entry for a registered thread, in a static table that is never freed ***************************
+the pthread writes the window fields, so a thread removed while in the middle of a pulse can at worst add to statistics. The peer index
+is written only by the coordinator, with coordMutex held, and read only by the entry's own pthread, so it gets a line of its own */
+struct alignas(kCACHE_LINE_SIZE) pulsedThreadSpinEntry{
+	std::atomic<pulsedThread *> thread;		// registered thread, nullptr if entry is free
+	std::atomic<int> core;					// core the thread is pinned to
+	std::atomic<uint64_t> windowStart;		// start of most recent spin window, microseconds since epoch, as from gettimeofday
+	std::atomic<uint64_t> windowEnd;		// end of most recent spin window
+	std::atomic<uint64_t> nWindows;			// number of spin windows published
+	std::atomic<uint64_t> nOverlaps;		// number of those windows that overlapped a window of another thread on the same core
+	alignas(kCACHE_LINE_SIZE) std::atomic<int> nPeers;		// number of other registered entries on the same core
+	std::atomic<unsigned char> peers [kSPIN_MAX_THREADS];	// indices of those entries in the table
+};
+
+class pulsedThreadSpinCoordinator{
+	public:
+		static int addThread (pulsedThread * thread, int & core, int refuseWarnings); // pins thread to core (or picks a core), returns status code
+		static int removeThread (pulsedThread * thread); // unregisters thread, returns 1 if it was not registered
+		static int getCore (pulsedThread * thread); // core a registered thread is pinned to, or -1 if not registered
+		static float getProjectedLoad (int core); // projected fraction of the core spent spinning by registered threads
+		static int getNumOverlapRisks (int core); // number of pairs of registered threads on the core whose windows may overlap
+		static uint64_t getOverlaps (pulsedThread * thread, uint64_t & nWindows); // returns overlapping windows counted for thread, fills total windows
+		static void resetOverlaps (void); // zeros window counts for all registered threads
+		/* per thread estimates from current timing of the thread, used for prediction */
+		static float threadLoad (pulsedThread * thread); // fraction of time thread is projected to spend spinning
+		static unsigned int threadPeriod (pulsedThread * thread); // microseconds between spin windows of the same kind
+		static unsigned int threadWindow (pulsedThread * thread); // longest spin window, in microseconds
+	private:
+		friend void pulsedThreadSpinPublish (pulsedThreadSpinEntry * entry, const struct timeval * spinEndTime, unsigned int spinUsecs);
+		static int checkCore (int core, pulsedThread * newThread); // status for core if newThread were added to it
+		static void indexPeers (void); // remakes the per-core peer index of every entry, called with coordMutex held
+		static pthread_mutex_t coordMutex; // protects registration, not used by the pthreads
+		static pulsedThreadSpinEntry entries [kSPIN_MAX_THREADS];
+};
+
+#endif // PULSEDTHREADSPINCOORDINATOR_H
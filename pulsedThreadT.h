@@ -0,0 +1,121 @@
+#ifndef PULSEDTHREADT_H
+#define PULSEDTHREADT_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadT ***************************************************************
+A header-only pulsedThread whose hi, lo, and end functions are callables, lambdas or functors, of types given as template parameters, so the
+pulse, train, and infinite train loops are compiled for those types and the calls at each edge can be inlined, e.g., a GPIO register write
+takes a few nanoseconds, with no call through a pointer and no nullptr test. A callable keeps its own data, with its own type, in its members
+or captures, so no void * taskData is needed. Hi and Lo are called with no arguments. End is called with the taskParams, after each task,
+or after each pulse of an infinite train, and can change timing as an endFunc does. With the default End, pulsedThreadNoEnd, the endFunc
+set with setEndFunc, or one of the array endFuncs, is run as for a pulsedThread, and can be offloaded.
+
+The loops are run as the pattern function of the task, so all of the pulsedThread control API, DoTask, modFreq, arm, triggers, chaining,
+traces, and so on, works as for a pulsedThread. setLowFunc and setHighFunc have no effect. The callables are kept in the pattern data of
+the task, a pulsedThreadTStruct, so a custom modification can get at them with theTask->patternData while the thread is running.
+
+In C++11, a lambda type can not be named, so use makePulsedThreadT, e.g., for a train of 1000 pulses,
+	pulsedThread * myThread = makePulsedThreadT (0u, 500u, 1000u, [gpioSet, gpioBit](){*gpioSet = gpioBit;}, [gpioClr, gpioBit](){*gpioClr = gpioBit;}, pulsedThreadNoEnd (), ACC_MODE_SLEEPS_AND_SPINS, errCode);
+Last Modified:
+2026/10/19 - initial version */
+
+/* ********************************* default End type, runs the endFunc of the task, if there is one ****************************************/
+struct pulsedThreadNoEnd{
+	void operator() (taskParams * theTask){
+		pulsedThreadEndFunc (theTask);
+	}
+};
+
+/* ******************************** pattern data for a templated task, the callables ***************************************************/
+template <typename Hi, typename Lo, typename End>
+struct pulsedThreadTStruct{
+	Hi hi;
+	Lo lo;
+	End end;
+};
+
+template <typename Hi, typename Lo, typename End = pulsedThreadNoEnd>
+class pulsedThreadT : public pulsedThread{
+	public:
+		/* delay and duration in microseconds, gPulses is kPULSE, kINFINITETRAIN, or number of pulses in a train */
+		pulsedThreadT (unsigned int gDelay, unsigned int gDur, unsigned int gPulses, const Hi & gHi, const Lo & gLo, const End & gEnd, int gAccLevel, int &errCode) :
+			pulsedThread (gDelay, gDur, gPulses, nullptr, nullptr, nullptr, nullptr, gAccLevel, errCode), funcs {gHi, gLo, gEnd}{
+			theTask.patternData = &funcs;
+			theTask.patternFunc = &pattern;
+		}
+		/* frequency in Hz, duty cycle between 0 and 1, train duration in seconds, 0 for an infinite train */
+		pulsedThreadT (float gFrequency, float gDutyCycle, float gTrainDuration, const Hi & gHi, const Lo & gLo, const End & gEnd, int gAccLevel, int &errCode) :
+			pulsedThread (gFrequency, gDutyCycle, gTrainDuration, nullptr, nullptr, nullptr, nullptr, gAccLevel, errCode), funcs {gHi, gLo, gEnd}{
+			theTask.patternData = &funcs;
+			theTask.patternFunc = &pattern;
+		}
+		~pulsedThreadT (void){
+		}
+		/* ****************************************************************************************************
+		Pattern function, the same pulse, train, and infinite train loops as the thread function, calling the callables directly
+		Last Modified:
+		2026/10/19 - initial version */
+		static void pattern (taskParams * theTask, pulsedThreadTimers * timers){
+			pulsedThreadTStruct<Hi, Lo, End> * funcs = (pulsedThreadTStruct<Hi, Lo, End> *) theTask->patternData;
+			switch (theTask->nPulses){
+				case kPULSE:
+					if (theTask->pulseDelayUsecs > 0){
+						pulsedThreadWaitSegment (theTask, timers, &timers->delay);
+					}
+					pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+					funcs->hi ();
+					pulsedThreadWaitSegment (theTask, timers, &timers->dur);
+					pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+					funcs->lo ();
+					funcs->end (theTask);
+					break;
+				case kINFINITETRAIN:
+					while (theTask->doTask & 1){
+						pulsedThreadPatternMods (theTask, timers);
+						pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+						funcs->hi ();
+						pulsedThreadWaitSegment (theTask, timers, &timers->dur);
+						if (theTask->pulseDelayUsecs > 0){
+							pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+							funcs->lo ();
+							pulsedThreadWaitSegment (theTask, timers, &timers->delay);
+						}
+						funcs->end (theTask);
+					}
+					break;
+				default: // kTRAIN
+					for (unsigned int iTick=0; iTick < theTask->nPulses; iTick++){
+						if (theTask->killThread){
+							break;
+						}
+						if (theTask->pulseDurUsecs > 0){
+							pulsedThreadEdgeHooks (theTask, 0, kTRACE_HI);
+							funcs->hi ();
+							pulsedThreadWaitSegment (theTask, timers, &timers->dur);
+						}
+						if (theTask->pulseDelayUsecs > 0){
+							pulsedThreadEdgeHooks (theTask, 0, kTRACE_LO);
+							funcs->lo ();
+							pulsedThreadWaitSegment (theTask, timers, &timers->delay);
+						}
+					}
+					funcs->end (theTask);
+					break;
+			}
+		}
+	protected:
+		pulsedThreadTStruct<Hi, Lo, End> funcs;
+};
+
+/* ******************************** makes a pulsedThreadT with the types of the callables passed to it, e.g., lambdas ************************/
+template <typename Hi, typename Lo, typename End>
+pulsedThreadT<Hi, Lo, End> * makePulsedThreadT (unsigned int gDelay, unsigned int gDur, unsigned int gPulses, const Hi & gHi, const Lo & gLo, const End & gEnd, int gAccLevel, int &errCode){
+	return new pulsedThreadT<Hi, Lo, End> (gDelay, gDur, gPulses, gHi, gLo, gEnd, gAccLevel, errCode);
+}
+
+template <typename Hi, typename Lo, typename End>
+pulsedThreadT<Hi, Lo, End> * makePulsedThreadT (float gFrequency, float gDutyCycle, float gTrainDuration, const Hi & gHi, const Lo & gLo, const End & gEnd, int gAccLevel, int &errCode){
+	return new pulsedThreadT<Hi, Lo, End> (gFrequency, gDutyCycle, gTrainDuration, gHi, gLo, gEnd, gAccLevel, errCode);
+}
+
+#endif // PULSEDTHREADT_H
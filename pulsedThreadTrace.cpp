@@ -0,0 +1,397 @@
+#include "pulsedThreadTrace.h"
+#include <stdio.h>
+
+/* ****************************************************************************************************
+Constructor allocates the buffer for records, so the thread never allocates memory while recording
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadTrace::pulsedThreadTrace (size_t maxBytesP){
+	maxBytes = maxBytesP;
+	buffer = (maxBytes > 0) ? new uint8_t [maxBytes] : nullptr;
+	nBytes.store (0);
+	nEdges.store (0);
+	nDropped.store (0);
+	startUsecs.store (0);
+	lastUsecs = 0;
+}
+
+pulsedThreadTrace::~pulsedThreadTrace (void){
+	if (buffer != nullptr){
+		delete [] buffer;
+	}
+}
+
+/* ****************************************************************************************************
+Called by the thread at each task start and edge, through pulsedThreadEdgeHooks. Writes the record, then publishes it by storing the new
+byte count, so a controlling thread decoding the trace while the thread records only sees complete records
+Last Modified:
+2026/10/19 - initial version */
+void pulsedThreadTraceRecord (pulsedThreadTrace * trace, taskParams * theTask, unsigned int channel, int kind){
+	struct timeval currentTime;
+	pulsedThreadGetTime (theTask, &currentTime);
+	uint64_t usecs = (uint64_t)currentTime.tv_sec * 1000000 + currentTime.tv_usec;
+	size_t pos = trace->nBytes.load (std::memory_order_relaxed);
+	if (pos + kTRACE_MAX_RECORD > trace->maxBytes){
+		trace->nDropped.fetch_add (1, std::memory_order_relaxed);
+		return;
+	}
+	uint64_t delta;
+	if (pos == 0){
+		trace->startUsecs.store (usecs, std::memory_order_relaxed);
+		delta = 0;
+	}else{
+		delta = (usecs > trace->lastUsecs) ? usecs - trace->lastUsecs : 0;
+	}
+	trace->lastUsecs = usecs;
+	trace->buffer [pos++] = (uint8_t)((kind << 6) | (channel & (kTRACE_MAX_CHANNELS - 1)));
+	while (delta >= 0x80){
+		trace->buffer [pos++] = (uint8_t)(delta | 0x80);
+		delta >>= 7;
+	}
+	trace->buffer [pos++] = (uint8_t) delta;
+	trace->nEdges.fetch_add (1, std::memory_order_relaxed);
+	trace->nBytes.store (pos, std::memory_order_release);
+}
+
+/* ****************************************************************************************************
+Forgets all records. The recording thread writes the buffer and lastUsecs without a lock, so reset must not be called while the trace is
+installed in a busy thread: reset between tasks, or after captureTrace (nullptr)
+Last Modified:
+2026/10/19 - documented that it must not be called while a thread is recording
+2026/10/19 - initial version */
+void pulsedThreadTrace::reset (void){
+	nBytes.store (0);
+	nEdges.store (0);
+	nDropped.store (0);
+	startUsecs.store (0);
+	lastUsecs = 0;
+}
+
+unsigned int pulsedThreadTrace::getNumEdges (void){
+	return nEdges.load ();
+}
+
+size_t pulsedThreadTrace::getNumBytes (void){
+	return nBytes.load ();
+}
+
+uint64_t pulsedThreadTrace::getNumDropped (void){
+	return nDropped.load ();
+}
+
+uint64_t pulsedThreadTrace::getStartUsecs (void){
+	return startUsecs.load (std::memory_order_relaxed);
+}
+
+/* ****************************************************************************************************
+Decodes the record starting at pos, without reading at or past endPos. Returns bytes in the record, or 0 if the record is cut short by endPos,
+is longer than kTRACE_MAX_RECORD, or has kind 3, which is not a kind of edge, as in a truncated or corrupt file
+Last Modified:
+2026/10/19 - initial version */
+static size_t traceDecodeRecord (const uint8_t * buffer, size_t pos, size_t endPos, uint8_t & edgeByte, uint64_t & delta){
+	size_t startPos = pos;
+	edgeByte = buffer [pos++];
+	if ((edgeByte >> 6) > kTRACE_START){
+		return 0;
+	}
+	delta = 0;
+	unsigned int shift = 0;
+	uint8_t deltaByte;
+	do{
+		if ((pos >= endPos) || (pos - startPos >= kTRACE_MAX_RECORD)){
+			return 0;
+		}
+		deltaByte = buffer [pos++];
+		delta |= (uint64_t)(deltaByte & 0x7F) << shift;
+		shift += 7;
+	}while (deltaByte & 0x80);
+	return pos - startPos;
+}
+
+/* ****************************************************************************************************
+Decodes records into edges with times from the first record. Can be called while the thread is recording, and decodes the records
+complete at the time of the call. Stops at a record that is cut short or is not valid
+Last Modified:
+2026/10/19 - checks every byte against the end of the records, and stops on a partial record or kind 3
+2026/10/19 - initial version */
+unsigned int pulsedThreadTrace::getEdges (pulsedThreadEdgePtr edges, unsigned int maxEdges){
+	size_t endPos = nBytes.load (std::memory_order_acquire);
+	size_t pos = 0;
+	uint64_t usecs = 0;
+	unsigned int iEdge;
+	for (iEdge =0; (iEdge < maxEdges) && (pos < endPos); iEdge +=1){
+		uint8_t edgeByte;
+		uint64_t delta;
+		size_t recordBytes = traceDecodeRecord (buffer, pos, endPos, edgeByte, delta);
+		if (recordBytes == 0){
+			break;
+		}
+		pos += recordBytes;
+		usecs += delta;
+		edges [iEdge].usecs = usecs;
+		edges [iEdge].channel = edgeByte & (kTRACE_MAX_CHANNELS - 1);
+		edges [iEdge].kind = edgeByte >> 6;
+	}
+	return iEdge;
+}
+
+/* ****************************************************************************************************
+Writes the header and the records to a file. The header counts bytes of records with 32 bits, so traces of 4 GiB or more are refused,
+rather than saved with a truncated count
+Last Modified:
+2026/10/19 - refuses traces too big for the 32 bit byte count in the header
+2026/10/19 - initial version */
+int pulsedThreadTrace::save (const char * path){
+	size_t recordBytes = nBytes.load (std::memory_order_acquire);
+	if (recordBytes > UINT32_MAX){
+#if beVerbose
+		printf ("trace save error: %zu bytes of records are too many for a trace file.\n", recordBytes);
+#endif
+		return 1;
+	}
+	pulsedThreadTraceHeader header;
+	header.magic = kTRACE_MAGIC;
+	header.version = kTRACE_VERSION;
+	header.reserved = 0;
+	header.nBytes = (uint32_t) recordBytes;
+	header.nEdges = nEdges.load ();
+	header.startUsecs = startUsecs.load (std::memory_order_relaxed);
+	FILE * fp = fopen (path, "wb");
+	if (fp == nullptr){
+#if beVerbose
+		printf ("trace save error: could not open %s.\n", path);
+#endif
+		return 1;
+	}
+	int errVal = 0;
+	if ((fwrite (&header, sizeof (pulsedThreadTraceHeader), 1, fp) != 1) || ((header.nBytes > 0) && (fwrite (buffer, header.nBytes, 1, fp) != 1))){
+		errVal = 1;
+	}
+	if (fclose (fp) != 0){
+		errVal = 1;
+	}
+	return errVal;
+}
+
+/* ****************************************************************************************************
+Replaces the records with those from a file, only when no thread is recording to the trace. The records are checked, and a file whose
+records are cut short, are not valid, or do not match the count of edges in its header is refused
+Last Modified:
+2026/10/19 - checks the records read from the file
+2026/10/19 - initial version */
+int pulsedThreadTrace::load (const char * path){
+	FILE * fp = fopen (path, "rb");
+	if (fp == nullptr){
+#if beVerbose
+		printf ("trace load error: could not open %s.\n", path);
+#endif
+		return 1;
+	}
+	pulsedThreadTraceHeader header;
+	if ((fread (&header, sizeof (pulsedThreadTraceHeader), 1, fp) != 1) || (header.magic != kTRACE_MAGIC) || (header.version != kTRACE_VERSION) || (header.nBytes > maxBytes)){
+#if beVerbose
+		printf ("trace load error: %s is not a version %d trace, or has more than %zu bytes of records.\n", path, kTRACE_VERSION, maxBytes);
+#endif
+		fclose (fp);
+		return 1;
+	}
+	if ((header.nBytes > 0) && (fread (buffer, header.nBytes, 1, fp) != 1)){
+		fclose (fp);
+		reset ();
+		return 1;
+	}
+	fclose (fp);
+	size_t pos = 0;
+	uint32_t nRecords = 0;
+	while (pos < header.nBytes){
+		uint8_t edgeByte;
+		uint64_t delta;
+		size_t recordBytes = traceDecodeRecord (buffer, pos, header.nBytes, edgeByte, delta);
+		if (recordBytes == 0){
+			break;
+		}
+		pos += recordBytes;
+		nRecords +=1;
+	}
+	if ((pos != header.nBytes) || (nRecords != header.nEdges)){
+#if beVerbose
+		printf ("trace load error: %s has a partial or corrupt record after %d records.\n", path, nRecords);
+#endif
+		reset ();
+		return 1;
+	}
+	startUsecs.store (header.startUsecs, std::memory_order_relaxed);
+	nEdges.store (header.nEdges);
+	nDropped.store (0);
+	nBytes.store (header.nBytes, std::memory_order_release);
+	return 0;
+}
+
+/* ****************************************************************************************************
+Pattern function for replay tasks. Waits until the time of each edge, counted from the start of the task, and makes it. Edges at the same time
+are merged into one call of the output function, if there is one, else channel 0 edges call hiFunc and loFunc in the order they were recorded
+Last Modified:
+2026/10/19 - counts played edges with a relaxed atomic
+2026/10/19 - runs the edge hooks for each channel when a trace or a chain is installed
+2026/10/19 - initial version */
+void pulsedThreadReplayPattern (taskParams * theTask, pulsedThreadTimers * timers){
+	pulsedThreadReplayStructPtr replay = (pulsedThreadReplayStructPtr) theTask->patternData;
+	bool isInfinite = (theTask->nPulses == kINFINITETRAIN);
+	struct timeval startTime;
+	struct timeval deadline;
+	pulsedThreadGetTime (theTask, &startTime);
+	unsigned int iEdge = 0;
+	while (iEdge < replay->nEdges){
+		if (theTask->killThread){
+			break;
+		}
+		if (isInfinite){
+			if (!(theTask->doTask & 1)){
+				break;
+			}
+			pulsedThreadPatternMods (theTask, timers);
+		}
+		// all the edges at this time, skipping task starts
+		uint64_t edgeUsecs = replay->edges [iEdge].usecs;
+		unsigned int firstEdge = iEdge;
+		uint32_t setMask = 0;
+		uint32_t clearMask = 0;
+		bool hasEdge = false;
+		for (; (iEdge < replay->nEdges) && (replay->edges [iEdge].usecs == edgeUsecs); iEdge +=1){
+			pulsedThreadEdgePtr edge = &replay->edges [iEdge];
+			if (edge->kind == kTRACE_START){
+				continue;
+			}
+			if (replay->multiFunc != nullptr){
+				if (edge->channel < 32){
+					if (edge->kind == kTRACE_HI){
+						setMask |= (1u << edge->channel);
+					}else{
+						clearMask |= (1u << edge->channel);
+					}
+					hasEdge = true;
+				}
+			}else{
+				if (edge->channel == 0){
+					hasEdge = true;
+				}
+			}
+		}
+		if (!hasEdge){
+			continue;
+		}
+		pulsedThreadDeadline (&startTime, edgeUsecs, &deadline);
+		pulsedThreadWaitUntil (theTask, timers, &deadline);
+		if (replay->multiFunc != nullptr){
+			for (unsigned int iChan =0; ((theTask->trace != nullptr) || (theTask->chain != nullptr)) && (iChan < 32); iChan +=1){
+				if (setMask & (1u << iChan)){
+					pulsedThreadEdgeHooks (theTask, iChan, kTRACE_HI);
+				}
+				if (clearMask & (1u << iChan)){
+					pulsedThreadEdgeHooks (theTask, iChan, kTRACE_LO);
+				}
+			}
+			replay->multiFunc (theTask->taskData, setMask, clearMask);
+			replay->nPlayed.store (replay->nPlayed.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}else{
+			for (unsigned int iSame = firstEdge; iSame < iEdge; iSame +=1){
+				pulsedThreadEdgePtr edge = &replay->edges [iSame];
+				if ((edge->kind == kTRACE_START) || (edge->channel != 0)){
+					continue;
+				}
+				pulsedThreadEdgeHooks (theTask, 0, edge->kind);
+				if (edge->kind == kTRACE_HI){
+					if (theTask->hiFunc != nullptr){
+						theTask->hiFunc (theTask->taskData);
+					}
+				}else{
+					if (theTask->loFunc != nullptr){
+						theTask->loFunc (theTask->taskData);
+					}
+				}
+				replay->nPlayed.store (replay->nPlayed.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+/* ****************************************************************************************************
+Constructor makes a pulsedThread with dummy pulse timing, loads the trace, and installs the pattern function
+Last Modified:
+2026/10/19 - initial version */
+pulsedThreadReplay::pulsedThreadReplay (unsigned int gMode, pulsedThreadTrace & trace, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), void (*gMultiFunc)(void *, uint32_t, uint32_t), int gAccLevel, int &errCode) :
+	pulsedThread ((unsigned int) 0, (unsigned int) 1, (gMode == kINFINITETRAIN) ? (unsigned int) kINFINITETRAIN : (unsigned int) kPULSE, initData, initFunc, gLoFunc, gHiFunc, gAccLevel, errCode){
+	replayData.multiFunc = gMultiFunc;
+	replayData.edges = nullptr;
+	replayData.nEdges = 0;
+	replayData.nPlayed.store (0);
+	if (errCode){
+		return;
+	}
+	if (((gMode != kPULSE) && (gMode != kINFINITETRAIN)) || ((gMultiFunc == nullptr) && ((gHiFunc == nullptr) || (gLoFunc == nullptr)))){
+#if beVerbose
+		printf ("pulsedThreadReplay error: mode %d, needs either an output function, or both hi and lo functions.\n", gMode);
+#endif
+		errCode = 1;
+		return;
+	}
+	if (loadTrace (trace)){
+		errCode = 1;
+		return;
+	}
+	theTask.patternData = &replayData;
+	theTask.patternFunc = &pulsedThreadReplayPattern;
+}
+
+/* ****************************************************************************************************
+Destructor stops the thread before freeing the edges, as the pattern function reads them until the thread stops
+Last Modified:
+2026/10/19 - stops the thread first, so a replay still running never reads freed edges
+2026/10/19 - initial version */
+pulsedThreadReplay::~pulsedThreadReplay (void){
+	stopThread ();
+	if (replayData.edges != nullptr){
+		delete [] replayData.edges;
+	}
+}
+
+/* ****************************************************************************************************
+Decodes the trace into a new array of edges, and swaps it in with the mutex held when the thread is not busy
+Last Modified:
+2026/10/19 - initial version */
+int pulsedThreadReplay::loadTrace (pulsedThreadTrace & trace){
+	unsigned int nEdges = trace.getNumEdges ();
+	if (nEdges == 0){
+#if beVerbose
+		printf ("loadTrace error: trace has no edges.\n");
+#endif
+		return 1;
+	}
+	pulsedThreadEdgePtr newEdges = new pulsedThreadEdge [nEdges];
+	nEdges = trace.getEdges (newEdges, nEdges);
+	pthread_mutex_lock (&theTask.taskMutex);
+	if ((theTask.doTask != 0) || (theTask.armMode != kARM_OFF)){
+		pthread_mutex_unlock (&theTask.taskMutex);
+		delete [] newEdges;
+#if beVerbose
+		printf ("loadTrace error: trace can not be changed while thread is busy or armed.\n");
+#endif
+		return 1;
+	}
+	pulsedThreadEdgePtr oldEdges = replayData.edges;
+	replayData.edges = newEdges;
+	replayData.nEdges = nEdges;
+	pthread_mutex_unlock (&theTask.taskMutex);
+	if (oldEdges != nullptr){
+		delete [] oldEdges;
+	}
+	return 0;
+}
+
+unsigned int pulsedThreadReplay::getNumEdges (void){
+	return replayData.nEdges;
+}
+
+uint64_t pulsedThreadReplay::getNumPlayed (void){
+	return replayData.nPlayed.load (std::memory_order_relaxed);
+}
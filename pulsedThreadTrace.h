@@ -0,0 +1,93 @@
+#ifndef PULSEDTHREADTRACE_H
+#define PULSEDTHREADTRACE_H
+#include "pulsedThread.h"
+
+/* ************************************************ pulsedThreadTrace ***************************************************************
+A compact record of the edges a pulsedThread actually made. Install a trace with pulsedThread::captureTrace, and the thread records the start of
+each task and each hi and lo edge, with the time from its clock just before it calls the hi, lo, or output function. The trace is kept in a
+buffer allocated when the trace is made, so recording never allocates memory. When the buffer is full, further edges are counted but not kept.
+
+Each record is one byte with the kind of edge in the top 2 bits and the channel in the low 6 bits, followed by the microseconds since the previous
+record, as a variable length unsigned integer, 7 bits to a byte, low bits first, high bit set on all but the last byte. Edges of a train less than
+16 ms apart take 3 bytes each. Saved files start with a pulsedThreadTraceHeader, in native byte order, followed by the records.
+
+A saved trace can be loaded into a pulsedThreadReplay, which makes the same edges at the recorded times, without running the code that made them,
+e.g., endFuncs stepping through arrays. Traces made by two versions of the software can be compared with TraceDiff (traceDiff.cpp). Traces made with
+a virtual clock (pulsedThreadClock.h) do not depend on machine load, so two versions should give identical traces.
+Last Modified:
+2026/10/19 - startUsecs and the replay's nPlayed are atomic, as other threads read them, and decoding checks records against their end
+2026/10/19 - initial version */
+
+const uint32_t kTRACE_MAGIC = 0x52545450;	// "PTTR"
+const uint16_t kTRACE_VERSION = 1;
+const unsigned int kTRACE_MAX_RECORD = 11; // bytes in the longest record, 1 byte for edge and 10 bytes for a 64 bit delta
+
+/* ******************************************** start of a saved trace file ******************************************************/
+typedef struct pulsedThreadTraceHeader{
+	uint32_t magic;			// kTRACE_MAGIC
+	uint16_t version;		// kTRACE_VERSION
+	uint16_t reserved;		// 0
+	uint32_t nEdges;		// records in the file, including task starts
+	uint32_t nBytes;		// bytes of records following the header, so save refuses traces of 4 GiB or more
+	uint64_t startUsecs;	// clock time of the first record, microseconds since the epoch for real time
+}pulsedThreadTraceHeader, *pulsedThreadTraceHeaderPtr;
+
+/* ******************************************** a decoded edge ******************************************************************/
+typedef struct pulsedThreadEdge{
+	uint64_t usecs;			// time from first record of the trace, in microseconds
+	unsigned int channel;	// 0 for a pulsedThread, channel number for a pulsedThreadMulti
+	int kind;				// kTRACE_LO, kTRACE_HI, or kTRACE_START
+}pulsedThreadEdge, *pulsedThreadEdgePtr;
+
+class pulsedThreadTrace{
+	public:
+		pulsedThreadTrace (size_t maxBytes); // maxBytes of records can be kept
+		~pulsedThreadTrace (void);
+		void reset (void); // forgets all records. Must not be called while the trace is installed in a busy thread
+		unsigned int getNumEdges (void); // number of records kept
+		size_t getNumBytes (void); // bytes of records kept
+		uint64_t getNumDropped (void); // number of records not kept because the buffer was full
+		uint64_t getStartUsecs (void); // clock time of the first record
+		unsigned int getEdges (pulsedThreadEdgePtr edges, unsigned int maxEdges); // decodes records into edges, returns number decoded
+		int save (const char * path); // writes header and records to a file, returns 1 on error, or if records are too big for the header
+		int load (const char * path); // replaces records with those from a file saved with save, returns 1 on error, e.g., records too big for buffer, or partial or corrupt
+	private:
+		friend void pulsedThreadTraceRecord (pulsedThreadTrace * trace, taskParams * theTask, unsigned int channel, int kind);
+		uint8_t * buffer;
+		size_t maxBytes;
+		std::atomic<size_t> nBytes; // bytes of complete records, stored by the recording thread after it writes each record
+		std::atomic<unsigned int> nEdges;
+		std::atomic<uint64_t> nDropped;
+		std::atomic<uint64_t> startUsecs; // stored by the recording thread at the first record, read by getStartUsecs
+		uint64_t lastUsecs; // time of last record, used only by recording thread
+};
+
+/* ***************************************** pattern data for replaying a trace ***************************************************/
+typedef struct pulsedThreadReplayStruct{
+	void (*multiFunc)(void *, uint32_t, uint32_t); // output function for channels 0-31, gets taskData, mask of channels to set, mask of channels to clear, or nullptr to call hiFunc and loFunc for channel 0
+	pulsedThreadEdgePtr edges; // decoded edges to play
+	unsigned int nEdges;
+	std::atomic<uint64_t> nPlayed; // number of edges made, written by the thread, read by getNumPlayed
+}pulsedThreadReplayStruct, *pulsedThreadReplayStructPtr;
+
+void pulsedThreadReplayPattern (taskParams * theTask, pulsedThreadTimers * timers); // the pattern function
+
+/* ************************************************ pulsedThreadReplay ***************************************************************
+A pulsedThread that plays back the edges of a trace at the recorded times, counted from the start of the task. Made with kPULSE, the trace is
+played once for each task requested with DoTask/DoTasks. Made with kINFINITETRAIN, the trace is played from startInfiniteTrain, and each time
+the pattern returns, as soon as the last edge is made, it is played again, with times counted from when the pattern starts again, so the
+last edge is followed by the first edge after the time of the first edge in the trace, until stopInfiniteTrain. Task starts in the trace are not played, but keep their times, so a trace of several tasks
+plays with the same gaps between tasks. Without an output function, channel 0 edges call hiFunc and loFunc and other channels are not played.
+With an output function, edges of channels 0-31 at the same time are merged into one call, as for a pulsedThreadMulti. The endFunc is not run */
+class pulsedThreadReplay : public pulsedThread{
+	public:
+		pulsedThreadReplay (unsigned int gMode, pulsedThreadTrace & trace, void * initData, int (*initFunc)(void *, void * &), void (*gLoFunc)(void *), void (*gHiFunc)(void *), void (*gMultiFunc)(void *, uint32_t, uint32_t), int gAccLevel, int &errCode);
+		~pulsedThreadReplay (void);
+		int loadTrace (pulsedThreadTrace & trace); // replaces edges to play with those from trace, returns 1 if thread is busy or armed, or trace has no edges
+		unsigned int getNumEdges (void); // number of edges in the loaded trace, including task starts
+		uint64_t getNumPlayed (void); // number of edges made since thread was made
+	protected:
+		pulsedThreadReplayStruct replayData;
+};
+
+#endif // PULSEDTHREADTRACE_H
@@ -11,7 +11,7 @@ static PyObject* pulsedThreadPy_p (PyObject *self, PyObject *args) {
 	unsigned int lowTicks ;			// low time in microseconds
 	unsigned int highTicks ;		// high time in microseconds
 	unsigned int nPulses;
-	int accLevel;			// accuracy level, 0,1,2 as usual
+	int accLevel;			// accuracy level, 0,1,2 as usual, or 3 for auto
 	if (!PyArg_ParseTuple(args,"Oiiii", &PyObjPtr, &lowTicks, &highTicks, &nPulses, &accLevel)) {
 		PyErr_SetString (PyExc_RuntimeError, "Could not parse input for Python object pointer, low ticks, high ticks, number of pulses, and timing method.");
 		return NULL;
@@ -35,7 +35,7 @@ static PyObject* pulsedThreadPy_f (PyObject *self, PyObject *args) {
 	float frequency;		// frequency in HZ
 	float dutyCycle;		// Duty-cycle (0-1)
 	float trainDur;			//train duration in seconds
-	int accLevel;			// accuracy level, 0,1,2 as usual
+	int accLevel;			// accuracy level, 0,1,2 as usual, or 3 for auto
 	if (!PyArg_ParseTuple(args,"Offfi", &PyObjPtr, &frequency, &dutyCycle, &trainDur, &accLevel)) {
 		PyErr_SetString (PyExc_RuntimeError, "Could not parse input for Python object pointer, frequency, duty cycle, train duration, and timing method.");
 		return NULL;
@@ -50,7 +50,87 @@ static PyObject* pulsedThreadPy_f (PyObject *self, PyObject *args) {
 	return PyCapsule_New (static_cast <void *>(threadObj), "pulsedThread", pulsedThread_del);
 }
 
-  /* Module method table - the first 25 methods are defined in pyPulsedThread.h*/
+/**********************************************************************************************************************************
+These 2 functions make a pulsedThread object that writes to a native sink, a file descriptor, register block, or shared memory, so the
+thread never calls Python or takes the GIL. The sink is a tuple of (kind, target, hiValue, loValue, width, hiOffset, loOffset, mapSize, mapOffset),
+see pulsedThread_parseSink */
+
+// Makes a pulsedThread that writes to a native sink, initialized with arguments for pulse delay/duration and number of pulses
+static PyObject* pulsedThreadSinkPy_p (PyObject *self, PyObject *args) {
+	PyObject *sinkTuple;
+	unsigned int lowTicks ;			// low time in microseconds
+	unsigned int highTicks ;		// high time in microseconds
+	unsigned int nPulses;
+	int accLevel;			// accuracy level, 0,1,2 as usual, or 3 for auto
+	if (!PyArg_ParseTuple(args,"O!IIIi", &PyTuple_Type, &sinkTuple, &lowTicks, &highTicks, &nPulses, &accLevel)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse input for sink tuple, low ticks, high ticks, number of pulses, and timing method.");
+		return NULL;
+	}
+	pulsedThreadSinkConfig config;
+	if (pulsedThread_parseSink (sinkTuple, config)){
+		return NULL;
+	}
+	int errCode =0;
+	pulsedThread * threadObj = new pulsedThreadSinkThread (lowTicks, highTicks, nPulses, config, accLevel, errCode);
+	if (errCode){
+		PyErr_SetString (PyExc_RuntimeError, "Could not make a new pulsedThread object with the sink.");
+		return NULL;
+	}
+	return PyCapsule_New (static_cast <void *>(threadObj), "pulsedThread", pulsedThread_del);
+}
+
+// Makes a pulsedThread that writes to a native sink, with arguments for frequency, duty-cycle, and train duration
+static PyObject* pulsedThreadSinkPy_f (PyObject *self, PyObject *args) {
+	PyObject *sinkTuple;
+	float frequency;		// frequency in HZ
+	float dutyCycle;		// Duty-cycle (0-1)
+	float trainDur;			//train duration in seconds
+	int accLevel;			// accuracy level, 0,1,2 as usual, or 3 for auto
+	if (!PyArg_ParseTuple(args,"O!fffi", &PyTuple_Type, &sinkTuple, &frequency, &dutyCycle, &trainDur, &accLevel)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse input for sink tuple, frequency, duty cycle, train duration, and timing method.");
+		return NULL;
+	}
+	pulsedThreadSinkConfig config;
+	if (pulsedThread_parseSink (sinkTuple, config)){
+		return NULL;
+	}
+	int errCode =0;
+	pulsedThread * threadObj = new pulsedThreadSinkThread (frequency, dutyCycle, trainDur, config, accLevel, errCode);
+	if (errCode){
+		PyErr_SetString (PyExc_RuntimeError, "Could not make a new pulsedThread object with the sink.");
+		return NULL;
+	}
+	return PyCapsule_New (static_cast <void *>(threadObj), "pulsedThread", pulsedThread_del);
+}
+
+/**********************************************************************************************************************************
+Makes a pulsedThreadSampler that reads a file descriptor or mapped memory at a fixed rate into a ring, read from Python with getSampleView,
+peekSamples, and releaseSamples, or drainSamples. The source is a tuple of (kind, target, width, offset, mapSize, mapOffset), see
+pulsedThread_parseSamplerSource. nSamples is samples per task, or 0 to sample from startTrain to stopTrain */
+static PyObject* pulsedThreadSamplerPy (PyObject *self, PyObject *args) {
+	PyObject *sourceTuple;
+	unsigned int periodUsecs;
+	unsigned int nSamples;
+	unsigned int ringSize;
+	int accLevel;			// accuracy level, 0,1,2 as usual, or 3 for auto
+	if (!PyArg_ParseTuple(args,"O!IIIi", &PyTuple_Type, &sourceTuple, &periodUsecs, &nSamples, &ringSize, &accLevel)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse input for source tuple, period, number of samples, ring size, and timing method.");
+		return NULL;
+	}
+	pulsedThreadSamplerSource source;
+	if (pulsedThread_parseSamplerSource (sourceTuple, source)){
+		return NULL;
+	}
+	int errCode =0;
+	pulsedThreadSampler * threadObj = new pulsedThreadSampler (nSamples, periodUsecs, ringSize, source, nullptr, nullptr, nullptr, accLevel, errCode);
+	if (errCode){
+		PyErr_SetString (PyExc_RuntimeError, "Could not make a new pulsedThreadSampler object.");
+		return NULL;
+	}
+	return PyCapsule_New (static_cast <void *>(static_cast <pulsedThread *>(threadObj)), "pulsedThread", pulsedThread_del);
+}
+
+  /* Module method table - the first 36 methods are defined in pyPulsedThread.h*/
 static PyMethodDef ptPyFuncsMethods[]= {	
 	{"isBusy", pulsedThread_isBusy, METH_O, "(PyCapsule) returns number of tasks a thread has left to do, 0 means finished all tasks"},
 	//{"waitOnBusy", pulsedThread_waitOnBusy, METH_VARARGS, " (PyCapsule, timeOutSecs) Returns when a thread is no longer busy, or after timeOutSecs"},
@@ -59,12 +139,35 @@ static PyMethodDef ptPyFuncsMethods[]= {
 	{"unDoTasks", pulsedThread_unDoTasks, METH_O, "(PyCapsule) Tells the pulsedThread object to stop doing however many task it was asked to do"},
 	{"startTrain", pulsedThread_startTrain, METH_O, "(PyCapsule) Tells a pulsedThread object configured as an infinite train to start"},
 	{"stopTrain", pulsedThread_stopTrain, METH_O, "(PyCapsule) Tells a pulsedThread object configured as an infinite train to stop"},
+	{"arm", pulsedThread_arm, METH_VARARGS, "(PyCapsule, spinMode) Thread spins waiting for next task, spinMode 1 = spin, 2 = spin with pause, 3 = spin with yield"},
+	{"disarm", pulsedThread_disarm, METH_O, "(PyCapsule) Thread goes back to sleeping while waiting for next task"},
+	{"getTriggerLatency", pulsedThread_getTriggerLatency, METH_O, "(PyCapsule) returns (last, min, max) nanoseconds from doTask to first edge of task for an armed thread, and number of triggered tasks"},
+	{"setTriggerFd", pulsedThread_setTriggerFd, METH_VARARGS, "(PyCapsule, fd, fdMode) Thread starts a task on each event on fd, -1 to stop, fdMode 0 = eventfd, 1 = pipe, 2 = GPIO line request"},
+	{"getFdTriggerStats", pulsedThread_getFdTriggerStats, METH_O, "(PyCapsule) returns (last, min, max) nanoseconds from event on trigger fd to first edge of task, number of triggered tasks, and number of missed events"},
+	{"setEndFuncOffload", pulsedThread_setEndFuncOffload, METH_VARARGS, "(PyCapsule, isOffloaded) runs endFuncs on a companion thread, so they never delay an edge, returns 1 if thread is busy or armed"},
+	{"getEndFuncOffloadStats", pulsedThread_getEndFuncOffloadStats, METH_O, "(PyCapsule) returns (number of endFuncs run by companion thread, number dropped because its queue was full)"},
+	{"setCpuAccounting", pulsedThread_setCpuAccounting, METH_VARARGS, "(PyCapsule, isAccounting) starts CPU cost accounting from zero, or stops it, returns 1 if thread is busy or armed"},
+	{"getCpuStats", pulsedThread_getCpuStats, METH_O, "(PyCapsule) returns a dictionary of seconds spinning, sleeping, in callbacks, and idle, with CPU seconds, and number of tasks, or None if not accounting"},
+	{"getAutoChoice", pulsedThread_getAutoChoice, METH_O, "(PyCapsule) returns (delay choice, duration choice), 0 = sleeps, 1 = sleeps and spins, 2 = spins, for a thread made with accLevel 3, or None"},
+	{"getHostLatency", pulsedThread_getHostLatency, METH_NOARGS, "() returns host wake-up latency in microseconds used by accLevel 3, measuring it on first call"},
+	{"setHostLatency", pulsedThread_setHostLatency, METH_VARARGS, "(latencyUsecs) sets host wake-up latency used by accLevel 3 threads, 0 to measure it again now"},
+	{"setTimerSlack", pulsedThread_setTimerSlack, METH_VARARGS, "(PyCapsule, slackNsecs) timer slack the thread gives itself at the start of each task, 0 for default, no effect on real-time threads, returns 1 if thread is busy or armed"},
+	{"setCoalescing", pulsedThread_setCoalescing, METH_VARARGS, "(PyCapsule, toleranceUsecs) moves sleep-only wake-ups up to toleranceUsecs to the shared tick, 0 to not coalesce, returns 1 if thread is busy or armed"},
+	{"setCoalesceTick", pulsedThread_setCoalesceTick, METH_VARARGS, "(tickUsecs) sets the shared tick that coalescing threads wake on, default 1000, returns 1 if tick is 0"},
+	{"setSpinCore", pulsedThread_setSpinCore, METH_VARARGS, "(PyCapsule, core, refuseWarnings) pins thread to core, -1 for least loaded core, returns (status, core), status 1 = may overlap, 2 = overloaded, -1 = refused"},
+	{"getSpinLoad", pulsedThread_getSpinLoad, METH_VARARGS, "(core) returns (projected fraction of core spent spinning, number of thread pairs whose spin windows may overlap)"},
+	{"getSpinOverlaps", pulsedThread_getSpinOverlaps, METH_O, "(PyCapsule) returns (number of spin windows that overlapped another thread on same core, number of spin windows)"},
+	{"prefillPool", pulsedThread_prefillPool, METH_VARARGS, "(nThreads) makes pthreads ahead of time for pulsedThreads to borrow, returns number that could not be made"},
+	{"setPoolStack", pulsedThread_setPoolStack, METH_VARARGS, "(stackBytes, guardBytes) sets stack size for pthreads made for the pool from now on, 0 for system default"},
+	{"getPoolStackUsed", pulsedThread_getPoolStackUsed, METH_NOARGS, "() returns (deepest stack used by a task so far, stack size for new pool pthreads), in bytes"},
 	{"modDelay", pulsedThread_modDelay, METH_VARARGS, "(PyCapsule, newDelaySecs) changes the delay period of a pulse or LOW period of a train"},
 	{"modDur", pulsedThread_modDur, METH_VARARGS, "(PyCapsule, newDurationSecs) changes the delay period of a pulse or HIGH period of a train"},
 	{"modTrainLength", pulsedThread_modTrainLength, METH_VARARGS, "(PyCapsule, newTrainLength) changes the number of pulses of a train"},
 	{"modTrainDur", pulsedThread_modTrainDur, METH_VARARGS, "(PyCapsule, newTrainDurSecs) changes the total duration of a train"},
 	{"modTrainFreq", pulsedThread_modFreq, METH_VARARGS, "(PyCapsule, newTrainFequency) changes the frequency of a train"},
 	{"modTrainDuty", pulsedThread_modDutyCycle, METH_VARARGS, "(PyCapsule, newTrainDutyCycle) changes the duty cycle of a train"},
+	{"modTiming", pulsedThread_modTiming, METH_VARARGS, "(PyCapsule, newDelaySecs, newDurationSecs, newTrainLength) changes delay, duration, and number of pulses together"},
+	{"modTrainTiming", pulsedThread_modTrainTiming, METH_VARARGS, "(PyCapsule, newTrainFrequency, newTrainDutyCycle, newTrainDurSecs) changes frequency, duty cycle, and duration of a train together"},
 	{"getPulseDelay", pulsedThread_getPulseDelay, METH_O, "(PyCapsule) returns pulse delay, in seconds"},
 	{"getPulseDuration", pulsedThread_getPulseDuration, METH_O, "(PyCapsule) returns pulse duration, in seconds"},
 	{"getPulseNumber", pulsedThread_getPulseNumber, METH_O, "(PyCapsule) returns number of pulses in a train, 1 for a single pulse, or 0 for an infinite train"},
@@ -82,6 +185,20 @@ static PyMethodDef ptPyFuncsMethods[]= {
 	
 	{"initByPulse", pulsedThreadPy_p, METH_VARARGS, "Returns a new pulsedThread object that calls your objects HiFunc and LoFunc methods"},
 	{"initByFreq", pulsedThreadPy_f, METH_VARARGS, "Returns a new pulsedThread object that calls your objects HiFunc and LoFunc methods"},
+	{"initSinkByPulse", pulsedThreadSinkPy_p, METH_VARARGS, "(sink, lowTicks, highTicks, nPulses, accLevel) Returns a new pulsedThread object that writes to a native sink, sink = (kind, path or fd, hiValue, loValue, width = 1, hiOffset = 0, loOffset = 0, mapSize = 4096, mapOffset = 0), kind 0 = fd, 1 = mmap set/clear registers, 2 = mmap set/clear bits, 3 = shared memory toggle"},
+	{"initSinkByFreq", pulsedThreadSinkPy_f, METH_VARARGS, "(sink, frequency, dutyCycle, trainDuration, accLevel) Returns a new pulsedThread object that writes to a native sink, sink as for initSinkByPulse"},
+	{"initSampler", pulsedThreadSamplerPy, METH_VARARGS, "(source, periodUsecs, nSamples, ringSize, accLevel) Returns a new pulsedThread object that samples a source into a ring, source = (kind, path or fd, width = 4, offset = 0, mapSize = 4096, mapOffset = 0), kind 1 = fd, 2 = mmap, nSamples 0 = from startTrain to stopTrain"},
+	{"getSampleView", pulsedThread_getSampleView, METH_O, "(PyCapsule) returns a read only memoryview of a sampler's ring of 16 byte samples, for numpy.frombuffer (view, dtype=[('nsecs', '<u8'), ('value', '<i8')])"},
+	{"peekSamples", pulsedThread_peekSamples, METH_O, "(PyCapsule) returns (number of first sample ready to read, number of samples ready), sample n is at index n % ring size of the sample view"},
+	{"releaseSamples", pulsedThread_releaseSamples, METH_VARARGS, "(PyCapsule, nSamples) frees the oldest nSamples samples, after reading them from the sample view"},
+	{"drainSamples", pulsedThread_drainSamples, METH_VARARGS, "(PyCapsule, buffer) copies as many of the oldest samples as fit into a writable buffer and frees them, returns number copied"},
+	{"getSamplerStats", pulsedThread_getSamplerStats, METH_O, "(PyCapsule) returns (number of samples pushed, number dropped because ring was full, number of failed reads)"},
+	{"controlServe", pulsedThread_controlServe, METH_VARARGS, "(PyCapsule, name) makes a shared memory control segment, e.g., '/rig1_laser', so other processes can control the thread, returns a capsule that removes it when deleted"},
+	{"controlOpen", pulsedThread_controlOpen, METH_VARARGS, "(name) opens a control segment made by controlServe in any process, returns a client capsule"},
+	{"controlPost", pulsedThread_controlPost, METH_VARARGS, "(client, op, uArg = 0, fArg = 0.0) posts a command, 0 = doTasks, 1 = unDoTasks, 2 = startTrain, 3 = stopTrain, 4 = modDelay, 5 = modDur, 6 = modTrainLength (uArg, microseconds or number), 7 = modTrainFreq, 8 = modTrainDuty, 9 = modTrainDur (fArg), 10 = arm (uArg spin mode), 11 = disarm, returns ticket, or 0 if ring is full"},
+	{"controlWait", pulsedThread_controlWait, METH_VARARGS, "(client, ticket, timeOutSecs) waits for a posted command, returns (1 if timed out, 0 if done, -1 if done but result overwritten, result)"},
+	{"controlStatus", pulsedThread_controlStatus, METH_O, "(client) returns a dictionary of the status of the controlled thread, and numbers of commands done and failed"},
+	{"getSinkErrors", pulsedThread_getSinkErrors, METH_O, "(PyCapsule) returns number of failed writes of a thread made with initSinkByPulse or initSinkByFreq"},
 	{ NULL, NULL, 0, NULL}
   };
   
@@ -97,5 +214,13 @@ static PyMethodDef ptPyFuncsMethods[]= {
   /* Module initialization function */
   PyMODINIT_FUNC
   PyInit_ptPyFuncs(void) {
-    return PyModule_Create(&ptPyFuncsModule);
+    PyObject * module = PyModule_Create(&ptPyFuncsModule);
+#if PY_VERSION_HEX >= 0x03070000
+    // add the PulsedThread type, with fast-call methods, for wrapping capsules from initByPulse and initByFreq
+    if ((module != NULL) && (pulsedThread_addType (module) < 0)){
+      Py_DECREF (module);
+      return NULL;
+    }
+#endif
+    return module;
   } 
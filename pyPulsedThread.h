@@ -2,6 +2,11 @@
 #define PYPULSEDTHREAD_H
 #include <Python.h>
 #include <pulsedThread.h>
+#include <pulsedThreadSpinCoordinator.h>
+#include <pulsedThreadPool.h>
+#include <pulsedThreadSink.h>
+#include <pulsedThreadSampler.h>
+#include <pulsedThreadControl.h>
 
 /*****************************************************************************************************************
 pyPulsedThread is code you can use to to wrap the C++ pulsedThread class into a Python external module. 
@@ -77,6 +82,560 @@ static PyObject* pulsedThread_stopTrain (PyObject *self, PyObject *PyPtr) {
     Py_RETURN_NONE;
 }
 
+/* pulsedThread_arm tells the pulsedThread object to spin waiting for a task, for low latency starts. spinMode is 1, 2, or 3 for spin, spin with pause, or spin with yield*/
+static PyObject* pulsedThread_arm (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	int spinMode;
+	if (!PyArg_ParseTuple(args,"Oi", &PyPtr, &spinMode)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and spin mode.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return Py_BuildValue("i", threadPtr -> arm (spinMode));
+}
+
+/* pulsedThread_disarm tells an armed pulsedThread object to go back to sleeping while waiting for a task */
+static PyObject* pulsedThread_disarm (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	threadPtr->disarm();
+	Py_RETURN_NONE;
+}
+
+/* returns a tuple of (last, min, max) trigger to first edge latency in nanoseconds, and number of triggered tasks */
+static PyObject* pulsedThread_getTriggerLatency (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	uint64_t minNsecs;
+	uint64_t maxNsecs;
+	uint64_t nTriggers = threadPtr->getTriggerLatencyStats (minNsecs, maxNsecs);
+	return Py_BuildValue("KKKK", (unsigned long long) threadPtr->getTriggerLatency(), (unsigned long long) minNsecs, (unsigned long long) maxNsecs, (unsigned long long) nTriggers);
+}
+
+/* pulsedThread_setTriggerFd gives the thread a file descriptor, e.g., from os.eventfd or os.pipe, to start a task on each event, fd = -1 to stop.
+fdMode is 0 for eventfd, 1 for pipe, 2 for GPIO line request */
+static PyObject* pulsedThread_setTriggerFd (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	int fd;
+	int fdMode;
+	if (!PyArg_ParseTuple(args,"Oii", &PyPtr, &fd, &fdMode)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer, fd, and fd mode.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return Py_BuildValue("i", threadPtr -> setTriggerFd (fd, fdMode));
+}
+
+/* returns a tuple of (last, min, max) event to first edge latency in nanoseconds, number of tasks triggered by the trigger fd, and number of missed events */
+static PyObject* pulsedThread_getFdTriggerStats (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	uint64_t minNsecs;
+	uint64_t maxNsecs;
+	uint64_t nMissed;
+	uint64_t nTriggers = threadPtr->getFdTriggerStats (minNsecs, maxNsecs, nMissed);
+	return Py_BuildValue("KKKKK", (unsigned long long) threadPtr->getFdTriggerLatency(), (unsigned long long) minNsecs, (unsigned long long) maxNsecs, (unsigned long long) nTriggers, (unsigned long long) nMissed);
+}
+
+/* pulsedThread_parseSink fills a sink config from a Python tuple of (kind, target, hiValue, loValue, width = 1, hiOffset = 0, loOffset = 0,
+mapSize = 4096, mapOffset = 0), target a path or a file descriptor, for a module's init function to make a pulsedThread with a native sink.
+Returns 0, or -1 with a Python error set. A path stays valid as long as the tuple does */
+static int pulsedThread_parseSink (PyObject * sinkTuple, pulsedThreadSinkConfig & config){
+	PyObject * target;
+	unsigned int hiValue;
+	unsigned int loValue;
+	unsigned int width = 1;
+	unsigned int hiOffset = 0;
+	unsigned int loOffset = 0;
+	Py_ssize_t mapSize = 4096;
+	long long mapOffset = 0;
+	if (!PyArg_ParseTuple(sinkTuple,"iOII|IIInL", &config.kind, &target, &hiValue, &loValue, &width, &hiOffset, &loOffset, &mapSize, &mapOffset)) {
+		return -1;
+	}
+	if (PyUnicode_Check (target)){
+		config.path = PyUnicode_AsUTF8 (target);
+		if (config.path == NULL){
+			return -1;
+		}
+		config.fd = -1;
+	}else{
+		config.path = nullptr;
+		config.fd = PyObject_AsFileDescriptor (target);
+		if (config.fd < 0){
+			return -1;
+		}
+	}
+	config.hiValue = hiValue;
+	config.loValue = loValue;
+	config.width = width;
+	config.hiOffset = hiOffset;
+	config.loOffset = loOffset;
+	config.mapSize = (size_t) mapSize;
+	config.mapOffset = (off_t) mapOffset;
+	return 0;
+}
+
+/* returns number of failed writes of a pulsedThread made with a native sink, or raises TypeError for any other pulsedThread */
+static PyObject* pulsedThread_getSinkErrors (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	pulsedThreadSinkThread * sinkPtr = dynamic_cast<pulsedThreadSinkThread *> (threadPtr);
+	if (sinkPtr == nullptr){
+		PyErr_SetString (PyExc_TypeError, "The pulsedThread does not write to a sink.");
+		return NULL;
+	}
+	return Py_BuildValue("K", (unsigned long long) sinkPtr->getSinkErrors ());
+}
+
+/* pulsedThread_parseSamplerSource fills a sampler source from a Python tuple of (kind, target, width = 4, offset = 0, mapSize = 4096, mapOffset = 0),
+kind 1 for a file descriptor or 2 for mapped memory, target a path or a file descriptor. Returns 0, or -1 with a Python error set */
+static int pulsedThread_parseSamplerSource (PyObject * sourceTuple, pulsedThreadSamplerSource & source){
+	PyObject * target;
+	unsigned int width = 4;
+	unsigned int offset = 0;
+	Py_ssize_t mapSize = 4096;
+	long long mapOffset = 0;
+	if (!PyArg_ParseTuple(sourceTuple,"iO|IInL", &source.kind, &target, &width, &offset, &mapSize, &mapOffset)) {
+		return -1;
+	}
+	if (source.kind == kSAMPLE_FUNC){
+		PyErr_SetString (PyExc_ValueError, "A sampler made from Python reads a file descriptor (kind 1) or mapped memory (kind 2).");
+		return -1;
+	}
+	if (PyUnicode_Check (target)){
+		source.path = PyUnicode_AsUTF8 (target);
+		if (source.path == NULL){
+			return -1;
+		}
+		source.fd = -1;
+	}else{
+		source.path = nullptr;
+		source.fd = PyObject_AsFileDescriptor (target);
+		if (source.fd < 0){
+			return -1;
+		}
+	}
+	source.width = width;
+	source.offset = offset;
+	source.mapSize = (size_t) mapSize;
+	source.mapOffset = (off_t) mapOffset;
+	return 0;
+}
+
+/* the pulsedThreadSampler in a capsule, or nullptr with a Python error set if the capsule holds some other kind of pulsedThread */
+static pulsedThreadSampler * pulsedThread_getSampler (PyObject * PyPtr){
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	pulsedThreadSampler * samplerPtr = dynamic_cast<pulsedThreadSampler *> (threadPtr);
+	if (samplerPtr == nullptr){
+		PyErr_SetString (PyExc_TypeError, "The pulsedThread is not a sampler.");
+	}
+	return samplerPtr;
+}
+
+/* Sample ring exporter, a Python object that exports the memory of a sampler's ring with the buffer protocol, read only, and holds a reference to
+the capsule, so the ring lives as long as any memoryview or numpy array made on it */
+typedef struct {
+	PyObject_HEAD
+	PyObject * capsule;
+	void * ring;
+	Py_ssize_t nBytes;
+} pulsedThreadRingObject;
+
+static int pulsedThreadRing_getBuffer (PyObject * self, Py_buffer * view, int flags){
+	pulsedThreadRingObject * ringObj = (pulsedThreadRingObject *) self;
+	return PyBuffer_FillInfo (view, self, ringObj->ring, ringObj->nBytes, 1, flags);
+}
+
+static void pulsedThreadRing_dealloc (pulsedThreadRingObject * self){
+	Py_XDECREF (self->capsule);
+	Py_TYPE (self)->tp_free ((PyObject *) self);
+}
+
+static PyBufferProcs pulsedThreadRingBufferProcs = {pulsedThreadRing_getBuffer, NULL};
+static PyTypeObject pulsedThreadRingType = {PyVarObject_HEAD_INIT (NULL, 0)};
+
+/* returns a read only memoryview of a sampler's ring, with no copy, e.g., for numpy.frombuffer (view, dtype=[('nsecs', '<u8'), ('value', '<i8')]).
+Sample n is at index n % ringSize, ringSize = len (view) // 16. Read the samples given by peekSamples, then free them with releaseSamples */
+static PyObject* pulsedThread_getSampleView (PyObject *self, PyObject *PyPtr) {
+	pulsedThreadSampler * samplerPtr = pulsedThread_getSampler (PyPtr);
+	if (samplerPtr == nullptr){
+		return NULL;
+	}
+	if (pulsedThreadRingType.tp_name == NULL){
+		pulsedThreadRingType.tp_name = "pulsedThread.SampleRing";
+		pulsedThreadRingType.tp_doc = "memory of the sample ring of a pulsedThreadSampler";
+		pulsedThreadRingType.tp_basicsize = sizeof (pulsedThreadRingObject);
+		pulsedThreadRingType.tp_flags = Py_TPFLAGS_DEFAULT;
+		pulsedThreadRingType.tp_dealloc = (destructor) pulsedThreadRing_dealloc;
+		pulsedThreadRingType.tp_as_buffer = &pulsedThreadRingBufferProcs;
+	}
+	if (PyType_Ready (&pulsedThreadRingType) < 0){
+		return NULL;
+	}
+	pulsedThreadRingObject * ringObj = PyObject_New (pulsedThreadRingObject, &pulsedThreadRingType);
+	if (ringObj == NULL){
+		return NULL;
+	}
+	unsigned int ringSize;
+	ringObj->ring = samplerPtr->getRing (ringSize);
+	ringObj->nBytes = (Py_ssize_t) ringSize * sizeof (pulsedThreadSample);
+	Py_INCREF (PyPtr);
+	ringObj->capsule = PyPtr;
+	PyObject * view = PyMemoryView_FromObject ((PyObject *) ringObj);
+	Py_DECREF (ringObj);
+	return view;
+}
+
+/* returns a tuple of number of first sample ready to read in place, and number of samples ready */
+static PyObject* pulsedThread_peekSamples (PyObject *self, PyObject *PyPtr) {
+	pulsedThreadSampler * samplerPtr = pulsedThread_getSampler (PyPtr);
+	if (samplerPtr == nullptr){
+		return NULL;
+	}
+	uint64_t firstSample;
+	unsigned int nReady = samplerPtr->peekSamples (firstSample);
+	return Py_BuildValue("KI", (unsigned long long) firstSample, nReady);
+}
+
+static PyObject* pulsedThread_releaseSamples (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	unsigned int nSamples;
+	if (!PyArg_ParseTuple(args,"OI", &PyPtr, &nSamples)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and number of samples.");
+		return NULL;
+	}
+	pulsedThreadSampler * samplerPtr = pulsedThread_getSampler (PyPtr);
+	if (samplerPtr == nullptr){
+		return NULL;
+	}
+	samplerPtr->releaseSamples (nSamples);
+	Py_RETURN_NONE;
+}
+
+/* copies as many of the oldest samples as fit into a writable buffer, e.g., a numpy array of 16 byte records, and frees them. Returns number copied */
+static PyObject* pulsedThread_drainSamples (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	PyObject *bufferObj;
+	if (!PyArg_ParseTuple(args,"OO", &PyPtr, &bufferObj)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and buffer.");
+		return NULL;
+	}
+	pulsedThreadSampler * samplerPtr = pulsedThread_getSampler (PyPtr);
+	if (samplerPtr == nullptr){
+		return NULL;
+	}
+	Py_buffer buffer;
+	if (PyObject_GetBuffer (bufferObj, &buffer, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) == -1){
+		return NULL;
+	}
+	unsigned int nSamples;
+	Py_BEGIN_ALLOW_THREADS
+	nSamples = samplerPtr->drainSamples ((pulsedThreadSamplePtr) buffer.buf, (unsigned int)(buffer.len / sizeof (pulsedThreadSample)));
+	Py_END_ALLOW_THREADS
+	PyBuffer_Release (&buffer);
+	return Py_BuildValue("I", nSamples);
+}
+
+/* returns a tuple of numbers of samples pushed into the ring, dropped because the ring was full, and failed reads */
+static PyObject* pulsedThread_getSamplerStats (PyObject *self, PyObject *PyPtr) {
+	pulsedThreadSampler * samplerPtr = pulsedThread_getSampler (PyPtr);
+	if (samplerPtr == nullptr){
+		return NULL;
+	}
+	uint64_t nDropped;
+	uint64_t nErrors;
+	uint64_t nWritten = samplerPtr->getSamplerStats (nDropped, nErrors);
+	return Py_BuildValue("KKK", (unsigned long long) nWritten, (unsigned long long) nDropped, (unsigned long long) nErrors);
+}
+
+/* deletes a pulsedThreadControl before releasing the pulsedThread capsule it controls, kept as the capsule context */
+static void pulsedThread_controlDel (PyObject * PyPtr){
+	PyObject * threadCapsule = static_cast<PyObject *> (PyCapsule_GetContext (PyPtr));
+	delete static_cast<pulsedThreadControl *> (PyCapsule_GetPointer (PyPtr, "pulsedThreadControl"));
+	Py_XDECREF (threadCapsule);
+}
+
+static void pulsedThread_controlClientDel (PyObject * PyPtr){
+	delete static_cast<pulsedThreadControlClient *> (PyCapsule_GetPointer (PyPtr, "pulsedThreadControlClient"));
+}
+
+/* makes a shared memory control plane for a pulsedThread, returns a capsule that keeps the segment, and the thread, until it is deleted */
+static PyObject* pulsedThread_controlServe (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	const char * name;
+	if (!PyArg_ParseTuple(args,"Os", &PyPtr, &name)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and shared memory name.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	if (threadPtr == nullptr){
+		return NULL;
+	}
+	int errCode = 0;
+	pulsedThreadControl * controlPtr = new pulsedThreadControl (threadPtr, name, errCode);
+	if (errCode){
+		delete controlPtr;
+		PyErr_SetString (PyExc_RuntimeError, "Could not make shared memory control segment.");
+		return NULL;
+	}
+	PyObject * controlCapsule = PyCapsule_New (static_cast <void *>(controlPtr), "pulsedThreadControl", pulsedThread_controlDel);
+	if (controlCapsule == NULL){
+		delete controlPtr;
+		return NULL;
+	}
+	Py_INCREF (PyPtr);
+	PyCapsule_SetContext (controlCapsule, PyPtr);
+	return controlCapsule;
+}
+
+/* opens a control segment made by controlServe, in this process or another */
+static PyObject* pulsedThread_controlOpen (PyObject *self, PyObject *args) {
+	const char * name;
+	if (!PyArg_ParseTuple(args,"s", &name)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse argument for shared memory name.");
+		return NULL;
+	}
+	int errCode = 0;
+	pulsedThreadControlClient * clientPtr = new pulsedThreadControlClient (name, errCode);
+	if (errCode){
+		delete clientPtr;
+		PyErr_SetString (PyExc_RuntimeError, "Could not open shared memory control segment.");
+		return NULL;
+	}
+	return PyCapsule_New (static_cast <void *>(clientPtr), "pulsedThreadControlClient", pulsedThread_controlClientDel);
+}
+
+/* posts a command, returns its ticket, or 0 if the ring is full or the command is not valid */
+static PyObject* pulsedThread_controlPost (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	int op;
+	unsigned int uArg = 0;
+	float fArg = 0;
+	if (!PyArg_ParseTuple(args,"Oi|If", &PyPtr, &op, &uArg, &fArg)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for control client pointer, command, and arguments.");
+		return NULL;
+	}
+	pulsedThreadControlClient * clientPtr = static_cast<pulsedThreadControlClient * > (PyCapsule_GetPointer(PyPtr, "pulsedThreadControlClient"));
+	if (clientPtr == nullptr){
+		return NULL;
+	}
+	return Py_BuildValue("K", (unsigned long long) clientPtr->post (op, uArg, fArg));
+}
+
+/* waits for a posted command, returns (1 if timed out, 0 if done, -1 if done but result overwritten, result). The GIL is released while waiting */
+static PyObject* pulsedThread_controlWait (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	unsigned long long ticket;
+	float timeOutSecs;
+	if (!PyArg_ParseTuple(args,"OKf", &PyPtr, &ticket, &timeOutSecs)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for control client pointer, ticket, and timeOut seconds.");
+		return NULL;
+	}
+	pulsedThreadControlClient * clientPtr = static_cast<pulsedThreadControlClient * > (PyCapsule_GetPointer(PyPtr, "pulsedThreadControlClient"));
+	if (clientPtr == nullptr){
+		return NULL;
+	}
+	if (ticket == 0){
+		PyErr_SetString (PyExc_ValueError, "Ticket 0 is not a posted command.");
+		return NULL;
+	}
+	int result = 0;
+	int waitStatus;
+	Py_BEGIN_ALLOW_THREADS
+	waitStatus = clientPtr->waitDone ((uint64_t) ticket, timeOutSecs, result);
+	Py_END_ALLOW_THREADS
+	return Py_BuildValue("ii", waitStatus, result);
+}
+
+/* returns a dictionary of the status of the controlled pulsedThread */
+static PyObject* pulsedThread_controlStatus (PyObject *self, PyObject *PyPtr) {
+	pulsedThreadControlClient * clientPtr = static_cast<pulsedThreadControlClient * > (PyCapsule_GetPointer(PyPtr, "pulsedThreadControlClient"));
+	if (clientPtr == nullptr){
+		return NULL;
+	}
+	pulsedThreadStatus status;
+	clientPtr->readStatus (status);
+	return Py_BuildValue("{s:K,s:K,s:i,s:i,s:i,s:I,s:I,s:I,s:f,s:f,s:f,s:K}", "nDone", (unsigned long long) status.nDone, "nFailed", (unsigned long long) status.nFailed,
+	"lastResult", status.lastResult, "busy", status.busy, "armMode", status.armMode, "nPulses", status.nPulses, "delayUsecs", status.delayUsecs,
+	"durUsecs", status.durUsecs, "trainFrequency", status.trainFrequency, "trainDutyCycle", status.trainDutyCycle, "trainDuration", status.trainDuration,
+	"updateNsecs", (unsigned long long) status.updateNsecs);
+}
+
+/* pulsedThread_setEndFuncOffload runs endFuncs, e.g., a Python EndFunc, on a companion thread, so they never delay an edge. The GIL is released,
+as stopping the companion waits for it to run queued endFuncs, which may need the GIL */
+static PyObject* pulsedThread_setEndFuncOffload (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	int isOffloaded;
+	if (!PyArg_ParseTuple(args,"Oi", &PyPtr, &isOffloaded)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and offload setting.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	int result;
+	Py_BEGIN_ALLOW_THREADS
+	result = threadPtr -> setEndFuncOffload (isOffloaded);
+	Py_END_ALLOW_THREADS
+	return Py_BuildValue("i", result);
+}
+
+/* returns a tuple of number of endFuncs run by the companion thread, and number dropped because its queue was full */
+static PyObject* pulsedThread_getEndFuncOffloadStats (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	uint64_t nDropped;
+	uint64_t nDone = threadPtr->getEndFuncOffloadStats (nDropped);
+	return Py_BuildValue("KK", (unsigned long long) nDone, (unsigned long long) nDropped);
+}
+
+/* starts CPU cost accounting, from zero, or stops it, returns 1 if thread is busy or armed */
+static PyObject* pulsedThread_setCpuAccounting (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	int isAccounting;
+	if (!PyArg_ParseTuple(args,"Oi", &PyPtr, &isAccounting)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and accounting setting.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return Py_BuildValue("i", threadPtr -> setCpuAccounting (isAccounting));
+}
+
+/* builds a dictionary of CPU cost accounting stats, in seconds, or returns None if not accounting */
+static PyObject* pulsedThread_buildCpuStats (pulsedThread * threadPtr){
+	pulsedThreadCpuStats stats;
+	if (threadPtr->getCpuStats (stats)){
+		Py_RETURN_NONE;
+	}
+	return Py_BuildValue("{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:K}", "spin", stats.spinNsecs/1e09, "sleep", stats.sleepNsecs/1e09, "callback", stats.callbackNsecs/1e09,
+	"callbackCpu", stats.callbackCpuNsecs/1e09, "idle", stats.idleNsecs/1e09, "idleCpu", stats.idleCpuNsecs/1e09, "wall", stats.wallNsecs/1e09,
+	"nTasks", (unsigned long long) stats.nTasks);
+}
+
+static PyObject* pulsedThread_getCpuStats (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return pulsedThread_buildCpuStats (threadPtr);
+}
+
+/* returns a tuple of the choices, 0 = sleeps, 1 = sleeps and spins, 2 = spins, for delay and duration of a thread made with accLevel 3, or None */
+static PyObject* pulsedThread_getAutoChoice (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	int delayChoice;
+	int durChoice;
+	if (threadPtr->getAutoChoice (delayChoice, durChoice)){
+		Py_RETURN_NONE;
+	}
+	return Py_BuildValue("ii", delayChoice, durChoice);
+}
+
+/* returns the host wake-up latency used by accLevel 3, in microseconds, measuring it if not yet measured */
+static PyObject* pulsedThread_getHostLatency (PyObject *self, PyObject *unused) {
+	unsigned int latencyUsecs;
+	Py_BEGIN_ALLOW_THREADS
+	latencyUsecs = pulsedThreadMeasureHostLatency ();
+	Py_END_ALLOW_THREADS
+	return Py_BuildValue("I", latencyUsecs);
+}
+
+/* sets the host wake-up latency used by accLevel 3 threads, from now on, 0 to measure it again now */
+static PyObject* pulsedThread_setHostLatency (PyObject *self, PyObject *args) {
+	unsigned int latencyUsecs;
+	if (!PyArg_ParseTuple(args,"I", &latencyUsecs)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse argument for latency in microseconds.");
+		return NULL;
+	}
+	Py_BEGIN_ALLOW_THREADS
+	pulsedThreadSetHostLatency (latencyUsecs);
+	Py_END_ALLOW_THREADS
+	Py_RETURN_NONE;
+}
+
+/* sets the timer slack the thread gives itself at the start of each task, 0 for the default slack, returns 1 if thread is busy or armed */
+static PyObject* pulsedThread_setTimerSlack (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	unsigned long slackNsecs;
+	if (!PyArg_ParseTuple(args,"Ok", &PyPtr, &slackNsecs)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and timer slack in nanoseconds.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return Py_BuildValue("i", threadPtr -> setTimerSlack (slackNsecs));
+}
+
+/* sets the tolerance for moving sleep-only wake-ups to the shared tick, 0 to not coalesce, returns 1 if thread is busy or armed */
+static PyObject* pulsedThread_setCoalescing (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	unsigned int toleranceUsecs;
+	if (!PyArg_ParseTuple(args,"OI", &PyPtr, &toleranceUsecs)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer and tolerance in microseconds.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return Py_BuildValue("i", threadPtr -> setCoalescing (toleranceUsecs));
+}
+
+/* sets the shared tick that coalescing threads wake on, returns 1 if tick is 0 */
+static PyObject* pulsedThread_setCoalesceTick (PyObject *self, PyObject *args) {
+	unsigned int tickUsecs;
+	if (!PyArg_ParseTuple(args,"I", &tickUsecs)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse argument for tick in microseconds.");
+		return NULL;
+	}
+	return Py_BuildValue("i", pulsedThreadSetCoalesceTick (tickUsecs));
+}
+
+/* pins the thread to a core with the spin coordinator, core = -1 lets the coordinator choose. Returns a tuple of status and core used.
+status is 0 if ok, 1 if spin windows may overlap another thread on the core, 2 if the core is overloaded, -1 if refused */
+static PyObject* pulsedThread_setSpinCore (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	int core;
+	int refuseWarnings;
+	if (!PyArg_ParseTuple(args,"Oii", &PyPtr, &core, &refuseWarnings)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer, core, and refuse warnings.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	int status = pulsedThreadSpinCoordinator::addThread (threadPtr, core, refuseWarnings);
+	return Py_BuildValue("ii", status, core);
+}
+
+/* returns a tuple of projected spin load, from 0 to 1 for a fully loaded core, and number of thread pairs that may have overlapping spin windows on a core */
+static PyObject* pulsedThread_getSpinLoad (PyObject *self, PyObject *args) {
+	int core;
+	if (!PyArg_ParseTuple(args,"i", &core)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse argument for core.");
+		return NULL;
+	}
+	return Py_BuildValue("fi", pulsedThreadSpinCoordinator::getProjectedLoad (core), pulsedThreadSpinCoordinator::getNumOverlapRisks (core));
+}
+
+/* returns a tuple of number of spin windows that overlapped a window of another thread on the same core, and number of spin windows */
+static PyObject* pulsedThread_getSpinOverlaps (PyObject *self, PyObject *PyPtr) {
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	uint64_t nWindows;
+	uint64_t nOverlaps = pulsedThreadSpinCoordinator::getOverlaps (threadPtr, nWindows);
+	return Py_BuildValue("KK", (unsigned long long) nOverlaps, (unsigned long long) nWindows);
+}
+
+/* makes pthreads for pulsedThreads to borrow, so making and deleting pulsedThreads does not cost pthread creation. Returns number of pthreads that could not be made */
+static PyObject* pulsedThread_prefillPool (PyObject *self, PyObject *args) {
+	unsigned int nThreads;
+	if (!PyArg_ParseTuple(args,"I", &nThreads)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse argument for number of pthreads.");
+		return NULL;
+	}
+	return Py_BuildValue("i", pulsedThreadPool::prefill (nThreads));
+}
+
+/* sets stack and guard size, in bytes, for pthreads made for the pool from now on. Stack size 0 is system default. Returns 1 if stack size is too small */
+static PyObject* pulsedThread_setPoolStack (PyObject *self, PyObject *args) {
+	unsigned long stackSize;
+	unsigned long guardSize;
+	if (!PyArg_ParseTuple(args,"kk", &stackSize, &guardSize)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for stack size and guard size.");
+		return NULL;
+	}
+	return Py_BuildValue("i", pulsedThreadPool::setStack ((size_t) stackSize, (size_t) guardSize));
+}
+
+/* returns a tuple of deepest stack used by any task run on a pool pthread so far, and stack size for new pool pthreads, in bytes */
+static PyObject* pulsedThread_getPoolStackUsed (PyObject *self, PyObject *args) {
+	return Py_BuildValue("kk", (unsigned long) pulsedThreadPool::getMaxStackUsed (), (unsigned long) pulsedThreadPool::getStackSize ());
+}
+
 /* ---------Modifiers for pulse timing based on individual pulses and numbers of pulses--------------
 Modifies the delay of a pulse, or the "low" time of a train, value is in seconds*/
 static PyObject*  pulsedThread_modDelay (PyObject *self, PyObject *args) {
@@ -155,6 +714,34 @@ static PyObject*  pulsedThread_modDutyCycle (PyObject *self, PyObject *args) {
 }
 
 
+/* modifies delay and duration, in seconds, and number of pulses together, so the thread never runs with only some of them changed */
+static PyObject*  pulsedThread_modTiming (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	float newDelay;
+	float newDur;
+	unsigned int newPulses;
+	if (!PyArg_ParseTuple(args,"OffI", &PyPtr, &newDelay, &newDur, &newPulses)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer, pulse delay seconds, pulse duration seconds, and number of pulses.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return Py_BuildValue("i", threadPtr ->modTiming ((unsigned int) round (1e06 * newDelay), (unsigned int) round (1e06 * newDur), newPulses));
+}
+
+/* modifies frequency, duty cycle, and train duration together */
+static PyObject*  pulsedThread_modTrainTiming (PyObject *self, PyObject *args) {
+	PyObject *PyPtr;
+	float newFreq;
+	float newDutyCycle;
+	float newTrainDur;
+	if (!PyArg_ParseTuple(args,"Offf", &PyPtr, &newFreq, &newDutyCycle, &newTrainDur)) {
+		PyErr_SetString (PyExc_RuntimeError, "Could not parse arguments for pulsedThread pointer, train frequency, duty cycle, and train duration.");
+		return NULL;
+	}
+	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
+	return Py_BuildValue("i", threadPtr ->modTrainTiming (newFreq, newDutyCycle, newTrainDur));
+}
+
 /* Calls getModCustomStatus, returns 1 if a modData or ModCustom function is waiting to be run, else 0 */
 static PyObject* pulsedThread_modCustomStatus (PyObject *self, PyObject *PyPtr) {
 	pulsedThread * threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(PyPtr, "pulsedThread"));
@@ -387,4 +974,421 @@ static PyObject* pulsedThread_cosineDutyCycleArray (PyObject *self, PyObject *ar
 }
 
 
+/* ****************************** PulsedThread extension type with fast-call methods ********************************************
+Every capsule function above looks up the pointer with PyCapsule_GetPointer and parses a format string, which costs far more than the
+pulsedThread call itself when a Python controller calls isBusy or modTrainDuty at kHz rates. A PulsedThread object caches the pointer and
+its methods take arguments as an array of objects (METH_FASTCALL), or no argument or a single object (METH_NOARGS, METH_O), with no parsing.
+It is made from the PyCapsule returned by a module's init function, PulsedThread (capsule), and holds a reference to the capsule, so the
+pulsedThread lives as long as either one does, and the capsule functions can still be used with its capsule attribute.
+Modules add the type by calling pulsedThread_addType from their module init function. Needs Python 3.7 or later for METH_FASTCALL */
+#if PY_VERSION_HEX >= 0x03070000
+
+typedef struct {
+	PyObject_HEAD
+	pulsedThread * threadPtr; // pointer from the capsule, looked up once
+	PyObject * capsule; // PyCapsule that owns the pulsedThread
+} pulsedThreadObject;
+
+static PyTypeObject pulsedThreadType = {PyVarObject_HEAD_INIT (NULL, 0)};
+
+static PyObject * pulsedThreadType_new (PyTypeObject *type, PyObject *args, PyObject *kwds){
+	PyObject * capsule;
+	if (!PyArg_ParseTuple(args,"O", &capsule)) {
+		return NULL;
+	}
+	if (!PyCapsule_IsValid (capsule, "pulsedThread")){
+		PyErr_SetString (PyExc_TypeError, "PulsedThread needs a PyCapsule containing a pulsedThread pointer.");
+		return NULL;
+	}
+	pulsedThreadObject * self = (pulsedThreadObject *) type->tp_alloc (type, 0);
+	if (self == NULL){
+		return NULL;
+	}
+	self->threadPtr = static_cast<pulsedThread * > (PyCapsule_GetPointer(capsule, "pulsedThread"));
+	Py_INCREF (capsule);
+	self->capsule = capsule;
+	return (PyObject *) self;
+}
+
+static void pulsedThreadType_dealloc (pulsedThreadObject * self){
+	Py_XDECREF (self->capsule);
+	Py_TYPE (self)->tp_free ((PyObject *) self);
+}
+
+/* check the number of fast-call arguments, setting a Python error if it is wrong. Single argument methods are METH_O, so need no check */
+static inline int pulsedThreadType_twoArgs (PyObject *const *args, Py_ssize_t nargs){
+	if (nargs != 2){
+		PyErr_Format (PyExc_TypeError, "expected 2 arguments, got %zd", nargs);
+		return 1;
+	}
+	return 0;
+}
+
+static inline int pulsedThreadType_threeArgs (PyObject *const *args, Py_ssize_t nargs){
+	if (nargs != 3){
+		PyErr_Format (PyExc_TypeError, "expected 3 arguments, got %zd", nargs);
+		return 1;
+	}
+	return 0;
+}
+
+/* ---------- requesting tasks and checking if busy ----------------*/
+static PyObject* pulsedThreadType_isBusy (pulsedThreadObject *self, PyObject *unused){
+	return PyLong_FromLong (self->threadPtr->isBusy());
+}
+
+static PyObject* pulsedThreadType_waitOnBusy (pulsedThreadObject *self, PyObject *arg){
+	double timeOutSecs = PyFloat_AsDouble (arg);
+	if ((timeOutSecs == -1.0) && PyErr_Occurred()){
+		return NULL;
+	}
+	int result;
+	Py_BEGIN_ALLOW_THREADS
+	result = self->threadPtr->waitOnBusy ((float) timeOutSecs);
+	Py_END_ALLOW_THREADS
+	return PyLong_FromLong (result);
+}
+
+static PyObject* pulsedThreadType_doTask (pulsedThreadObject *self, PyObject *unused){
+	self->threadPtr->DoTask();
+	Py_RETURN_NONE;
+}
+
+static PyObject* pulsedThreadType_doTasks (pulsedThreadObject *self, PyObject *arg){
+	long nTasks = PyLong_AsLong (arg);
+	if ((nTasks == -1) && PyErr_Occurred()){
+		return NULL;
+	}
+	self->threadPtr->DoTasks ((unsigned int) nTasks);
+	Py_RETURN_NONE;
+}
+
+static PyObject* pulsedThreadType_unDoTasks (pulsedThreadObject *self, PyObject *unused){
+	self->threadPtr->UnDoTasks();
+	Py_RETURN_NONE;
+}
+
+static PyObject* pulsedThreadType_startTrain (pulsedThreadObject *self, PyObject *unused){
+	self->threadPtr->startInfiniteTrain();
+	Py_RETURN_NONE;
+}
+
+static PyObject* pulsedThreadType_stopTrain (pulsedThreadObject *self, PyObject *unused){
+	self->threadPtr->stopInfiniteTrain();
+	Py_RETURN_NONE;
+}
+
+/* ---------- armed mode ----------------*/
+static PyObject* pulsedThreadType_arm (pulsedThreadObject *self, PyObject *arg){
+	long spinMode = PyLong_AsLong (arg);
+	if ((spinMode == -1) && PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->arm ((int) spinMode));
+}
+
+static PyObject* pulsedThreadType_disarm (pulsedThreadObject *self, PyObject *unused){
+	self->threadPtr->disarm();
+	Py_RETURN_NONE;
+}
+
+static PyObject* pulsedThreadType_getTriggerLatency (pulsedThreadObject *self, PyObject *unused){
+	uint64_t minNsecs;
+	uint64_t maxNsecs;
+	uint64_t nTriggers = self->threadPtr->getTriggerLatencyStats (minNsecs, maxNsecs);
+	return Py_BuildValue("KKKK", (unsigned long long) self->threadPtr->getTriggerLatency(), (unsigned long long) minNsecs, (unsigned long long) maxNsecs, (unsigned long long) nTriggers);
+}
+
+/* ---------- trigger fd ----------------*/
+static PyObject* pulsedThreadType_setTriggerFd (pulsedThreadObject *self, PyObject *args){
+	int fd;
+	int fdMode = kTRIGFD_EVENTFD;
+	if (!PyArg_ParseTuple(args,"i|i", &fd, &fdMode)) {
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->setTriggerFd (fd, fdMode));
+}
+
+static PyObject* pulsedThreadType_getFdTriggerStats (pulsedThreadObject *self, PyObject *unused){
+	uint64_t minNsecs;
+	uint64_t maxNsecs;
+	uint64_t nMissed;
+	uint64_t nTriggers = self->threadPtr->getFdTriggerStats (minNsecs, maxNsecs, nMissed);
+	return Py_BuildValue("KKKKK", (unsigned long long) self->threadPtr->getFdTriggerLatency(), (unsigned long long) minNsecs, (unsigned long long) maxNsecs, (unsigned long long) nTriggers, (unsigned long long) nMissed);
+}
+
+/* ---------- endFunc offload ----------------*/
+static PyObject* pulsedThreadType_setEndFuncOffload (pulsedThreadObject *self, PyObject *arg){
+	int isOffloaded = PyObject_IsTrue (arg);
+	if (isOffloaded == -1){
+		return NULL;
+	}
+	int result;
+	Py_BEGIN_ALLOW_THREADS
+	result = self->threadPtr->setEndFuncOffload (isOffloaded);
+	Py_END_ALLOW_THREADS
+	return PyLong_FromLong (result);
+}
+
+static PyObject* pulsedThreadType_getEndFuncOffloadStats (pulsedThreadObject *self, PyObject *unused){
+	uint64_t nDropped;
+	uint64_t nDone = self->threadPtr->getEndFuncOffloadStats (nDropped);
+	return Py_BuildValue("KK", (unsigned long long) nDone, (unsigned long long) nDropped);
+}
+
+static PyObject* pulsedThreadType_setCpuAccounting (pulsedThreadObject *self, PyObject *arg){
+	int isAccounting = PyObject_IsTrue (arg);
+	if (isAccounting == -1){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->setCpuAccounting (isAccounting));
+}
+
+static PyObject* pulsedThreadType_setTimerSlack (pulsedThreadObject *self, PyObject *arg){
+	unsigned long slackNsecs = PyLong_AsUnsignedLong (arg);
+	if (PyErr_Occurred ()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->setTimerSlack (slackNsecs));
+}
+
+static PyObject* pulsedThreadType_setCoalescing (pulsedThreadObject *self, PyObject *arg){
+	unsigned long toleranceUsecs = PyLong_AsUnsignedLong (arg);
+	if (PyErr_Occurred ()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->setCoalescing ((unsigned int) toleranceUsecs));
+}
+
+static PyObject* pulsedThreadType_getCpuStats (pulsedThreadObject *self, PyObject *unused){
+	return pulsedThread_buildCpuStats (self->threadPtr);
+}
+
+static PyObject* pulsedThreadType_getAutoChoice (pulsedThreadObject *self, PyObject *unused){
+	int delayChoice;
+	int durChoice;
+	if (self->threadPtr->getAutoChoice (delayChoice, durChoice)){
+		Py_RETURN_NONE;
+	}
+	return Py_BuildValue("ii", delayChoice, durChoice);
+}
+
+/* ---------- modifiers, pulse delay and duration in seconds, as for capsule functions ----------------*/
+static PyObject* pulsedThreadType_modDelay (pulsedThreadObject *self, PyObject *arg){
+	double newDelay = PyFloat_AsDouble (arg);
+	if ((newDelay == -1.0) && PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modDelay ((unsigned int) round (1e06 * newDelay)));
+}
+
+static PyObject* pulsedThreadType_modDur (pulsedThreadObject *self, PyObject *arg){
+	double newDur = PyFloat_AsDouble (arg);
+	if ((newDur == -1.0) && PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modDur ((unsigned int) round (1e06 * newDur)));
+}
+
+static PyObject* pulsedThreadType_modTrainLength (pulsedThreadObject *self, PyObject *arg){
+	unsigned long newLength = PyLong_AsUnsignedLong (arg);
+	if ((newLength == (unsigned long)-1) && PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modTrainLength ((unsigned int) newLength));
+}
+
+static PyObject* pulsedThreadType_modTrainDur (pulsedThreadObject *self, PyObject *arg){
+	double newDur = PyFloat_AsDouble (arg);
+	if ((newDur == -1.0) && PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modTrainDur ((float) newDur));
+}
+
+static PyObject* pulsedThreadType_modTrainFreq (pulsedThreadObject *self, PyObject *arg){
+	double newFreq = PyFloat_AsDouble (arg);
+	if ((newFreq == -1.0) && PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modFreq ((float) newFreq));
+}
+
+static PyObject* pulsedThreadType_modTrainDuty (pulsedThreadObject *self, PyObject *arg){
+	double newDuty = PyFloat_AsDouble (arg);
+	if ((newDuty == -1.0) && PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modDutyCycle ((float) newDuty));
+}
+
+/* sets frequency and duty cycle together, (newFrequency, newDutyCycle) */
+static PyObject* pulsedThreadType_modTrainFreqDuty (pulsedThreadObject *self, PyObject *const *args, Py_ssize_t nargs){
+	if (pulsedThreadType_twoArgs (args, nargs)){
+		return NULL;
+	}
+	double newFreq = PyFloat_AsDouble (args [0]);
+	double newDuty = PyFloat_AsDouble (args [1]);
+	if (PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modTrainTiming ((float) newFreq, (float) newDuty, self->threadPtr->getTrainDuration ()));
+}
+
+/* sets delay and duration in seconds, and number of pulses, together, (newDelay, newDuration, newPulses) */
+static PyObject* pulsedThreadType_modTiming (pulsedThreadObject *self, PyObject *const *args, Py_ssize_t nargs){
+	if (pulsedThreadType_threeArgs (args, nargs)){
+		return NULL;
+	}
+	double newDelay = PyFloat_AsDouble (args [0]);
+	double newDur = PyFloat_AsDouble (args [1]);
+	unsigned long newPulses = PyLong_AsUnsignedLong (args [2]);
+	if (PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modTiming ((unsigned int) round (1e06 * newDelay), (unsigned int) round (1e06 * newDur), (unsigned int) newPulses));
+}
+
+/* sets frequency, duty cycle, and train duration together, (newFrequency, newDutyCycle, newTrainDuration) */
+static PyObject* pulsedThreadType_modTrainTiming (pulsedThreadObject *self, PyObject *const *args, Py_ssize_t nargs){
+	if (pulsedThreadType_threeArgs (args, nargs)){
+		return NULL;
+	}
+	double newFreq = PyFloat_AsDouble (args [0]);
+	double newDuty = PyFloat_AsDouble (args [1]);
+	double newTrainDur = PyFloat_AsDouble (args [2]);
+	if (PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->modTrainTiming ((float) newFreq, (float) newDuty, (float) newTrainDur));
+}
+
+/* sets a custom endFunc array position, (arrayPos, isLocking) */
+static PyObject* pulsedThreadType_setArrayPos (pulsedThreadObject *self, PyObject *const *args, Py_ssize_t nargs){
+	if (pulsedThreadType_twoArgs (args, nargs)){
+		return NULL;
+	}
+	unsigned long arrayPos = PyLong_AsUnsignedLong (args [0]);
+	long isLocking = PyLong_AsLong (args [1]);
+	if (PyErr_Occurred()){
+		return NULL;
+	}
+	return PyLong_FromLong (self->threadPtr->setEndFuncArrayPos ((unsigned int) arrayPos, (int) isLocking));
+}
+
+/* ---------- getters ----------------*/
+static PyObject* pulsedThreadType_getPulseDelay (pulsedThreadObject *self, PyObject *unused){
+	return PyFloat_FromDouble (1e-06 * self->threadPtr->getpulseDelayUsecs());
+}
+
+static PyObject* pulsedThreadType_getPulseDuration (pulsedThreadObject *self, PyObject *unused){
+	return PyFloat_FromDouble (1e-06 * self->threadPtr->getpulseDurUsecs());
+}
+
+static PyObject* pulsedThreadType_getPulseNumber (pulsedThreadObject *self, PyObject *unused){
+	return PyLong_FromUnsignedLong (self->threadPtr->getNpulses());
+}
+
+static PyObject* pulsedThreadType_getTrainDuration (pulsedThreadObject *self, PyObject *unused){
+	return PyFloat_FromDouble (self->threadPtr->getTrainDuration());
+}
+
+static PyObject* pulsedThreadType_getTrainFrequency (pulsedThreadObject *self, PyObject *unused){
+	return PyFloat_FromDouble (self->threadPtr->getTrainFrequency());
+}
+
+static PyObject* pulsedThreadType_getTrainDutyCycle (pulsedThreadObject *self, PyObject *unused){
+	return PyFloat_FromDouble (self->threadPtr->getTrainDutyCycle());
+}
+
+static PyObject* pulsedThreadType_getModFuncStatus (pulsedThreadObject *self, PyObject *unused){
+	return PyLong_FromLong (self->threadPtr->getModCustomStatus());
+}
+
+static PyObject* pulsedThreadType_hasEndFunc (pulsedThreadObject *self, PyObject *unused){
+	return PyLong_FromLong (self->threadPtr->hasEndFunc());
+}
+
+static PyObject* pulsedThreadType_unsetEndFunc (pulsedThreadObject *self, PyObject *unused){
+	self->threadPtr->unSetEndFunc();
+	Py_RETURN_NONE;
+}
+
+/* the capsule, for use with the capsule functions */
+static PyObject* pulsedThreadType_getCapsule (pulsedThreadObject *self, void *closure){
+	Py_INCREF (self->capsule);
+	return self->capsule;
+}
+
+static PyMethodDef pulsedThreadTypeMethods[] = {
+	{"isBusy", (PyCFunction) pulsedThreadType_isBusy, METH_NOARGS, "() returns number of tasks the thread has left to do, 0 means finished all tasks"},
+	{"waitOnBusy", (PyCFunction) pulsedThreadType_waitOnBusy, METH_O, "(timeOutSecs) Returns when the thread is no longer busy, or after timeOutSecs"},
+	{"doTask", (PyCFunction) pulsedThreadType_doTask, METH_NOARGS, "() Do whatever task the thread was configured for"},
+	{"doTasks", (PyCFunction) pulsedThreadType_doTasks, METH_O, "(nTasks) Do whatever task the thread was configured for nTasks times"},
+	{"unDoTasks", (PyCFunction) pulsedThreadType_unDoTasks, METH_NOARGS, "() Stop after the current task"},
+	{"startTrain", (PyCFunction) pulsedThreadType_startTrain, METH_NOARGS, "() Starts an infinite train"},
+	{"stopTrain", (PyCFunction) pulsedThreadType_stopTrain, METH_NOARGS, "() Stops an infinite train"},
+	{"arm", (PyCFunction) pulsedThreadType_arm, METH_O, "(spinMode) Thread spins waiting for next task, spinMode 1 = spin, 2 = spin with pause, 3 = spin with yield"},
+	{"disarm", (PyCFunction) pulsedThreadType_disarm, METH_NOARGS, "() Thread goes back to sleeping while waiting for next task"},
+	{"getTriggerLatency", (PyCFunction) pulsedThreadType_getTriggerLatency, METH_NOARGS, "() returns (last, min, max) nanoseconds from doTask to first edge of task for an armed thread, and number of triggered tasks"},
+	{"setTriggerFd", (PyCFunction) pulsedThreadType_setTriggerFd, METH_VARARGS, "(fd, fdMode = 0) Thread starts a task on each event on fd, -1 to stop, fdMode 0 = eventfd, 1 = pipe, 2 = GPIO line request"},
+	{"getFdTriggerStats", (PyCFunction) pulsedThreadType_getFdTriggerStats, METH_NOARGS, "() returns (last, min, max) nanoseconds from event on trigger fd to first edge of task, number of triggered tasks, and number of missed events"},
+	{"setEndFuncOffload", (PyCFunction) pulsedThreadType_setEndFuncOffload, METH_O, "(isOffloaded) runs endFuncs on a companion thread, so they never delay an edge, returns 1 if thread is busy or armed"},
+	{"getEndFuncOffloadStats", (PyCFunction) pulsedThreadType_getEndFuncOffloadStats, METH_NOARGS, "() returns (number of endFuncs run by companion thread, number dropped because its queue was full)"},
+	{"setCpuAccounting", (PyCFunction) pulsedThreadType_setCpuAccounting, METH_O, "(isAccounting) starts CPU cost accounting from zero, or stops it, returns 1 if thread is busy or armed"},
+	{"getCpuStats", (PyCFunction) pulsedThreadType_getCpuStats, METH_NOARGS, "() returns a dictionary of seconds spinning, sleeping, in callbacks, and idle, with CPU seconds, and number of tasks, or None if not accounting"},
+	{"setTimerSlack", (PyCFunction) pulsedThreadType_setTimerSlack, METH_O, "(slackNsecs) timer slack the thread gives itself at the start of each task, 0 for default, no effect on real-time threads, returns 1 if thread is busy or armed"},
+	{"setCoalescing", (PyCFunction) pulsedThreadType_setCoalescing, METH_O, "(toleranceUsecs) moves sleep-only wake-ups up to toleranceUsecs to the shared tick, 0 to not coalesce, returns 1 if thread is busy or armed"},
+	{"getAutoChoice", (PyCFunction) pulsedThreadType_getAutoChoice, METH_NOARGS, "() returns (delay choice, duration choice), 0 = sleeps, 1 = sleeps and spins, 2 = spins, for accLevel 3, or None"},
+	{"modDelay", (PyCFunction) pulsedThreadType_modDelay, METH_O, "(newDelaySecs) changes the delay period of a pulse or LOW period of a train"},
+	{"modDur", (PyCFunction) pulsedThreadType_modDur, METH_O, "(newDurationSecs) changes the duration of a pulse or HIGH period of a train"},
+	{"modTrainLength", (PyCFunction) pulsedThreadType_modTrainLength, METH_O, "(newTrainLength) changes the number of pulses of a train"},
+	{"modTrainDur", (PyCFunction) pulsedThreadType_modTrainDur, METH_O, "(newTrainDurSecs) changes the total duration of a train"},
+	{"modTrainFreq", (PyCFunction) pulsedThreadType_modTrainFreq, METH_O, "(newTrainFrequency) changes the frequency of a train"},
+	{"modTrainDuty", (PyCFunction) pulsedThreadType_modTrainDuty, METH_O, "(newTrainDutyCycle) changes the duty cycle of a train"},
+	{"modTrainFreqDuty", (PyCFunction)(void(*)(void)) pulsedThreadType_modTrainFreqDuty, METH_FASTCALL, "(newTrainFrequency, newTrainDutyCycle) changes frequency and duty cycle of a train"},
+	{"modTiming", (PyCFunction)(void(*)(void)) pulsedThreadType_modTiming, METH_FASTCALL, "(newDelaySecs, newDurationSecs, newTrainLength) changes delay, duration, and number of pulses together"},
+	{"modTrainTiming", (PyCFunction)(void(*)(void)) pulsedThreadType_modTrainTiming, METH_FASTCALL, "(newTrainFrequency, newTrainDutyCycle, newTrainDurSecs) changes frequency, duty cycle, and duration of a train together"},
+	{"setArrayPos", (PyCFunction)(void(*)(void)) pulsedThreadType_setArrayPos, METH_FASTCALL, "(arrayPos, isLocking) sets current position in the array used by an array endFunc"},
+	{"getPulseDelay", (PyCFunction) pulsedThreadType_getPulseDelay, METH_NOARGS, "() returns pulse delay, in seconds"},
+	{"getPulseDuration", (PyCFunction) pulsedThreadType_getPulseDuration, METH_NOARGS, "() returns pulse duration, in seconds"},
+	{"getPulseNumber", (PyCFunction) pulsedThreadType_getPulseNumber, METH_NOARGS, "() returns number of pulses in a train, 1 for a single pulse, or 0 for an infinite train"},
+	{"getTrainDuration", (PyCFunction) pulsedThreadType_getTrainDuration, METH_NOARGS, "() returns duration of a train, in seconds"},
+	{"getTrainFrequency", (PyCFunction) pulsedThreadType_getTrainFrequency, METH_NOARGS, "() returns frequency of a train, in Hz"},
+	{"getTrainDutyCycle", (PyCFunction) pulsedThreadType_getTrainDutyCycle, METH_NOARGS, "() returns duty cycle of a train, between 0 and 1"},
+	{"getModFuncStatus", (PyCFunction) pulsedThreadType_getModFuncStatus, METH_NOARGS, "() Returns 1 if the thread has custom modifications waiting to be run, else 0"},
+	{"hasEndFunc", (PyCFunction) pulsedThreadType_hasEndFunc, METH_NOARGS, "() Returns 1 if an end function is installed, else 0"},
+	{"unsetEndFunc", (PyCFunction) pulsedThreadType_unsetEndFunc, METH_NOARGS, "() un-sets any end function"},
+	{NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef pulsedThreadTypeGetSet[] = {
+	{(char *)"capsule", (getter) pulsedThreadType_getCapsule, NULL, (char *)"PyCapsule owning the pulsedThread, for use with the capsule functions", NULL},
+	{NULL, NULL, NULL, NULL, NULL}
+};
+
+/* readies the PulsedThread type and adds it to a module. Call from module init function. Returns 0 on success, -1 with a Python error set */
+static int pulsedThread_addType (PyObject * module){
+	pulsedThreadType.tp_name = "pulsedThread.PulsedThread";
+	pulsedThreadType.tp_doc = "PulsedThread (capsule) wraps the pulsedThread in a PyCapsule from a module's init function, with fast-call methods";
+	pulsedThreadType.tp_basicsize = sizeof (pulsedThreadObject);
+	pulsedThreadType.tp_itemsize = 0;
+	pulsedThreadType.tp_flags = Py_TPFLAGS_DEFAULT;
+	pulsedThreadType.tp_new = pulsedThreadType_new;
+	pulsedThreadType.tp_dealloc = (destructor) pulsedThreadType_dealloc;
+	pulsedThreadType.tp_methods = pulsedThreadTypeMethods;
+	pulsedThreadType.tp_getset = pulsedThreadTypeGetSet;
+	if (PyType_Ready (&pulsedThreadType) < 0){
+		return -1;
+	}
+	Py_INCREF (&pulsedThreadType);
+	if (PyModule_AddObject (module, "PulsedThread", (PyObject *) &pulsedThreadType) < 0){
+		Py_DECREF (&pulsedThreadType);
+		return -1;
+	}
+	return 0;
+}
+
+#endif
+
 #endif
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pulsedThread.h>
+#include <pulsedThreadPool.h>
+
+/* ************************************* Checks that the thread loop fits in a small pool stack *******************************************
+Runs single pulses, trains, and infinite trains at each accuracy level, armed and not, with queued custom modifications and the bundled
+array endFuncs for frequency and duty cycle, all on pool pthreads with painted stacks of the requested size. Prints the deepest stack
+used, and returns 1 if that is more than half the stack, so it can be run as a check when the thread function changes.
+usage: stackCheck stackBytes
+Last Modified:
+2026/10/19 - initial version */
+
+void check_Hi (void * taskData){
+	*(int *) taskData +=1;
+}
+
+void check_Lo (void * taskData){
+}
+
+int check_Mod (void * modData, taskParams * theTask){
+	*(int *) theTask->taskData += *(int *) modData;
+	return 0;
+}
+
+int main(int argc, char **argv){
+	size_t stackBytes = (argc > 1) ? atoi (argv [1]) : kPOOL_STACK_SIZE;
+	if (pulsedThreadPool::setStack (stackBytes, kPOOL_GUARD_SIZE)){
+		printf ("Stack size %zu is too small.\n", stackBytes);
+		return 1;
+	}
+	float arrayData [100];
+	pulsedThread::cosineDutyCycleArray (arrayData, 100, 100, 0.5, 0.4);
+	int nEdges =0;
+	int modVal = 1;
+	for (int accLevel = ACC_MODE_SLEEPS; accLevel <= ACC_MODE_SLEEPS_AND_OR_SPINS; accLevel +=1){
+		int errVar;
+		// single pulse, armed for the second lot of pulses
+		pulsedThread * pulse = new pulsedThread ((unsigned int)100, (unsigned int)100, (unsigned int)kPULSE, (void *) &nEdges, nullptr, &check_Lo, &check_Hi, accLevel, errVar);
+		pulse->DoTasks (5);
+		pulse->waitOnBusy (1);
+		pulse->arm (kARM_SPIN_PAUSE);
+		pulse->DoTasks (5);
+		pulse->waitOnBusy (1);
+		pulse->disarm ();
+		pulse->modCustom (&check_Mod, (void *) &modVal, 1);
+		// train, with duty cycle from array endFunc
+		pulsedThread * train = new pulsedThread ((unsigned int)200, (unsigned int)200, (unsigned int)20, (void *) &nEdges, nullptr, &check_Lo, &check_Hi, accLevel, errVar);
+		train->setUpEndFuncArray (arrayData, 100, 1);
+		train->chooseArrayEndFunc (kDUTY_CYCLE);
+		train->DoTasks (3);
+		train->setEndFuncArrayLimits (10, 50, 1);
+		train->waitOnBusy (1);
+		// infinite train, with frequency from array endFunc, and changes to timing while it runs
+		pulsedThread * infinite = new pulsedThread ((float)500, (float)0.5, (float)0, (void *) &nEdges, nullptr, &check_Lo, &check_Hi, accLevel, errVar);
+		for (int ii =0; ii < 100; ii +=1){
+			arrayData [ii] = 400 + ii;
+		}
+		infinite->setUpEndFuncArray (arrayData, 100, 1);
+		infinite->chooseArrayEndFunc (kFREQUENCY);
+		infinite->startInfiniteTrain ();
+		usleep (20000);
+		infinite->modDur (300);
+		infinite->setEndFuncArrayPos (50, 1);
+		infinite->modCustom (&check_Mod, (void *) &modVal, 1);
+		usleep (20000);
+		infinite->stopInfiniteTrain ();
+		delete pulse;
+		delete train;
+		delete infinite;
+		pulsedThread::cosineDutyCycleArray (arrayData, 100, 100, 0.5, 0.4);
+	}
+	// give workers time to get back to the pool and check their stacks
+	usleep (10000);
+	size_t maxUsed = pulsedThreadPool::getMaxStackUsed ();
+	printf ("%d edges, deepest stack used = %zu of %zu bytes.\n", nEdges, maxUsed, stackBytes);
+	return (maxUsed * 2 > stackBytes) ? 1 : 0;
+}
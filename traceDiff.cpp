@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pulsedThreadTrace.h>
+#include <pulsedThreadClock.h>
+
+/* ************************************* Compares two saved edge traces *******************************************
+Loads two traces saved with pulsedThreadTrace::save, e.g., the same stimulus made by two versions of the software, and compares them
+edge by edge. Task starts are not compared, as a replay of several tasks is one task. Reports the first edge where the channel or kind of edge differs, and the mean and largest difference in edge times.
+Exits with 0 if the traces have the same edges with times within the tolerance, else 1
+usage: traceDiff traceFile1 traceFile2 [toleranceUsecs]
+
+With -check, makes its own traces on virtual clocks (pulsedThreadClock.h), so the result does not depend on machine load: a train is recorded and
+compared with the schedule its timing gives, then the recorded trace is replayed with a pulsedThreadReplay and the replay's trace is compared with it.
+A train with an offloaded endFunc that changes the delay is given a modTrainLength while its endFunc is queued, and its next train must have both
+the new delay and the new length. A single pulse chained on its hi edge to an armed train must post one start, and the train must make its
+schedule. Exits with 0 if all match, else 1. make check builds TraceDiff from the sources and runs it
+usage: traceDiff -check [toleranceUsecs]
+Last Modified:
+2026/10/19 - -check also checks that an edge posts a start to an armed, chained, thread
+2026/10/19 - -check also checks that a modTrainLength made while an offloaded endFunc is queued is kept
+2026/10/19 - adds -check, a deterministic check of recording and replay on virtual clocks
+2026/10/19 - initial version */
+
+const size_t kDIFF_MAX_BYTES = 64 * 1024 * 1024;
+
+// timing of the train made by -check
+const unsigned int kCHECK_DELAY = 1000;
+const unsigned int kCHECK_DUR = 500;
+const unsigned int kCHECK_PULSES = 5;
+const unsigned int kCHECK_NEW_DELAY = 2000; // delay set by the offloaded endFunc
+const unsigned int kCHECK_NEW_PULSES = 3; // train length set by modTrainLength while the endFunc is queued
+
+/* ************************************** decodes the hi and lo edges of a trace, task starts are dropped ***************************/
+static pulsedThreadEdgePtr traceEdges (pulsedThreadTrace & trace, unsigned int & nEdges){
+	nEdges = trace.getNumEdges ();
+	pulsedThreadEdgePtr edges = new pulsedThreadEdge [nEdges + 1];
+	nEdges = trace.getEdges (edges, nEdges);
+	// keep only the hi and lo edges
+	unsigned int nKept = 0;
+	for (unsigned int iEdge =0; iEdge < nEdges; iEdge +=1){
+		if (edges [iEdge].kind != kTRACE_START){
+			edges [nKept] = edges [iEdge];
+			nKept +=1;
+		}
+	}
+	nEdges = nKept;
+	return edges;
+}
+
+static pulsedThreadEdgePtr loadEdges (const char * path, unsigned int & nEdges){
+	pulsedThreadTrace trace (kDIFF_MAX_BYTES);
+	if (trace.load (path)){
+		printf ("Could not load trace file %s.\n", path);
+		return nullptr;
+	}
+	return traceEdges (trace, nEdges);
+}
+
+/* ****************************** compares edges, prints the differences, returns 0 if the same within tolerance, else 1 ************/
+static int compareEdges (pulsedThreadEdgePtr edges1, unsigned int nEdges1, pulsedThreadEdgePtr edges2, unsigned int nEdges2, uint64_t tolerance){
+
+	unsigned int nCompare = (nEdges1 < nEdges2) ? nEdges1 : nEdges2;
+	uint64_t sumDiff = 0;
+	uint64_t maxDiff = 0;
+	unsigned int maxEdge = 0;
+	unsigned int nOver = 0;
+	int isSame = (nEdges1 == nEdges2);
+	unsigned int iEdge;
+	for (iEdge =0; iEdge < nCompare; iEdge +=1){
+		if ((edges1 [iEdge].channel != edges2 [iEdge].channel) || (edges1 [iEdge].kind != edges2 [iEdge].kind)){
+			printf ("edge %d differs: channel %d kind %d at %llu us, and channel %d kind %d at %llu us.\n", iEdge,
+			edges1 [iEdge].channel, edges1 [iEdge].kind, (unsigned long long)edges1 [iEdge].usecs,
+			edges2 [iEdge].channel, edges2 [iEdge].kind, (unsigned long long)edges2 [iEdge].usecs);
+			isSame = 0;
+			break;
+		}
+		uint64_t diff = (edges1 [iEdge].usecs > edges2 [iEdge].usecs) ? edges1 [iEdge].usecs - edges2 [iEdge].usecs : edges2 [iEdge].usecs - edges1 [iEdge].usecs;
+		sumDiff += diff;
+		if (diff > maxDiff){
+			maxDiff = diff;
+			maxEdge = iEdge;
+		}
+		if (diff > tolerance){
+			nOver +=1;
+		}
+	}
+	printf ("%d edges and %d edges, %d compared.\n", nEdges1, nEdges2, iEdge);
+	if (iEdge > 0){
+		printf ("mean time difference = %.2f us, max time difference = %llu us at edge %d, %d edges differ by more than %llu us.\n",
+		(float)sumDiff/iEdge, (unsigned long long)maxDiff, maxEdge, nOver, (unsigned long long)tolerance);
+	}
+	return ((isSame) && (nOver == 0)) ? 0 : 1;
+}
+
+static void checkFunc (void * taskData){
+}
+
+/* ************************ edges of a train, which starts with its pulse, each pulse followed by its delay *****************************/
+static pulsedThreadEdgePtr trainEdges (unsigned int delayUsecs, unsigned int durUsecs, unsigned int nPulses, unsigned int & nEdges){
+	nEdges = 2 * nPulses;
+	pulsedThreadEdgePtr edges = new pulsedThreadEdge [nEdges];
+	for (unsigned int iPulse =0; iPulse < nPulses; iPulse +=1){
+		uint64_t pulseUsecs = (uint64_t)iPulse * (delayUsecs + durUsecs);
+		edges [2 * iPulse] = {pulseUsecs, 0, kTRACE_HI};
+		edges [2 * iPulse + 1] = {pulseUsecs + durUsecs, 0, kTRACE_LO};
+	}
+	return edges;
+}
+
+/* ***************** offloaded endFunc for -check, changes the delay, and tells the check it is running, then waits to be let go ************/
+static std::atomic<int> checkEndFuncRunning (0);
+static std::atomic<int> checkEndFuncGo (0);
+
+static void checkEndFunc (void * endFuncData, taskParams * theTask){
+	theTask->pulseDelayUsecs = kCHECK_NEW_DELAY;
+	checkEndFuncRunning.store (1);
+	while (checkEndFuncGo.load () == 0){
+		pulsedThreadCpuRelax ();
+	}
+}
+
+/* ****************************************************************************************************
+Runs a train with an offloaded endFunc that changes the delay. While the endFunc is held on the companion thread, modTrainLength changes the
+length. Once the endFunc is let go, the next train must have the delay from the endFunc and the length from modTrainLength, as the companion
+only writes back what the endFunc changed. Returns 0 if it does, else 1
+Last Modified:
+2026/10/19 - initial version */
+static int checkOffload (uint64_t tolerance){
+	int errCode = 0;
+	pulsedThreadTrace recorded (kDIFF_MAX_BYTES);
+	pulsedThreadVirtualClock recordClock (kCLOCK_FREE, 0);
+	pulsedThread * train = new pulsedThread (kCHECK_DELAY, kCHECK_DUR, kCHECK_PULSES, nullptr, nullptr, &checkFunc, &checkFunc, ACC_MODE_SLEEPS, errCode);
+	if ((errCode) || (train->setClock (recordClock.getClock ())) || (train->captureTrace (&recorded)) || (train->setEndFuncOffload (1))){
+		printf ("Could not make a pulsedThread with an offloaded endFunc.\n");
+		delete train;
+		return 1;
+	}
+	train->setEndFunc (&checkEndFunc);
+	train->DoTask ();
+	train->waitOnBusy (1);
+	while (checkEndFuncRunning.load () == 0){
+		pulsedThreadCpuRelax ();
+	}
+	int result = train->modTrainLength (kCHECK_NEW_PULSES);
+	checkEndFuncGo.store (1);
+	uint64_t nDropped;
+	while (train->getEndFuncOffloadStats (nDropped) < 1){
+		pulsedThreadCpuRelax ();
+	}
+	recorded.reset ();
+	train->DoTask ();
+	train->waitOnBusy (1);
+	delete train;
+	unsigned int nExpected;
+	pulsedThreadEdgePtr expected = trainEdges (kCHECK_NEW_DELAY, kCHECK_DUR, kCHECK_NEW_PULSES, nExpected);
+	unsigned int nRecorded;
+	pulsedThreadEdgePtr recordedEdges = traceEdges (recorded, nRecorded);
+	printf ("train after modTrainLength with an offloaded endFunc queued:\n");
+	result |= compareEdges (expected, nExpected, recordedEdges, nRecorded, tolerance);
+	delete [] expected;
+	delete [] recordedEdges;
+	return result;
+}
+
+/* ****************************************************************************************************
+Chains the hi edge of a single pulse, on one virtual clock, to a train armed on a second virtual clock. The pulse must post exactly one start,
+miss none, and the train must make the edges of its schedule. Returns 0 if it does, else 1
+Last Modified:
+2026/10/19 - initial version */
+static int checkChain (uint64_t tolerance){
+	int errCode = 0;
+	int targetErr = 0;
+	pulsedThreadVirtualClock sourceClock (kCLOCK_FREE, 0);
+	pulsedThreadVirtualClock targetClock (kCLOCK_FREE, 0);
+	pulsedThreadTrace recorded (kDIFF_MAX_BYTES);
+	pulsedThread * source = new pulsedThread (kCHECK_DELAY, kCHECK_DUR, kPULSE, nullptr, nullptr, &checkFunc, &checkFunc, ACC_MODE_SLEEPS, errCode);
+	pulsedThread * target = new pulsedThread (kCHECK_DELAY, kCHECK_DUR, kCHECK_PULSES, nullptr, nullptr, &checkFunc, &checkFunc, ACC_MODE_SLEEPS, targetErr);
+	if ((errCode) || (targetErr) || (source->setClock (sourceClock.getClock ())) || (target->setClock (targetClock.getClock ())) ||
+	(target->captureTrace (&recorded)) || (source->chainTo (target, kCHAIN_HI, 0, 0)) || (target->arm (kARM_SPIN_PAUSE))){
+		printf ("Could not make a chained pair of pulsedThreads.\n");
+		delete source;
+		delete target;
+		return 1;
+	}
+	source->DoTask ();
+	source->waitOnBusy (1);
+	// the train records its task start and two edges for each pulse
+	uint64_t endNsecs = pulsedThreadNanos () + 1000000000;
+	while ((recorded.getNumEdges () < 2 * kCHECK_PULSES + 1) && (pulsedThreadNanos () < endNsecs)){
+		pulsedThreadCpuRelax ();
+	}
+	target->disarm ();
+	target->waitOnBusy (1);
+	uint64_t nMissed;
+	uint64_t nPosted = source->getChainStats (0, nMissed);
+	delete source;
+	delete target;
+	printf ("chained train: %llu starts posted, %llu edges missed.\n", (unsigned long long)nPosted, (unsigned long long)nMissed);
+	int result = ((nPosted == 1) && (nMissed == 0)) ? 0 : 1;
+	unsigned int nExpected;
+	pulsedThreadEdgePtr expected = trainEdges (kCHECK_DELAY, kCHECK_DUR, kCHECK_PULSES, nExpected);
+	unsigned int nRecorded;
+	pulsedThreadEdgePtr recordedEdges = traceEdges (recorded, nRecorded);
+	result |= compareEdges (expected, nExpected, recordedEdges, nRecorded, tolerance);
+	delete [] expected;
+	delete [] recordedEdges;
+	return result;
+}
+
+/* ****************************************************************************************************
+Records a train made on a virtual clock, compares it with the schedule from the train's timing, then replays the recorded trace on a
+second virtual clock and compares the replay's trace with the recorded one, then runs checkOffload and checkChain. Returns 0 if all match, else 1
+Last Modified:
+2026/10/19 - runs checkChain
+2026/10/19 - runs checkOffload, and gets the train's schedule from trainEdges
+2026/10/19 - initial version */
+static int checkTraces (uint64_t tolerance){
+	int errCode = 0;
+	pulsedThreadTrace recorded (kDIFF_MAX_BYTES);
+	pulsedThreadVirtualClock recordClock (kCLOCK_FREE, 0);
+	pulsedThread * train = new pulsedThread (kCHECK_DELAY, kCHECK_DUR, kCHECK_PULSES, nullptr, nullptr, &checkFunc, &checkFunc, ACC_MODE_SLEEPS, errCode);
+	if ((errCode) || (train->setClock (recordClock.getClock ())) || (train->captureTrace (&recorded))){
+		printf ("Could not make a pulsedThread to record.\n");
+		delete train;
+		return 1;
+	}
+	train->DoTask ();
+	train->waitOnBusy (1);
+	delete train;
+	unsigned int nExpected;
+	pulsedThreadEdgePtr expected = trainEdges (kCHECK_DELAY, kCHECK_DUR, kCHECK_PULSES, nExpected);
+	unsigned int nRecorded;
+	pulsedThreadEdgePtr recordedEdges = traceEdges (recorded, nRecorded);
+	printf ("recorded train against its schedule:\n");
+	int result = compareEdges (expected, nExpected, recordedEdges, nRecorded, tolerance);
+	delete [] expected;
+	// replay the recorded trace, recording the replay
+	pulsedThreadTrace replayed (kDIFF_MAX_BYTES);
+	pulsedThreadVirtualClock replayClock (kCLOCK_FREE, 0);
+	pulsedThreadReplay * replay = new pulsedThreadReplay (kPULSE, recorded, nullptr, nullptr, &checkFunc, &checkFunc, nullptr, ACC_MODE_SLEEPS, errCode);
+	if ((errCode) || (replay->setClock (replayClock.getClock ())) || (replay->captureTrace (&replayed))){
+		printf ("Could not make a pulsedThreadReplay.\n");
+		delete replay;
+		delete [] recordedEdges;
+		return 1;
+	}
+	replay->DoTask ();
+	replay->waitOnBusy (1);
+	delete replay;
+	unsigned int nReplayed;
+	pulsedThreadEdgePtr replayedEdges = traceEdges (replayed, nReplayed);
+	printf ("replayed trace against recorded trace:\n");
+	result |= compareEdges (recordedEdges, nRecorded, replayedEdges, nReplayed, tolerance);
+	delete [] recordedEdges;
+	delete [] replayedEdges;
+	result |= checkOffload (tolerance);
+	result |= checkChain (tolerance);
+	printf ("check %s.\n", (result == 0) ? "passed" : "failed");
+	return result;
+}
+
+int main(int argc, char **argv){
+	if ((argc > 1) && (strcmp (argv [1], "-check") == 0)){
+		return checkTraces ((argc > 2) ? atoi (argv [2]) : 0);
+	}
+	if (argc < 3){
+		printf ("usage: traceDiff traceFile1 traceFile2 [toleranceUsecs]\n       traceDiff -check [toleranceUsecs]\n");
+		return 1;
+	}
+	uint64_t tolerance = (argc > 3) ? atoi (argv [3]) : 0;
+	unsigned int nEdges1;
+	unsigned int nEdges2;
+	pulsedThreadEdgePtr edges1 = loadEdges (argv [1], nEdges1);
+	pulsedThreadEdgePtr edges2 = loadEdges (argv [2], nEdges2);
+	if ((edges1 == nullptr) || (edges2 == nullptr)){
+		return 1;
+	}
+	int result = compareEdges (edges1, nEdges1, edges2, nEdges2, tolerance);
+	delete [] edges1;
+	delete [] edges2;
+	return result;
+}